@@ -0,0 +1,587 @@
+// Throughput benchmarks for the pricing kernels (Google Benchmark).
+//
+//   ./bs_bench --benchmark_format=json            JSON to stdout
+//   cmake --build . --target bench_json           writes bs_bench.json in the build directory
+//
+// Every benchmark reports items_per_second, where an item is one contract (pricing, Greeks,
+// IV), one simulated path (Monte Carlo) or one replayed backtest day, so releases can be
+// compared in options/sec.
+
+#include "../include/backtest.h"
+#include "../include/batch_pricing_job.h"
+#include "../include/black_scholes.h"
+#include "../include/black_scholes_batch.h"
+#include "../include/black_scholes_greeks.h"
+#include "../include/black_scholes_kernels.h"
+#include "../include/instrumentation.h"
+#include "../include/leg_table.h"
+#include "../include/monte_carlo.h"
+#include "../include/monte_carlo_payoffs.h"
+#include "../include/option_strategy.h"
+#include "../include/portfolio_risk.h"
+#include "../include/pricing_grid.h"
+#include "../include/scenario_engine.h"
+#include "../include/thread_pool.h"
+#include "../include/vol_surface.h"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr double SPOT = 100.0;
+constexpr double RATE = 0.03;
+constexpr std::uint64_t BENCH_SEED = 20240601;
+constexpr double MIN_QUOTE = 0.005;  // half a cent
+
+// A synthetic chain: strikes 70%..130% of spot, expiries 1 week..2 years, vols 10%..60%
+struct Chain {
+    std::vector<double> spot, strike, rate, vol, T, price;
+    std::vector<OptionType> type;
+
+    explicit Chain(std::size_t n) : spot(n, SPOT), strike(n), rate(n, RATE), vol(n), T(n), price(n), type(n) {
+        std::mt19937_64 gen(BENCH_SEED);
+        std::uniform_real_distribution<double> moneyness(0.7, 1.3), expiry(7.0 / 365.0, 2.0), sigma(0.1, 0.6);
+        for (std::size_t i = 0; i < n; ++i) {
+            strike[i] = SPOT * moneyness(gen);
+            T[i] = expiry(gen);
+            vol[i] = sigma(gen);
+            type[i] = (i & 1) ? PUT : CALL;
+        }
+    }
+
+    OptionChainView view() const {
+        return {spot.data(), strike.data(), rate.data(), vol.data(), T.data(), type.data(), spot.size()};
+    }
+};
+
+// Moneyness x expiry grid of market prices to invert, quoted out of the money
+struct ImpliedVolGrid {
+    std::vector<double> market, spot, strike, rate, T;
+    std::vector<OptionType> type;
+
+    ImpliedVolGrid() {
+        const double moneyness[] = {0.7, 0.8, 0.9, 0.95, 1.0, 1.05, 1.1, 1.2, 1.3};
+        const double expiries[] = {7.0 / 365.0, 30.0 / 365.0, 90.0 / 365.0, 0.5, 1.0, 2.0};
+        for (double m : moneyness) {
+            for (double t : expiries) {
+                const double K = SPOT * m;
+                const OptionType side = K >= SPOT ? CALL : PUT;
+                const double vol = 0.2 + 0.3 * (m - 1.0) * (m - 1.0);  // mild smile
+                const double price = side == CALL ? BlackScholes::calculateCallPrice(SPOT, K, RATE, vol, t)
+                                                  : BlackScholes::calculatePutPrice(SPOT, K, RATE, vol, t);
+                if (price < MIN_QUOTE) continue;  // would not trade: no vol to recover
+                market.push_back(price);
+                spot.push_back(SPOT);
+                strike.push_back(K);
+                rate.push_back(RATE);
+                T.push_back(t);
+                type.push_back(side);
+            }
+        }
+    }
+
+    std::size_t size() const { return market.size(); }
+};
+
+// --- single contract latency ---------------------------------------------------------------
+
+void BM_ScalarCallPrice(benchmark::State& state) {
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(BlackScholes::calculateCallPrice(SPOT, 105.0, RATE, 0.2, 0.5));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ScalarCallPrice);
+
+// Same contract through the compile-time specialised kernel, no validation or edge branches
+void BM_ScalarCallPriceUnchecked(benchmark::State& state) {
+    double strike = 105.0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(strike);  // keep the inline kernel from folding to a constant
+        benchmark::DoNotOptimize(BlackScholesKernel::price<CALL, UNCHECKED>(SPOT, strike, RATE, 0.2, 0.5));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ScalarCallPriceUnchecked);
+
+void BM_ScalarGreeksSeparate(benchmark::State& state) {
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(BlackScholes::calculateCallPrice(SPOT, 105.0, RATE, 0.2, 0.5));
+        benchmark::DoNotOptimize(BlackScholes::calculatePutPrice(SPOT, 105.0, RATE, 0.2, 0.5));
+        benchmark::DoNotOptimize(BlackScholesGreeks::calculateCallGreeks(SPOT, 105.0, RATE, 0.2, 0.5));
+        benchmark::DoNotOptimize(BlackScholesGreeks::calculatePutGreeks(SPOT, 105.0, RATE, 0.2, 0.5));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ScalarGreeksSeparate);
+
+void BM_ScalarGreeksFused(benchmark::State& state) {
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(BlackScholesGreeks::calculateAll(SPOT, 105.0, RATE, 0.2, 0.5));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ScalarGreeksFused);
+
+// Same quote off the precomputed grid; compare with BM_ScalarGreeksFused
+void BM_PricingGridQuote(benchmark::State& state) {
+    const std::shared_ptr<const PricingGrid> grid = PricingGrid::build(PricingGridConfig());
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(grid->quote(SPOT, 105.0, RATE, 0.2, 0.5));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PricingGridQuote);
+
+void BM_ScalarImpliedVol(benchmark::State& state) {
+    const double price = BlackScholes::calculateCallPrice(SPOT, 105.0, RATE, 0.25, 0.5);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(BlackScholes::calculateImpliedVolatility(price, SPOT, 105.0, RATE, 0.5, CALL));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ScalarImpliedVol);
+
+// --- chain throughput, 1k .. 1M contracts ---------------------------------------------------
+
+void BM_ChainScalarLoop(benchmark::State& state) {
+    const Chain chain(static_cast<std::size_t>(state.range(0)));
+    std::vector<double> prices(chain.spot.size());
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < prices.size(); ++i) {
+            prices[i] = chain.type[i] == CALL
+                ? BlackScholes::calculateCallPrice(chain.spot[i], chain.strike[i], chain.rate[i], chain.vol[i], chain.T[i])
+                : BlackScholes::calculatePutPrice(chain.spot[i], chain.strike[i], chain.rate[i], chain.vol[i], chain.T[i]);
+        }
+        benchmark::DoNotOptimize(prices.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ChainScalarLoop)->RangeMultiplier(8)->Range(1 << 10, 1 << 20);
+
+void BM_ChainBatchPrice(benchmark::State& state) {
+    const Chain chain(static_cast<std::size_t>(state.range(0)));
+    std::vector<double> prices(chain.spot.size());
+    std::vector<std::uint8_t> status(chain.spot.size());
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(BlackScholesBatch::price(chain.view(), prices.data(), status.data()));
+        benchmark::DoNotOptimize(prices.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ChainBatchPrice)->RangeMultiplier(8)->Range(1 << 10, 1 << 20);
+
+// --- one expiry's calls with a smile: batch slice pricer vs the unchecked kernel -----------
+
+void BM_SliceBatchPrice(benchmark::State& state) {
+    const Chain chain(static_cast<std::size_t>(state.range(0)));
+    const std::vector<OptionType> calls(chain.spot.size(), CALL);
+    const ExpirySliceView slice{SPOT, RATE, 0.5, chain.strike.data(), chain.vol.data(), calls.data(), calls.size()};
+    std::vector<double> prices(chain.spot.size());
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(BlackScholesBatch::priceExpirySlice(slice, prices.data(), nullptr));
+        benchmark::DoNotOptimize(prices.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SliceBatchPrice)->RangeMultiplier(8)->Range(1 << 10, 1 << 16);
+
+void BM_SliceKernelPrice(benchmark::State& state) {
+    const Chain chain(static_cast<std::size_t>(state.range(0)));
+    std::vector<double> prices(chain.spot.size());
+    for (auto _ : state) {
+        const ExpiryContext expiry(SPOT, RATE, 0.5);
+        BlackScholesKernel::priceSlice<CALL>(expiry, chain.strike.data(), chain.vol.data(), prices.data(),
+                                             prices.size());
+        benchmark::DoNotOptimize(prices.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SliceKernelPrice)->RangeMultiplier(8)->Range(1 << 10, 1 << 16);
+
+void BM_ChainBatchGreeks(benchmark::State& state) {
+    const std::size_t n = static_cast<std::size_t>(state.range(0));
+    const Chain chain(n);
+    std::vector<double> buffers[10];
+    for (auto& b : buffers) b.resize(n);
+    GreeksBatchOutput out;
+    out.call_price = buffers[0].data();
+    out.put_price = buffers[1].data();
+    out.call_delta = buffers[2].data();
+    out.put_delta = buffers[3].data();
+    out.gamma = buffers[4].data();
+    out.call_theta = buffers[5].data();
+    out.put_theta = buffers[6].data();
+    out.vega = buffers[7].data();
+    out.call_rho = buffers[8].data();
+    out.put_rho = buffers[9].data();
+    std::vector<std::uint8_t> status(n);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(BlackScholesGreeks::calculateAllBatch(chain.view(), out, status.data()));
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ChainBatchGreeks)->RangeMultiplier(8)->Range(1 << 10, 1 << 20);
+
+// --- implied volatility across a moneyness x expiry grid ------------------------------------
+
+void BM_ImpliedVolGridScalar(benchmark::State& state) {
+    const ImpliedVolGrid grid;
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < grid.size(); ++i) {
+            benchmark::DoNotOptimize(BlackScholes::calculateImpliedVolatility(
+                grid.market[i], grid.spot[i], grid.strike[i], grid.rate[i], grid.T[i], grid.type[i]));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(grid.size()));
+}
+BENCHMARK(BM_ImpliedVolGridScalar);
+
+void BM_ImpliedVolGridBatch(benchmark::State& state) {
+    const ImpliedVolGrid grid;
+    const ImpliedVolChainView view{grid.market.data(), grid.spot.data(), grid.strike.data(),
+                                   grid.rate.data(), grid.T.data(), grid.type.data(), grid.size()};
+    std::vector<double> vols(grid.size());
+    std::vector<std::uint8_t> status(grid.size());
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(BlackScholesBatch::impliedVolatility(view, vols.data(), nullptr, status.data()));
+        benchmark::DoNotOptimize(vols.data());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(grid.size()));
+}
+BENCHMARK(BM_ImpliedVolGridBatch);
+
+// --- Monte Carlo paths/sec vs thread count --------------------------------------------------
+
+void threadCounts(benchmark::internal::Benchmark* bench) {
+    const int hw = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    for (int threads = 1; threads < hw; threads *= 2) bench->Arg(threads);
+    bench->Arg(hw);
+}
+
+void runMonteCarlo(benchmark::State& state, MonteCarloSampling sampling, int paths) {
+    TaskExecutor executor(static_cast<unsigned>(state.range(0)));
+    MonteCarloConfig config;
+    config.num_simulations = paths;
+    config.seed = BENCH_SEED;
+    config.sampling = sampling;
+    config.executor = &executor;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(MonteCarloOptionPricer::priceOption(SPOT, 105.0, RATE, 0.2, 1.0, CALL, config));
+    }
+    state.SetItemsProcessed(state.iterations() * paths);
+}
+
+void BM_MonteCarloTerminal(benchmark::State& state) { runMonteCarlo(state, SAMPLING_TERMINAL, 1000000); }
+BENCHMARK(BM_MonteCarloTerminal)->Apply(threadCounts)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+void BM_MonteCarloStepped(benchmark::State& state) { runMonteCarlo(state, SAMPLING_STEPPED, 20000); }
+BENCHMARK(BM_MonteCarloStepped)->Apply(threadCounts)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+// Iron condor legs plus an Asian and a barrier, all on one set of 20k daily-stepped paths
+void BM_MonteCarloPayoffs(benchmark::State& state) {
+    MonteCarloConfig config;
+    config.num_simulations = 20000;
+    config.seed = BENCH_SEED;
+    const std::vector<VanillaPayoff> condor{{PUT, 85.0}, {PUT, 90.0}, {CALL, 110.0}, {CALL, 115.0}};
+    const std::vector<double> weights{1.0, -1.0, -1.0, 1.0};
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(MonteCarloPayoffPricer::pricePortfolio(SPOT, RATE, 0.2, 1.0, config, condor, weights));
+        benchmark::DoNotOptimize(MonteCarloPayoffPricer::price(SPOT, RATE, 0.2, 1.0, config, AsianPayoff{CALL, 100.0},
+                                                               BarrierPayoff{CALL, 100.0, 130.0, BARRIER_UP_AND_OUT}));
+    }
+    state.SetItemsProcessed(state.iterations() * 2 * config.num_simulations);
+}
+BENCHMARK(BM_MonteCarloPayoffs)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+void BM_MonteCarloGreeks(benchmark::State& state) {
+    MonteCarloConfig config;
+    config.num_simulations = 20000;
+    config.seed = BENCH_SEED;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(
+            MonteCarloPayoffPricer::priceWithGreeks(SPOT, RATE, 0.2, 1.0, config, VanillaPayoff{CALL, 100.0}));
+        benchmark::DoNotOptimize(MonteCarloPayoffPricer::priceWithGreeks(
+            SPOT, RATE, 0.2, 1.0, config, BarrierPayoff{CALL, 100.0, 130.0, BARRIER_UP_AND_OUT}));
+    }
+    state.SetItemsProcessed(state.iterations() * 2 * config.num_simulations);
+}
+BENCHMARK(BM_MonteCarloGreeks)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+// --- Portfolio risk: one full aggregation per iteration ------------------------------------
+
+void BM_PortfolioRisk(benchmark::State& state) {
+    const std::size_t n = static_cast<std::size_t>(state.range(0));
+    const std::size_t underlyings = 100;
+    const std::time_t now = 1700000000;
+    std::mt19937_64 gen(BENCH_SEED);
+    std::uniform_real_distribution<double> moneyness(0.7, 1.3), days(1.0, 730.0), sigma(0.1, 0.6);
+    PositionBook book;
+    for (std::size_t i = 0; i < n; ++i) {
+        book.add(static_cast<SymbolId>(i % underlyings), (i & 1) ? PUT : CALL, SPOT * moneyness(gen),
+                 now + static_cast<std::time_t>(days(gen) * 86400), 1 + static_cast<int>(i % 5), 1.0, now,
+                 sigma(gen), 1.0);
+    }
+    std::vector<double> spots(underlyings, SPOT);
+    PortfolioRiskConfig config;
+    config.risk_free_rate = RATE;
+    config.now = now;
+    PortfolioRiskEngine engine;
+    for (auto _ : state) benchmark::DoNotOptimize(engine.compute(book, spots, config));
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(n));
+}
+BENCHMARK(BM_PortfolioRisk)->RangeMultiplier(8)->Range(1 << 10, 1 << 17)->UseRealTime();
+
+// --- Scenario cube: 41 spot x 21 vol x 10 time points over a book --------------------------
+
+void BM_ScenarioGrid(benchmark::State& state) {
+    const std::size_t n = static_cast<std::size_t>(state.range(0));
+    const std::time_t now = 1700000000;
+    std::mt19937_64 gen(BENCH_SEED);
+    std::uniform_real_distribution<double> moneyness(0.7, 1.3), sigma(0.1, 0.6);
+    ScenarioConfig config;
+    config.risk_free_rate = RATE;
+    config.now = now;
+    ScenarioPortfolio portfolio(now);
+    const std::size_t underlyings = 50, expiries = 12;
+    for (std::size_t u = 0; u < underlyings; ++u) portfolio.addUnderlying(SPOT);
+    for (std::size_t i = 0; i < n; ++i) {
+        const std::time_t expiry = now + static_cast<std::time_t>((i / underlyings) % expiries + 1) * 30 * 86400;
+        portfolio.addLeg(i % underlyings, (i & 1) ? PUT : CALL, SPOT * moneyness(gen), expiry,
+                         (i % 3) ? 1.0 : -1.0, sigma(gen));
+    }
+    ScenarioGrid grid;
+    grid.spot_shifts = ScenarioGrid::symmetric(0.2, 41);
+    grid.vol_shifts = ScenarioGrid::symmetric(0.1, 21);
+    grid.time_steps = ScenarioGrid::steps(27.0, 10);
+    for (auto _ : state) benchmark::DoNotOptimize(ScenarioEngine::run(portfolio, grid, config));
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(n * 41 * 21 * 10));
+}
+BENCHMARK(BM_ScenarioGrid)->Arg(1000)->Arg(5000)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+// --- Strategy payoff curve: value, P&L and delta at 1,000 underlying prices ----------------
+
+std::vector<double> curvePrices() {
+    std::vector<double> prices(1000);
+    for (std::size_t i = 0; i < prices.size(); ++i) prices[i] = SPOT * (0.5 + i * 0.001);
+    return prices;
+}
+
+void BM_StrategyCurveScalar(benchmark::State& state) {
+    const BullCallSpreadStrategy spread("BENCH", SPOT, 95.0, 105.0, 0.25, RATE, std::time(nullptr) + 90 * 86400);
+    const std::vector<double> prices = curvePrices();
+    for (auto _ : state) {
+        for (double price : prices) {
+            benchmark::DoNotOptimize(spread.calculateValue(price, 0.25));
+            benchmark::DoNotOptimize(spread.calculateDelta(price, 0.25, RATE, 0.25));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(prices.size()));
+}
+BENCHMARK(BM_StrategyCurveScalar);
+
+void BM_StrategyCurveBatch(benchmark::State& state) {
+    const BullCallSpreadStrategy spread("BENCH", SPOT, 95.0, 105.0, 0.25, RATE, std::time(nullptr) + 90 * 86400);
+    const std::vector<double> prices = curvePrices();
+    std::vector<double> value(prices.size()), profit_loss(prices.size()), delta(prices.size());
+    for (auto _ : state) {
+        spread.calculateCurve(prices.data(), prices.size(), 0.25, value.data(), profit_loss.data(), delta.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(prices.size()));
+}
+BENCHMARK(BM_StrategyCurveBatch);
+
+// --- Leg table: P&L of n iron condors at 100 prices, then their metrics ----------------------
+
+void BM_LegTableScan(benchmark::State& state) {
+    const std::size_t n = static_cast<std::size_t>(state.range(0));
+    const std::time_t expiry = std::time(nullptr) + 30 * 86400;
+    LegTable table;
+    for (std::size_t i = 0; i < n; ++i) {
+        const double width = 5.0 + static_cast<double>(i % 10);
+        table.addStrategy(0.0, -100.0);
+        table.addLeg(PUT, SPOT - 2 * width, expiry, 1);
+        table.addLeg(PUT, SPOT - width, expiry, -1);
+        table.addLeg(CALL, SPOT + width, expiry, -1);
+        table.addLeg(CALL, SPOT + 2 * width, expiry, 1);
+    }
+    std::vector<double> prices(100), profit_loss(n * prices.size());
+    for (std::size_t i = 0; i < prices.size(); ++i) prices[i] = SPOT * (0.7 + i * 0.006);
+    LegPricingConfig config;
+    config.risk_free_rate = RATE;
+    for (auto _ : state) {
+        table.profitLossAll(prices.data(), prices.size(), expiry - 15 * 86400, config, profit_loss.data());
+        benchmark::DoNotOptimize(table.metricsAll(config));
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(n));
+}
+BENCHMARK(BM_LegTableScan)->Arg(1000)->Arg(10000)->UseRealTime();
+
+// --- Vol surface: 12 expiries x 41 strikes of skewed quotes, refit and looked up -------------
+
+struct SurfaceQuotes {
+    static constexpr std::size_t EXPIRIES = 12;
+    static constexpr std::size_t STRIKES = 41;
+    std::time_t now{std::time(nullptr)};
+    std::time_t expiry[EXPIRIES];
+    std::vector<double> strike[EXPIRIES], price[EXPIRIES];
+    std::vector<OptionType> type[EXPIRIES];
+
+    SurfaceQuotes() {
+        for (std::size_t e = 0; e < EXPIRIES; ++e) {
+            const double T = (e + 1) / 6.0;
+            expiry[e] = now + static_cast<std::time_t>(T * 365.25 * 86400);
+            for (std::size_t i = 0; i < STRIKES; ++i) {
+                const double K = SPOT * (0.6 + 0.02 * i);
+                const double skew = 0.25 - 0.15 * std::log(K / SPOT) / std::sqrt(T);
+                strike[e].push_back(K);
+                type[e].push_back(K < SPOT ? PUT : CALL);
+                price[e].push_back(K < SPOT ? BlackScholes::calculatePutPrice(SPOT, K, RATE, skew, T)
+                                            : BlackScholes::calculateCallPrice(SPOT, K, RATE, skew, T));
+            }
+        }
+    }
+
+    void load(VolSurface& surface, std::size_t e) const {
+        surface.setQuotes(expiry[e], strike[e].data(), type[e].data(), price[e].data(), STRIKES);
+    }
+};
+
+// Refit after range(0) expiries' quotes change (the others are skipped)
+void BM_VolSurfaceRefit(benchmark::State& state) {
+    const std::size_t changed = static_cast<std::size_t>(state.range(0));
+    SurfaceQuotes quotes;
+    VolSurface surface;
+    surface.setUnderlying(SPOT, RATE);
+    for (std::size_t e = 0; e < SurfaceQuotes::EXPIRIES; ++e) quotes.load(surface, e);
+    surface.fit(quotes.now);
+    for (auto _ : state) {
+        state.PauseTiming();
+        for (std::size_t e = 0; e < changed; ++e) {
+            quotes.price[e][0] *= 1.001;
+            quotes.load(surface, e);
+        }
+        state.ResumeTiming();
+        benchmark::DoNotOptimize(surface.fit(quotes.now));
+    }
+}
+BENCHMARK(BM_VolSurfaceRefit)->Arg(1)->Arg(SurfaceQuotes::EXPIRIES)->UseRealTime();
+
+void BM_VolSurfaceLookup(benchmark::State& state) {
+    SurfaceQuotes quotes;
+    VolSurface surface;
+    surface.setUnderlying(SPOT, RATE);
+    for (std::size_t e = 0; e < SurfaceQuotes::EXPIRIES; ++e) quotes.load(surface, e);
+    surface.fit(quotes.now);
+    const Chain chain(4096);
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < chain.strike.size(); ++i) {
+            benchmark::DoNotOptimize(surface.vol(chain.strike[i], chain.T[i]));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(chain.strike.size()));
+}
+BENCHMARK(BM_VolSurfaceLookup);
+
+// --- Instrumentation: cost of one timed scope (two clock reads and a histogram update) ----------
+
+void BM_ScopedTimer(benchmark::State& state) {
+    for (auto _ : state) {
+        BS_TIMED_SCOPE(METRIC_PRICE_BATCH);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ScopedTimer);
+
+// --- Batch job: contract file on disk -> results file, parse + price + Greeks + format --------
+
+void BM_BatchPricingJob(benchmark::State& state) {
+    const Chain chain(static_cast<std::size_t>(state.range(0)));
+    const auto directory = std::filesystem::temp_directory_path();
+    const std::string input = (directory / "bs_bench_contracts.bsct").string();
+    const std::string output = (directory / "bs_bench_results.out").string();
+    BatchPricingJob::writeContracts(input, chain.view());
+    BatchPricingConfig config;
+    config.output_format = state.range(1) ? BATCH_BINARY : BATCH_CSV;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(BatchPricingJob::run(input, output, config));
+    }
+    std::filesystem::remove(input);
+    std::filesystem::remove(output);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_BatchPricingJob)->Args({1 << 20, 0})->Args({1 << 20, 1})->UseRealTime()->Unit(benchmark::kMillisecond);
+
+// --- Backtest: parameter sweep over three years of synthetic closes, one run per task --------
+
+// Holds 30-day ATM calls on symbol 0 while its close is above its window-day moving average
+class MovingAverageCalls : public BacktestStrategy {
+public:
+    explicit MovingAverageCalls(int window) : window_(window) {}
+
+    void onDay(BacktestContext& context) override {
+        const std::size_t today = context.dayIndex();
+        if (today < static_cast<std::size_t>(window_)) return;
+        const double* closes = context.closes(0);
+        double average = 0.0;
+        for (int i = 0; i < window_; ++i) average += closes[today - i];
+        average /= window_;
+
+        if (holding_ && context.now() >= expiry_) holding_ = false;  // settled by the engine
+        const bool above = closes[today] > average;
+        if (above && !holding_) {
+            strike_ = std::round(context.spot(0));
+            expiry_ = context.daysAhead(30);
+            holding_ = context.buy(0, CALL, strike_, expiry_, 10);
+        } else if (!above && holding_ && context.sell(0, CALL, strike_, expiry_, 10)) {
+            holding_ = false;
+        }
+    }
+
+private:
+    int window_;
+    bool holding_{false};
+    double strike_{0.0};
+    std::time_t expiry_{0};
+};
+
+void BM_BacktestSweep(benchmark::State& state) {
+    constexpr std::size_t DAYS = 3 * 252;
+    std::vector<std::int32_t> days(DAYS);
+    std::vector<double> closes(DAYS);
+    std::mt19937_64 gen(BENCH_SEED);
+    std::normal_distribution<double> shock;
+    double close = SPOT;
+    for (std::size_t d = 0; d < DAYS; ++d) {
+        days[d] = 18000 + static_cast<std::int32_t>(d / 5 * 7 + d % 5);  // weekdays
+        close *= std::exp(0.0003 + 0.015 * shock(gen));
+        closes[d] = close;
+    }
+    PriceSeriesView series;
+    series.days = days.data();
+    series.fields[FIELD_CLOSE] = closes.data();
+    series.size = DAYS;
+    const BacktestData data = BacktestData::fromSeries({"SYN"}, {series}, days.front(), days.back());
+
+    const std::size_t runs = static_cast<std::size_t>(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(BacktestEngine::sweep(data, runs, [](std::size_t run) {
+            return std::make_unique<MovingAverageCalls>(5 + static_cast<int>(run));
+        }));
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(runs * DAYS));
+}
+BENCHMARK(BM_BacktestSweep)->Arg(1)->Arg(64)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+} // namespace
+
+BENCHMARK_MAIN();
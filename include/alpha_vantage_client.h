@@ -7,22 +7,71 @@
 #include <iostream>
 #include <thread>
 #include <chrono>
+#include <future>
+#include <memory>
+#include <cstdint>
 #include <nlohmann/json.hpp>
 #include "optional_double.h"
+#include "http_client.h"
+
+/** How much daily history to request: the last ~100 trading days, or everything (20+ years). */
+enum HistoryRange {
+    HISTORY_COMPACT,
+    HISTORY_FULL
+};
+
+/** Daily adjusted closes as parallel columns, ascending by day (CalendarDate day numbers). */
+struct DailyCloseColumns {
+    std::vector<std::int32_t> days;
+    std::vector<double> adjusted_close;
+};
 
 class AlphaVantageClient {
 public:
-    // Constructor with API key
-    explicit AlphaVantageClient(const std::string& api_key);
+    // The free plan's quota; premium keys raise it (constructor argument, or
+    // ALPHA_VANTAGE_REQUESTS_PER_MINUTE in the CLI's .env, e.g. 75 for the lowest paid plan)
+    static constexpr double DEFAULT_REQUESTS_PER_MINUTE = 5.0;
+
+    // Constructor with API key. Requests share one connection pool and are started no faster
+    // than requests_per_minute (a token bucket with a burst of up to 5 requests).
+    explicit AlphaVantageClient(const std::string& api_key,
+                                double requests_per_minute = DEFAULT_REQUESTS_PER_MINUTE);
 
     // Fetch current stock quote
     OptionalDouble getCurrentPrice(const std::string& symbol);
 
-    // Fetch historical daily prices
+    // Fetch quotes for all symbols concurrently; future i resolves to the price of symbols[i]
+    // (empty on any failure, like getCurrentPrice). Bounded only by the rate limit.
+    std::vector<std::future<OptionalDouble>> getCurrentPrices(const std::vector<std::string>& symbols);
+
+    // Fetch daily adjusted closes with first_day <= day <= last_day. The response is parsed in
+    // one streaming pass (no JSON DOM); returns false if it held no usable series, with the
+    // reason in *error when given.
+    bool getHistoricalCloses(
+        const std::string& symbol,
+        std::int32_t first_day,
+        std::int32_t last_day,
+        HistoryRange range,
+        DailyCloseColumns& out,
+        std::string* error = nullptr
+    );
+
+    // Streaming parse of a TIME_SERIES_DAILY_ADJUSTED response body into out (replacing its
+    // contents). On failure returns false and sets error (e.g. the API's rate-limit note).
+    static bool parseDailyCloses(
+        const std::string& response,
+        std::int32_t first_day,
+        std::int32_t last_day,
+        DailyCloseColumns& out,
+        std::string& error
+    );
+
+    // Fetch historical daily prices (string dates; see getHistoricalCloses)
     std::vector<std::pair<std::string, double>> getHistoricalPrices(
         const std::string& symbol, 
         const std::string& start_date, 
-        const std::string& end_date
+        const std::string& end_date,
+        HistoryRange range = HISTORY_FULL
     );
 
     // Fetch implied volatility (if available)
@@ -31,9 +80,16 @@ public:
 private:
     std::string api_key;
     std::string base_url = "https://www.alphavantage.co/query";
+    std::unique_ptr<RateLimiter> rate_limiter;
+    std::unique_ptr<AsyncHttpClient> http;  // declared after rate_limiter: destroyed first
 
-    // Perform HTTP GET request
+    // Perform HTTP GET request (blocking, on the shared pool)
     std::string performHttpGet(const std::string& url);
+
+    std::string quoteUrl(const std::string& symbol) const;
+
+    // Price from a GLOBAL_QUOTE response body
+    static OptionalDouble parseQuote(const std::string& symbol, const std::string& response);
 };
 
 #endif // ALPHA_VANTAGE_CLIENT_H
\ No newline at end of file
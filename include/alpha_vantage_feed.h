@@ -3,23 +3,56 @@
 
 #include "data_feed_interface.h"
 #include "alpha_vantage_client.h"
+#include "price_store.h"
+#include <chrono>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 
-/** DataFeedInterface implementation using Alpha Vantage API. */
+/**
+ * DataFeedInterface implementation using Alpha Vantage API.
+ *
+ * With a cache directory, daily history is kept in a PriceStore: a symbol is served from its
+ * file when that was refreshed today (or already covers end_date), otherwise only the recent
+ * days (outputsize=compact) are downloaded and appended. Full history is requested for new
+ * symbols, long gaps, or when the stored adjusted closes no longer match (a split or dividend
+ * re-adjusted the history).
+ */
 class AlphaVantageFeed : public DataFeedInterface {
 public:
-    explicit AlphaVantageFeed(const std::string& api_key);
+    explicit AlphaVantageFeed(const std::string& api_key,
+                              double requests_per_minute = AlphaVantageClient::DEFAULT_REQUESTS_PER_MINUTE,
+                              const std::string& cache_directory = "");
 
     OptionalDouble getCurrentPrice(const std::string& symbol) const override;
+    /** Fetches all symbols concurrently over the client's shared connection pool. */
+    std::vector<OptionalDouble> getCurrentPrices(const std::vector<std::string>& symbols) const override;
     bool fetchHistoricalPrices(const std::string& symbol, const std::string& start_date, const std::string& end_date) override;
-    std::vector<StockPrice> getHistoricalPrices(const std::string& symbol) const override;
+    PriceSeriesView getHistoricalPrices(const std::string& symbol) const override;
     std::string lastError() const override { return last_error_; }
+    /** Age of the last successful quote fetched through this feed (stale if never fetched). */
+    bool isStaleQuote(const std::string& symbol, int max_age_seconds) const override;
 
 private:
+    /** Bring the stored series up to date; false (with last_error_ set) if the API returned nothing usable. */
+    bool refreshStore(const std::string& symbol, const MappedPriceSeries& stored, std::int32_t today);
+
     mutable AlphaVantageClient client_;
+    std::unique_ptr<PriceStore> store_;  // null: no on-disk cache
+    void recordQuote(const std::string& symbol) const;
+
     mutable std::string last_error_;
-    std::unordered_map<std::string, std::vector<StockPrice>> historical_cache_;
+    mutable std::mutex quote_times_mutex_;
+    mutable std::unordered_map<std::string, std::chrono::steady_clock::time_point> quote_times_;
+    // A fetched symbol is either downloaded columns or a mapped store file; view covers the
+    // requested date range of whichever is held
+    struct CachedHistory {
+        PriceSeries owned;
+        MappedPriceSeries mapped;
+        PriceSeriesView view;
+    };
+    std::unordered_map<std::string, CachedHistory> historical_cache_;
 };
 
 #endif
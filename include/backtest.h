@@ -0,0 +1,150 @@
+#ifndef BACKTEST_H
+#define BACKTEST_H
+
+#include "option.h"
+#include "price_series.h"
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+class PaperTradingSystem;
+class PriceStore;
+class TaskExecutor;
+
+struct BacktestConfig {
+    double initial_balance{100000.0};
+    double risk_free_rate{0.02};
+    double volatility{0.3};                    // prices trades and reprices the book
+    std::int32_t close_time_seconds{20 * 3600};  // UTC time of day each close is stamped at (16:00 New York, EDT)
+    TaskExecutor* executor{nullptr};           // sweep(); nullptr = TaskExecutor::shared()
+};
+
+/**
+ * Daily closes of a set of symbols on one calendar (the union of their trading days), loaded
+ * once and shared read-only by every run of a sweep. A symbol without a close on some day
+ * carries its previous close forward; before its first close it is NaN.
+ */
+class BacktestData {
+public:
+    /**
+     * The symbols' cached series from store (see PriceStore), days first_day..last_day
+     * (CalendarDate day numbers). Throws std::runtime_error if a symbol has no cache file.
+     */
+    static BacktestData fromStore(const PriceStore& store, const std::vector<std::string>& symbols,
+                                  std::int32_t first_day, std::int32_t last_day);
+    /** Same from in-memory series; series[i] belongs to symbols[i] and needs a close column. */
+    static BacktestData fromSeries(const std::vector<std::string>& symbols, const std::vector<PriceSeriesView>& series,
+                                   std::int32_t first_day, std::int32_t last_day);
+
+    std::size_t symbolCount() const { return symbols_.size(); }
+    const std::string& symbol(std::size_t s) const { return symbols_[s]; }
+    std::size_t dayCount() const { return days_.size(); }
+    const std::vector<std::int32_t>& days() const { return days_; }
+    /** dayCount() closes of symbol s, aligned with days(). */
+    const double* closes(std::size_t s) const { return closes_.data() + s * days_.size(); }
+
+private:
+    std::vector<std::string> symbols_;
+    std::vector<std::int32_t> days_;
+    std::vector<double> closes_;  // [symbol][day]
+};
+
+/** One row per replayed day, as columns. */
+struct BacktestJournal {
+    std::vector<std::int32_t> day;
+    std::vector<double> cash;
+    std::vector<double> position_value;  // marked value of the open options
+    std::vector<double> equity;          // cash + position_value
+    std::vector<double> pnl;             // equity change over the day (from the initial balance on day 0)
+    std::vector<std::uint32_t> open_positions;
+    std::vector<std::uint32_t> trades;   // fills the strategy made that day
+
+    std::size_t size() const { return day.size(); }
+    void reserve(std::size_t days);
+};
+
+/**
+ * What a strategy sees on one replayed day: that day's closes and the history before it,
+ * and order entry against the backtest's PaperTradingSystem. Trades fill at the Black-Scholes
+ * value of the contract at the day's close (BacktestConfig rate and vol), plus the system's fee.
+ */
+class BacktestContext {
+public:
+    std::size_t dayIndex() const { return day_index_; }
+    std::int32_t day() const;
+    /** The simulated time: the day's close. */
+    std::time_t now() const { return now_; }
+    /** now() plus days calendar days, the usual way to pick an expiry. */
+    std::time_t daysAhead(int days) const { return now_ + static_cast<std::time_t>(days) * 24 * 60 * 60; }
+
+    std::size_t symbolCount() const;
+    const std::string& symbol(std::size_t s) const;
+    /** Today's close of symbol s (NaN before its first close). */
+    double spot(std::size_t s) const { return closes(s)[day_index_]; }
+    /** Closes of symbol s up to and including today: closes(s)[0..dayIndex()]. No look-ahead past that. */
+    const double* closes(std::size_t s) const;
+
+    /** Black-Scholes value of the contract at today's close; NaN without a spot. */
+    double fairValue(std::size_t s, OptionType type, double strike, std::time_t expiry) const;
+    /** Buy or sell at fairValue(). False if there is no spot, cash or position (see PaperTradingSystem). */
+    bool buy(std::size_t s, OptionType type, double strike, std::time_t expiry, int quantity);
+    bool sell(std::size_t s, OptionType type, double strike, std::time_t expiry, int quantity);
+
+    /** The run's system, for anything else (positions, risk, ...). */
+    PaperTradingSystem& system() { return system_; }
+
+private:
+    friend class BacktestEngine;
+    BacktestContext(const BacktestData& data, const BacktestConfig& config, PaperTradingSystem& system)
+        : data_(data), config_(config), system_(system) {}
+
+    const BacktestData& data_;
+    const BacktestConfig& config_;
+    PaperTradingSystem& system_;
+    std::size_t day_index_{0};
+    std::time_t now_{0};
+    std::uint32_t trades_{0};
+};
+
+/** Trading rules: called once per replayed day, after the book is repriced and expiries are settled. */
+class BacktestStrategy {
+public:
+    virtual ~BacktestStrategy() = default;
+    virtual void onDay(BacktestContext& context) = 0;
+};
+
+struct BacktestResult {
+    BacktestJournal journal;
+    double final_equity{0.0};
+    double total_return{0.0};   // final_equity / initial_balance - 1
+    double max_drawdown{0.0};   // largest peak-to-trough fall of equity, as a fraction of the peak
+    std::size_t trades{0};
+};
+
+/**
+ * Replays BacktestData day by day through a PaperTradingSystem of its own: an offline
+ * PaperFeed, a clock that returns the replayed close time, and no console output. Each day
+ * pushes the closes, reprices the whole book with the batch repricer, settles expired
+ * positions at their (intrinsic) mark, runs the strategy, reprices what it traded, and
+ * appends a journal row. Everything a run touches is owned by the run, so sweep() runs
+ * independent backtests in parallel with no locking between them.
+ */
+class BacktestEngine {
+public:
+    /** Makes the strategy for run i of a sweep (e.g. from the i-th parameter set). */
+    using StrategyFactory = std::function<std::unique_ptr<BacktestStrategy>(std::size_t run)>;
+
+    static BacktestResult run(const BacktestData& data, BacktestStrategy& strategy,
+                              const BacktestConfig& config = BacktestConfig());
+
+    /** runs backtests, one per parallel task on config.executor; result i is from factory(i). */
+    static std::vector<BacktestResult> sweep(const BacktestData& data, std::size_t runs,
+                                             const StrategyFactory& factory,
+                                             const BacktestConfig& config = BacktestConfig());
+};
+
+#endif // BACKTEST_H
@@ -0,0 +1,77 @@
+#ifndef BATCH_PRICING_JOB_H
+#define BATCH_PRICING_JOB_H
+
+#include "black_scholes_batch.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+class TaskExecutor;
+
+/** Encoding of a contract or result file. */
+enum BatchFileFormat : std::uint8_t {
+    BATCH_CSV,
+    BATCH_BINARY
+};
+
+struct BatchPricingConfig {
+    std::size_t block_size{16384};      // contracts per parallel task
+    bool implied_volatility{false};     // solve vol from market_price, then price and Greeks at it
+    BatchFileFormat output_format{BATCH_CSV};
+    int csv_precision{10};              // significant digits per CSV value
+    TaskExecutor* executor{nullptr};    // nullptr = TaskExecutor::shared()
+};
+
+struct BatchPricingStats {
+    std::size_t contracts{0};
+    std::size_t invalid{0};        // lanes with LANE_ERROR_MASK bits (NaN outputs)
+    std::size_t iv_unsolved{0};    // implied_volatility mode: lanes whose status is not IV_CONVERGED
+    double seconds{0.0};
+};
+
+/**
+ * Headless pricing of a whole contract file through the batch kernels.
+ *
+ * Input is either CSV, one contract per line:
+ *
+ *     type,spot,strike,rate,volatility,time_to_expiry[,market_price]
+ *
+ * (type is C/P or call/put, any case; a first line whose type doesn't parse is a header; with
+ * implied_volatility the volatility field is ignored and may be empty), or a binary contract
+ * file as written by writeContracts(), recognised by its magic and memory-mapped. The input
+ * is split into blocks of config.block_size contracts (CSV: byte ranges of about that many
+ * lines, cut at line breaks), and each block is parsed, solved (IV), priced and formatted on
+ * the executor into its own buffer. Blocks run a wave at a time, two per worker, and each
+ * wave's buffers are written in order with one fwrite each, so memory stays bounded and
+ * output order matches input.
+ *
+ * Output CSV has a header line and one row per contract:
+ *
+ *     price,delta,gamma,theta,vega,rho[,implied_vol,iv_status],status
+ *
+ * with the Greeks of the contract's own side in BlackScholesGreeks units and status its
+ * BatchLaneStatus. Binary output is a 32-byte header ("BSRS") then one record per block: a
+ * uint64 contract count n, the double columns price, delta, gamma, theta, vega, rho
+ * [, implied_vol] of n values each, then the uint8 status [and iv_status] columns, each
+ * zero-padded to a multiple of 8 bytes.
+ */
+class BatchPricingJob {
+public:
+    /**
+     * Price every contract of input_path into output_path ("-" or empty: stdout). Throws
+     * std::runtime_error on I/O errors and on malformed CSV lines (with the line number);
+     * invalid contracts are not errors, they get NaN outputs and status bits.
+     */
+    static BatchPricingStats run(const std::string& input_path, const std::string& output_path,
+                                 const BatchPricingConfig& config = BatchPricingConfig());
+
+    /**
+     * Write chain as a binary contract file: a 32-byte header ("BSCT"), the double columns
+     * spot, strike, rate, volatility, time_to_expiry [, market_price], then the uint8 type
+     * column (0 call, 1 put). market_price may be nullptr. Throws std::runtime_error.
+     */
+    static void writeContracts(const std::string& path, const OptionChainView& chain,
+                               const double* market_price = nullptr);
+};
+
+#endif // BATCH_PRICING_JOB_H
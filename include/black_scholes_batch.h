@@ -0,0 +1,109 @@
+#ifndef BLACK_SCHOLES_BATCH_H
+#define BLACK_SCHOLES_BATCH_H
+
+#include "option.h"
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+#include <limits>
+
+/** Per-lane status bits written by the batch kernels. 0 means priced normally. */
+enum BatchLaneStatus : std::uint8_t {
+    LANE_OK              = 0,
+    LANE_INVALID_SPOT    = 1 << 0,  // spot <= 0 or not finite
+    LANE_INVALID_STRIKE  = 1 << 1,  // strike <= 0 or not finite
+    LANE_INVALID_EXPIRY  = 1 << 2,  // time_to_expiry < 0 or not finite
+    LANE_INVALID_PARAM   = 1 << 3,  // rate or volatility not finite
+    LANE_EDGE_CASE       = 1 << 4   // not an error: T or sigma ~ 0, (discounted) intrinsic returned
+};
+
+/** Bits of BatchLaneStatus that mark a lane as invalid (its output is NaN). */
+constexpr std::uint8_t LANE_ERROR_MASK =
+    LANE_INVALID_SPOT | LANE_INVALID_STRIKE | LANE_INVALID_EXPIRY | LANE_INVALID_PARAM;
+
+/** Per-lane outcome of BlackScholesBatch::impliedVolatility (exactly one value per lane). */
+enum ImpliedVolStatus : std::uint8_t {
+    IV_CONVERGED        = 0,
+    IV_INVALID_INPUT    = 1 << 0,  // S or K <= 0, T ~ 0, price < 0, or anything not finite
+    IV_BELOW_INTRINSIC  = 1 << 1,  // price <= discounted intrinsic: no positive vol reproduces it
+    IV_ABOVE_MAXIMUM    = 1 << 2,  // price >= S (call) / K e^{-rT} (put), or the root is above 500% vol
+    IV_NOT_CONVERGED    = 1 << 3   // iteration cap hit; volatility holds the last iterate
+};
+
+/** Structure-of-arrays option chain: contract i is (spot_price[i], strike_price[i], ...). */
+struct OptionChainView {
+    const double* spot_price;
+    const double* strike_price;
+    const double* risk_free_rate;
+    const double* volatility;
+    const double* time_to_expiry;
+    const OptionType* option_type;
+    std::size_t size;
+};
+
+/** All strikes of one expiry on one underlying: spot, rate and T are shared by every lane. */
+struct ExpirySliceView {
+    double spot_price;
+    double risk_free_rate;
+    double time_to_expiry;
+    const double* strike_price;
+    const double* volatility;      // per strike, so a smile can be priced in one pass
+    const OptionType* option_type;
+    std::size_t size;
+};
+
+/** Market prices to invert, with the same contract layout as OptionChainView minus volatility. */
+struct ImpliedVolChainView {
+    const double* market_price;
+    const double* spot_price;
+    const double* strike_price;
+    const double* risk_free_rate;
+    const double* time_to_expiry;
+    const OptionType* option_type;
+    std::size_t size;
+};
+
+/**
+ * Black-Scholes pricing over whole option chains.
+ *
+ * Same model and edge-case handling as BlackScholes::calculateCallPrice / calculatePutPrice,
+ * but the inner loop is branch-free (FastMath CDF/exp/log) so the compiler vectorizes it.
+ * Inputs are not thrown on: invalid lanes get a NaN price and LANE_* bits in status.
+ */
+class BlackScholesBatch {
+public:
+    /**
+     * Price chain.size contracts into prices[0..size). status may be nullptr; otherwise it
+     * receives one BatchLaneStatus mask per lane. Returns the number of invalid lanes.
+     */
+    static std::size_t price(const OptionChainView& chain, double* prices, std::uint8_t* status);
+
+    /** Same as price(), computing sqrt(T), exp(-rT) and log(S) once for the whole slice. */
+    static std::size_t priceExpirySlice(const ExpirySliceView& slice, double* prices, std::uint8_t* status);
+
+    /**
+     * Implied volatility for every lane of chain into volatility[0..size). Each lane is solved
+     * on its out-of-the-money side from the Corrado-Miller closed-form guess with bracketed
+     * Halley steps on ln(price); all lanes of a block iterate in lockstep with converged lanes
+     * masked out (typically 3-4 iterations). iterations and status may be nullptr.
+     * volatility is NaN unless status is IV_CONVERGED or IV_NOT_CONVERGED.
+     * Returns the number of lanes whose status is not IV_CONVERGED.
+     */
+    static std::size_t impliedVolatility(const ImpliedVolChainView& chain, double* volatility,
+                                         std::uint8_t* iterations, std::uint8_t* status);
+
+    /** Status pass on its own, for kernels built on this one. Returns the number of invalid lanes. */
+    static std::size_t classify(const OptionChainView& chain, std::uint8_t* status);
+
+    /**
+     * Positive finite spot and strike, T >= 0, finite rate and vol. Uses bitwise & so a loop
+     * calling it has no control flow and still vectorizes.
+     */
+    static inline bool laneValid(double spot, double strike, double rate, double vol, double T) noexcept {
+        constexpr double INF = std::numeric_limits<double>::infinity();
+        return (spot > 0.0) & (spot < INF) & (strike > 0.0) & (strike < INF)
+             & (T >= 0.0) & (T < INF) & (std::fabs(rate) < INF) & (std::fabs(vol) < INF);
+    }
+};
+
+#endif // BLACK_SCHOLES_BATCH_H
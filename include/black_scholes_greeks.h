@@ -1,7 +1,15 @@
 #ifndef BLACK_SCHOLES_GREEKS_H
 #define BLACK_SCHOLES_GREEKS_H
 
+#include "black_scholes_batch.h"
+#include "fast_math.h"
+#include "instrumentation.h"
+#include <algorithm>
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
@@ -19,6 +27,43 @@ struct OptionGreeks {
     double rho{0.0};
 };
 
+/** Output selection for the fused evaluators; OR the bits together as a template argument. */
+enum GreeksOutput : unsigned {
+    OUTPUT_PRICE = 1u << 0,
+    OUTPUT_DELTA = 1u << 1,
+    OUTPUT_GAMMA = 1u << 2,
+    OUTPUT_THETA = 1u << 3,
+    OUTPUT_VEGA  = 1u << 4,
+    OUTPUT_RHO   = 1u << 5,
+    OUTPUT_ALL   = OUTPUT_PRICE | OUTPUT_DELTA | OUTPUT_GAMMA | OUTPUT_THETA | OUTPUT_VEGA | OUTPUT_RHO
+};
+
+// Call and put price plus Greeks from one evaluation; fields not selected are left at 0
+struct OptionValuation {
+    double call_price{0.0};
+    double put_price{0.0};
+    OptionGreeks call_greeks;
+    OptionGreeks put_greeks;
+};
+
+/**
+ * Output arrays for BlackScholesGreeks::calculateAllBatch, one entry per lane. Gamma and vega
+ * are the same for calls and puts, so they have one array each. Arrays for outputs not in the
+ * template mask are never touched and may be nullptr.
+ */
+struct GreeksBatchOutput {
+    double* call_price{nullptr};
+    double* put_price{nullptr};
+    double* call_delta{nullptr};
+    double* put_delta{nullptr};
+    double* gamma{nullptr};
+    double* call_theta{nullptr};
+    double* put_theta{nullptr};
+    double* vega{nullptr};
+    double* call_rho{nullptr};
+    double* put_rho{nullptr};
+};
+
 class BlackScholesGreeks {
 public:
     // Calculate all Greeks for a call option
@@ -39,7 +84,45 @@ public:
         double time_to_expiry
     );
 
+    /**
+     * Call and put price and Greeks sharing one log/sqrt/exp and one N(d1), N(d2), phi(d1).
+     * Outputs is a GreeksOutput mask; unselected outputs are not computed. Results match
+     * BlackScholes::calculateCallPrice / calculatePutPrice and calculateCallGreeks /
+     * calculatePutGreeks (same units, same zero Greeks when T or sigma ~ 0). When prices are
+     * selected, invalid inputs throw std::invalid_argument like the pricers do.
+     */
+    template <unsigned Outputs = OUTPUT_ALL>
+    static OptionValuation calculateAll(
+        double spot_price,
+        double strike_price,
+        double risk_free_rate,
+        double volatility,
+        double time_to_expiry
+    );
+
+    /**
+     * calculateAll over a whole chain (chain.option_type is ignored: both sides are produced).
+     * Branch-free like BlackScholesBatch::price: invalid lanes get NaN in every selected
+     * output; status may be nullptr. Returns the number of invalid lanes.
+     */
+    template <unsigned Outputs = OUTPUT_ALL>
+    static std::size_t calculateAllBatch(
+        const OptionChainView& chain,
+        const GreeksBatchOutput& out,
+        std::uint8_t* status
+    );
+
 private:
+    static constexpr double MIN_VOLATILITY = 1e-10;
+    static constexpr double MIN_TIME_TO_EXPIRY = 1e-10;
+
+    // N(x) and N(-x) through one erfc of |x|, so neither side loses its tail to cancellation
+    static void standardNormalCDFPair(double x, double& cdf, double& complement) {
+        const double lower = 0.5 * std::erfc(std::fabs(x) / std::sqrt(2.0));
+        cdf = x < 0 ? lower : 1.0 - lower;
+        complement = x < 0 ? 1.0 - lower : lower;
+    }
+
     // Standard Normal Probability Density Function (reused from your existing code)
     static double standardNormalPDF(double x) {
         return (1.0 / std::sqrt(2.0 * M_PI)) * std::exp(-0.5 * x * x);
@@ -51,4 +134,203 @@ private:
     }
 };
 
+template <unsigned Outputs>
+OptionValuation BlackScholesGreeks::calculateAll(
+    double spot_price,
+    double strike_price,
+    double risk_free_rate,
+    double volatility,
+    double time_to_expiry
+) {
+    static_assert((Outputs & ~static_cast<unsigned>(OUTPUT_ALL)) == 0, "unknown GreeksOutput bits");
+    constexpr bool want_price = (Outputs & OUTPUT_PRICE) != 0;
+    constexpr bool want_delta = (Outputs & OUTPUT_DELTA) != 0;
+    constexpr bool want_gamma = (Outputs & OUTPUT_GAMMA) != 0;
+    constexpr bool want_theta = (Outputs & OUTPUT_THETA) != 0;
+    constexpr bool want_vega = (Outputs & OUTPUT_VEGA) != 0;
+    constexpr bool want_rho = (Outputs & OUTPUT_RHO) != 0;
+
+    OptionValuation v;
+    if constexpr (want_price) {
+        if (spot_price <= 0 || strike_price <= 0) {
+            throw std::invalid_argument("Invalid input: spot and strike must be positive");
+        }
+        if (time_to_expiry < 0) {
+            throw std::invalid_argument("Invalid input: time_to_expiry must be non-negative");
+        }
+    }
+    if (spot_price <= 0 || strike_price <= 0 || time_to_expiry < MIN_TIME_TO_EXPIRY || volatility < MIN_VOLATILITY) {
+        // Edge cases: intrinsic (T ~ 0) or discounted intrinsic (sigma ~ 0), Greeks stay 0
+        if constexpr (want_price) {
+            if (time_to_expiry < MIN_TIME_TO_EXPIRY) {
+                v.call_price = std::max(spot_price - strike_price, 0.0);
+                v.put_price = std::max(strike_price - spot_price, 0.0);
+            } else {
+                const double discounted_strike = strike_price * std::exp(-risk_free_rate * time_to_expiry);
+                v.call_price = std::max(spot_price - discounted_strike, 0.0);
+                v.put_price = std::max(discounted_strike - spot_price, 0.0);
+            }
+        }
+        return v;
+    }
+
+    const double sqrt_T = std::sqrt(time_to_expiry);
+    const double sigma_sqrt_T = volatility * sqrt_T;
+    const double d1 = (std::log(spot_price / strike_price) +
+                       (risk_free_rate + 0.5 * volatility * volatility) * time_to_expiry)
+                      / sigma_sqrt_T;
+    const double d2 = d1 - sigma_sqrt_T;
+    const double discounted_strike = strike_price * std::exp(-risk_free_rate * time_to_expiry);
+
+    double n_d1 = 0.0, n_minus_d1 = 0.0, n_d2 = 0.0, n_minus_d2 = 0.0, pdf_d1 = 0.0;
+    if constexpr (want_price || want_delta) {
+        standardNormalCDFPair(d1, n_d1, n_minus_d1);
+    }
+    if constexpr (want_price || want_theta || want_rho) {
+        standardNormalCDFPair(d2, n_d2, n_minus_d2);
+    }
+    if constexpr (want_gamma || want_theta || want_vega) {
+        pdf_d1 = standardNormalPDF(d1);
+    }
+
+    if constexpr (want_price) {
+        v.call_price = spot_price * n_d1 - discounted_strike * n_d2;
+        v.put_price = discounted_strike * n_minus_d2 - spot_price * n_minus_d1;
+    }
+    if constexpr (want_delta) {
+        v.call_greeks.delta = n_d1;
+        v.put_greeks.delta = -n_minus_d1;
+    }
+    if constexpr (want_gamma) {
+        v.call_greeks.gamma = v.put_greeks.gamma = pdf_d1 / (spot_price * sigma_sqrt_T);
+    }
+    if constexpr (want_theta) {
+        const double decay = -spot_price * pdf_d1 * volatility / (2 * sqrt_T);
+        v.call_greeks.theta = (decay - risk_free_rate * discounted_strike * n_d2) / 365.0;
+        v.put_greeks.theta = (decay + risk_free_rate * discounted_strike * n_minus_d2) / 365.0;
+    }
+    if constexpr (want_vega) {
+        v.call_greeks.vega = v.put_greeks.vega = spot_price * sqrt_T * pdf_d1 / 100.0;
+    }
+    if constexpr (want_rho) {
+        v.call_greeks.rho = discounted_strike * time_to_expiry * n_d2 / 100.0;
+        v.put_greeks.rho = -discounted_strike * time_to_expiry * n_minus_d2 / 100.0;
+    }
+    return v;
+}
+
+template <unsigned Outputs>
+std::size_t BlackScholesGreeks::calculateAllBatch(
+    const OptionChainView& chain,
+    const GreeksBatchOutput& out,
+    std::uint8_t* status
+) {
+    static_assert((Outputs & ~static_cast<unsigned>(OUTPUT_ALL)) == 0, "unknown GreeksOutput bits");
+    BS_TIMED_SCOPE(METRIC_GREEKS_BATCH);
+    constexpr double NOT_A_NUMBER = std::numeric_limits<double>::quiet_NaN();
+
+    const double* spot = chain.spot_price;
+    const double* strike = chain.strike_price;
+    const double* rate = chain.risk_free_rate;
+    const double* volatility = chain.volatility;
+    const double* expiry = chain.time_to_expiry;
+    double* call_price = out.call_price;
+    double* put_price = out.put_price;
+    double* call_delta = out.call_delta;
+    double* put_delta = out.put_delta;
+    double* gamma = out.gamma;
+    double* call_theta = out.call_theta;
+    double* put_theta = out.put_theta;
+    double* vega = out.vega;
+    double* call_rho = out.call_rho;
+    double* put_rho = out.put_rho;
+    const std::size_t n = chain.size;
+
+    // Lanes are computed into stack tiles and copied out: with up to ten output arrays the
+    // compiler cannot prove they don't overlap the inputs and would give up on vectorizing.
+    constexpr std::size_t TILE = 64;
+    double t_call_price[TILE], t_put_price[TILE], t_call_delta[TILE], t_put_delta[TILE], t_gamma[TILE];
+    double t_call_theta[TILE], t_put_theta[TILE], t_vega[TILE], t_call_rho[TILE], t_put_rho[TILE];
+
+    for (std::size_t base = 0; base < n; base += TILE) {
+      const std::size_t m = std::min(TILE, n - base);
+      const double* S_in = spot + base;
+      const double* K_in = strike + base;
+      const double* r_in = rate + base;
+      const double* vol_in = volatility + base;
+      const double* T_in = expiry + base;
+      for (std::size_t i = 0; i < m; ++i) {
+        const double S = S_in[i];
+        const double K = K_in[i];
+        const double r = r_in[i];
+        const double vol = vol_in[i];
+        const double T = T_in[i];
+        const bool valid = BlackScholesBatch::laneValid(S, K, r, vol, T);
+        const bool expired = T < MIN_TIME_TO_EXPIRY;
+        const bool no_vol = vol < MIN_VOLATILITY;
+        const bool regular = valid & !expired & !no_vol;
+
+        const double T_c = expired ? MIN_TIME_TO_EXPIRY : T;
+        const double vol_c = no_vol ? MIN_VOLATILITY : vol;
+        const double sqrt_T = std::sqrt(T_c);
+        const double sigma_sqrt_T = vol_c * sqrt_T;
+        const double d1 = (FastMath::log(S) - FastMath::log(K) + (r + 0.5 * vol_c * vol_c) * T_c) / sigma_sqrt_T;
+        const double d2 = d1 - sigma_sqrt_T;
+        const double discounted_strike = K * FastMath::exp(-r * T_c);
+
+        // Greeks of edge-case lanes are 0 and everything on invalid lanes is NaN
+        const double greek_fill = valid ? 0.0 : NOT_A_NUMBER;
+        double n_d1, n_minus_d1, n_d2, n_minus_d2;
+        FastMath::standardNormalCDFPair(d1, n_d1, n_minus_d1);
+        FastMath::standardNormalCDFPair(d2, n_d2, n_minus_d2);
+        const double pdf_d1 = FastMath::standardNormalPDF(d1);
+
+        if constexpr ((Outputs & OUTPUT_PRICE) != 0) {
+            double call = S * n_d1 - discounted_strike * n_d2;
+            double put = discounted_strike * n_minus_d2 - S * n_minus_d1;
+            const double call_floor = S - (expired ? K : discounted_strike);
+            call = (expired | no_vol) ? (call_floor > 0.0 ? call_floor : 0.0) : call;
+            put = (expired | no_vol) ? (call_floor < 0.0 ? -call_floor : 0.0) : put;
+            t_call_price[i] = valid ? call : NOT_A_NUMBER;
+            t_put_price[i] = valid ? put : NOT_A_NUMBER;
+        }
+        if constexpr ((Outputs & OUTPUT_DELTA) != 0) {
+            t_call_delta[i] = regular ? n_d1 : greek_fill;
+            t_put_delta[i] = regular ? -n_minus_d1 : greek_fill;
+        }
+        if constexpr ((Outputs & OUTPUT_GAMMA) != 0) {
+            t_gamma[i] = regular ? pdf_d1 / (S * sigma_sqrt_T) : greek_fill;
+        }
+        if constexpr ((Outputs & OUTPUT_THETA) != 0) {
+            const double decay = -S * pdf_d1 * vol_c / (2 * sqrt_T);
+            t_call_theta[i] = regular ? (decay - r * discounted_strike * n_d2) / 365.0 : greek_fill;
+            t_put_theta[i] = regular ? (decay + r * discounted_strike * n_minus_d2) / 365.0 : greek_fill;
+        }
+        if constexpr ((Outputs & OUTPUT_VEGA) != 0) {
+            t_vega[i] = regular ? S * sqrt_T * pdf_d1 / 100.0 : greek_fill;
+        }
+        if constexpr ((Outputs & OUTPUT_RHO) != 0) {
+            t_call_rho[i] = regular ? discounted_strike * T_c * n_d2 / 100.0 : greek_fill;
+            t_put_rho[i] = regular ? -discounted_strike * T_c * n_minus_d2 / 100.0 : greek_fill;
+        }
+      }
+      const auto flush = [base, m](const double* tile, double* dst) { std::copy(tile, tile + m, dst + base); };
+      if constexpr ((Outputs & OUTPUT_PRICE) != 0) { flush(t_call_price, call_price); flush(t_put_price, put_price); }
+      if constexpr ((Outputs & OUTPUT_DELTA) != 0) { flush(t_call_delta, call_delta); flush(t_put_delta, put_delta); }
+      if constexpr ((Outputs & OUTPUT_GAMMA) != 0) { flush(t_gamma, gamma); }
+      if constexpr ((Outputs & OUTPUT_THETA) != 0) { flush(t_call_theta, call_theta); flush(t_put_theta, put_theta); }
+      if constexpr ((Outputs & OUTPUT_VEGA) != 0) { flush(t_vega, vega); }
+      if constexpr ((Outputs & OUTPUT_RHO) != 0) { flush(t_call_rho, call_rho); flush(t_put_rho, put_rho); }
+    }
+    return BlackScholesBatch::classify(chain, status);
+}
+
+// The full set (and the price + delta batch used by OptionStrategy::calculateCurve) is compiled
+// once in black_scholes_greeks.cpp, with the batch FP flags
+extern template OptionValuation BlackScholesGreeks::calculateAll<OUTPUT_ALL>(double, double, double, double, double);
+extern template std::size_t BlackScholesGreeks::calculateAllBatch<OUTPUT_ALL>(
+    const OptionChainView&, const GreeksBatchOutput&, std::uint8_t*);
+extern template std::size_t BlackScholesGreeks::calculateAllBatch<OUTPUT_PRICE | OUTPUT_DELTA>(
+    const OptionChainView&, const GreeksBatchOutput&, std::uint8_t*);
+
 #endif // BLACK_SCHOLES_GREEKS_H
\ No newline at end of file
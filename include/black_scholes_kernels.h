@@ -0,0 +1,172 @@
+#ifndef BLACK_SCHOLES_KERNELS_H
+#define BLACK_SCHOLES_KERNELS_H
+
+#include "fast_math.h"
+#include "option.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+
+/** Whether a kernel validates its inputs and handles the T ~ 0 / vol ~ 0 edges. */
+enum KernelChecks {
+    CHECKED,    // BlackScholes semantics: throws on bad input, intrinsic / discounted-forward edges, std::erf
+    UNCHECKED   // caller guarantees inDomain(); no validation or edge branches
+};
+
+/**
+ * Everything about one (spot, rate, expiry[, flat vol]) that a chain of strikes shares:
+ * log S, sqrt(T), exp(-rT) and, with a flat vol, σ√T, 1/σ√T and the d1 drift (r + σ²/2)T.
+ * Build one per expiry and price every strike against it; setSpot() moves it to a shocked
+ * spot without touching the T terms.
+ */
+struct ExpiryContext {
+    double spot_price{0.0};
+    double log_spot{0.0};
+    double risk_free_rate{0.0};
+    double time_to_expiry{0.0};
+    double sqrt_time{0.0};
+    double discount{1.0};         // exp(-rT)
+    double volatility{std::numeric_limits<double>::quiet_NaN()};  // flat vol; NaN until setVolatility
+    double sigma_sqrt_time{std::numeric_limits<double>::quiet_NaN()};
+    double inverse_sigma_sqrt_time{std::numeric_limits<double>::quiet_NaN()};
+    double drift{std::numeric_limits<double>::quiet_NaN()};  // (r + σ²/2)T
+
+    ExpiryContext() = default;
+    ExpiryContext(double spot, double rate, double T) : risk_free_rate(rate), time_to_expiry(T) {
+        setSpot(spot);
+        sqrt_time = std::sqrt(std::max(T, 0.0));
+        discount = std::exp(-rate * T);
+    }
+    ExpiryContext(double spot, double rate, double T, double vol) : ExpiryContext(spot, rate, T) {
+        setVolatility(vol);
+    }
+
+    void setSpot(double spot) {
+        spot_price = spot;
+        log_spot = spot > 0.0 ? std::log(spot) : std::numeric_limits<double>::quiet_NaN();
+    }
+    void setVolatility(double vol) {
+        volatility = vol;
+        sigma_sqrt_time = vol * sqrt_time;
+        inverse_sigma_sqrt_time = 1.0 / sigma_sqrt_time;
+        drift = (risk_free_rate + 0.5 * vol * vol) * time_to_expiry;
+    }
+};
+
+/**
+ * Black-Scholes prices specialised at compile time on the option type and on KernelChecks,
+ * so a caller that knows both pays for neither the call/put select nor the edge handling:
+ * price<CALL, UNCHECKED>(...) is d1, d2, two CDFs and one exp. CHECKED is what
+ * BlackScholes::calculateCallPrice / calculatePutPrice run (they forward here). UNCHECKED
+ * is undefined outside inDomain(). Inside it, the ExpiryContext overloads were measured within
+ * 5e-16 x max(S, K) of CHECKED for S, K in [1, 201], vol 1e-6..1.01 and T 1e-6..3. Scaled by
+ * strike alone that is up to ~5e-14 (deep in-the-money calls with K << S).
+ */
+class BlackScholesKernel {
+public:
+    static constexpr double MIN_VOLATILITY = 1e-10;
+    static constexpr double MIN_TIME_TO_EXPIRY = 1e-10;
+
+    /** True where UNCHECKED kernels are valid: S, K > 0 and T, vol at least the edge thresholds. */
+    static bool inDomain(double spot, double strike, double volatility, double time_to_expiry) {
+        return spot > 0.0 && strike > 0.0 && std::isfinite(spot) && std::isfinite(strike) &&
+               volatility >= MIN_VOLATILITY && std::isfinite(volatility) && time_to_expiry >= MIN_TIME_TO_EXPIRY &&
+               std::isfinite(time_to_expiry);
+    }
+
+    /**
+     * One contract from scratch. Both modes evaluate with libm (std::erf / std::exp), which is
+     * the faster choice one contract at a time; UNCHECKED only drops the validation and edges.
+     */
+    template <OptionType Type, KernelChecks Checks = CHECKED>
+    static double price(double spot, double strike, double rate, double volatility, double time_to_expiry) {
+        if constexpr (Checks == CHECKED) {
+            validate(spot, strike, time_to_expiry);
+            if (time_to_expiry < MIN_TIME_TO_EXPIRY) return intrinsic<Type>(spot, strike);
+            if (volatility < MIN_VOLATILITY) return discountedForwardIntrinsic<Type>(spot, strike, rate, time_to_expiry);
+        }
+        const double sigma_sqrt_T = volatility * std::sqrt(time_to_expiry);
+        const double d1 = (std::log(spot / strike) + (rate + 0.5 * volatility * volatility) * time_to_expiry) /
+                          sigma_sqrt_T;
+        return combine<Type, CHECKED>(spot, strike * std::exp(-rate * time_to_expiry), d1, d1 - sigma_sqrt_T);
+    }
+
+    /**
+     * One strike against the context's flat vol (setVolatility). UNCHECKED evaluates with
+     * FastMath, so loops over strikes (priceSlice) vectorize.
+     */
+    template <OptionType Type, KernelChecks Checks = CHECKED>
+    static double price(const ExpiryContext& expiry, double strike) {
+        if constexpr (Checks == CHECKED) return price<Type, CHECKED>(expiry, strike, expiry.volatility);
+        const double d1 = (expiry.log_spot - FastMath::log(strike) + expiry.drift) * expiry.inverse_sigma_sqrt_time;
+        return combine<Type, Checks>(expiry.spot_price, strike * expiry.discount, d1, d1 - expiry.sigma_sqrt_time);
+    }
+
+    /** One strike at its own vol (a smile), reusing the context's log S, sqrt(T) and exp(-rT). */
+    template <OptionType Type, KernelChecks Checks = CHECKED>
+    static double price(const ExpiryContext& expiry, double strike, double volatility) {
+        const double spot = expiry.spot_price;
+        const double T = expiry.time_to_expiry;
+        if constexpr (Checks == CHECKED) {
+            validate(spot, strike, T);
+            if (T < MIN_TIME_TO_EXPIRY) return intrinsic<Type>(spot, strike);
+            if (volatility < MIN_VOLATILITY) return discountedForwardIntrinsic<Type>(spot, strike, expiry.risk_free_rate, T);
+        }
+        const double log_strike = Checks == CHECKED ? std::log(strike) : FastMath::log(strike);
+        const double sigma_sqrt_T = volatility * expiry.sqrt_time;
+        const double d1 = (expiry.log_spot - log_strike + (expiry.risk_free_rate + 0.5 * volatility * volatility) * T) /
+                          sigma_sqrt_T;
+        return combine<Type, Checks>(spot, strike * expiry.discount, d1, d1 - sigma_sqrt_T);
+    }
+
+    /**
+     * Pre-validated chain loop: out[i] = price<Type, UNCHECKED> of strike[i] at volatility[i],
+     * or at the context's flat vol when volatility is nullptr. Every lane must be inDomain();
+     * the loop has no branches and vectorizes.
+     */
+    template <OptionType Type>
+    static void priceSlice(const ExpiryContext& expiry, const double* strike, const double* volatility, double* out,
+                           std::size_t count) {
+        if (!volatility) {
+            for (std::size_t i = 0; i < count; ++i) out[i] = price<Type, UNCHECKED>(expiry, strike[i]);
+            return;
+        }
+        for (std::size_t i = 0; i < count; ++i) out[i] = price<Type, UNCHECKED>(expiry, strike[i], volatility[i]);
+    }
+
+private:
+    static void validate(double spot, double strike, double time_to_expiry) {
+        if (spot <= 0 || strike <= 0) throw std::invalid_argument("Invalid input: spot and strike must be positive");
+        if (time_to_expiry < 0) throw std::invalid_argument("Invalid input: time_to_expiry must be non-negative");
+    }
+
+    // T = 0 or effectively zero: Call = max(S-K,0), Put = max(K-S,0)
+    template <OptionType Type>
+    static double intrinsic(double spot, double strike) {
+        return Type == CALL ? std::max(spot - strike, 0.0) : std::max(strike - spot, 0.0);
+    }
+
+    // σ = 0 or effectively zero: the forward's intrinsic value, discounted
+    template <OptionType Type>
+    static double discountedForwardIntrinsic(double spot, double strike, double rate, double time_to_expiry) {
+        const double forward = spot * std::exp(rate * time_to_expiry);
+        return std::exp(-rate * time_to_expiry) * intrinsic<Type>(forward, strike);
+    }
+
+    // Call = S N(d1) - K e^{-rT} N(d2), Put = K e^{-rT} N(-d2) - S N(-d1)
+    template <OptionType Type, KernelChecks Checks>
+    static double combine(double spot, double discounted_strike, double d1, double d2) {
+        if constexpr (Type == CALL) return spot * normalCDF<Checks>(d1) - discounted_strike * normalCDF<Checks>(d2);
+        return discounted_strike * normalCDF<Checks>(-d2) - spot * normalCDF<Checks>(-d1);
+    }
+
+    template <KernelChecks Checks>
+    static double normalCDF(double x) {
+        if constexpr (Checks == CHECKED) return 0.5 * (1.0 + std::erf(x / std::sqrt(2.0)));
+        return FastMath::standardNormalCDF(x);
+    }
+};
+
+#endif // BLACK_SCHOLES_KERNELS_H
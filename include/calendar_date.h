@@ -0,0 +1,82 @@
+#ifndef CALENDAR_DATE_H
+#define CALENDAR_DATE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <stdexcept>
+#include <string>
+
+/**
+ * Dates as int32 day numbers: days since 1970-01-01 in the proleptic Gregorian calendar.
+ * Day numbers sort like the dates and subtract to calendar-day differences.
+ */
+class CalendarDate {
+public:
+    /** Day number of year-month-day (month 1..12, day 1..31). */
+    static constexpr std::int32_t fromCivil(int year, int month, int day) {
+        // H. Hinnant, "chrono-Compatible Low-Level Date Algorithms"
+        const int y = year - (month <= 2 ? 1 : 0);
+        const int era = (y >= 0 ? y : y - 399) / 400;
+        const int yoe = y - era * 400;
+        const int doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+        const int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+        return era * 146097 + doe - 719468;
+    }
+
+    static void toCivil(std::int32_t days, int& year, int& month, int& day) {
+        const int z = days + 719468;
+        const int era = (z >= 0 ? z : z - 146096) / 146097;
+        const int doe = z - era * 146097;
+        const int yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+        const int doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+        const int mp = (5 * doy + 2) / 153;
+        day = doy - (153 * mp + 2) / 5 + 1;
+        month = mp < 10 ? mp + 3 : mp - 9;
+        year = yoe + era * 400 + (month <= 2 ? 1 : 0);
+    }
+
+    /** Parse "YYYY-MM-DD" (the Alpha Vantage date format) into out; false if malformed. */
+    static bool parseIso(const char* text, std::size_t length, std::int32_t& out) noexcept {
+        if (length != 10 || text[4] != '-' || text[7] != '-') return false;
+        int fields[3] = {0, 0, 0};
+        const int starts[3] = {0, 5, 8}, lengths[3] = {4, 2, 2};
+        for (int f = 0; f < 3; ++f) {
+            for (int i = 0; i < lengths[f]; ++i) {
+                const char c = text[starts[f] + i];
+                if (c < '0' || c > '9') return false;
+                fields[f] = fields[f] * 10 + (c - '0');
+            }
+        }
+        if (fields[1] < 1 || fields[1] > 12 || fields[2] < 1 || fields[2] > 31) return false;
+        out = fromCivil(fields[0], fields[1], fields[2]);
+        return true;
+    }
+
+    /** Parse "YYYY-MM-DD". Throws std::invalid_argument. */
+    static std::int32_t fromIso(const std::string& iso) {
+        std::int32_t days = 0;
+        if (!parseIso(iso.data(), iso.size(), days)) {
+            throw std::invalid_argument("Invalid date (expected YYYY-MM-DD): " + iso);
+        }
+        return days;
+    }
+
+    static std::string toIso(std::int32_t days) {
+        int year = 0, month = 0, day = 0;
+        toCivil(days, year, month, day);
+        char buffer[32];  // room for any int year, so -Wformat-truncation can prove it fits
+        std::snprintf(buffer, sizeof(buffer), "%04d-%02d-%02d", year, month, day);
+        return buffer;
+    }
+
+    /** Today's day number in local time. */
+    static std::int32_t today() {
+        const std::time_t now = std::time(nullptr);
+        const std::tm local = *std::localtime(&now);
+        return fromCivil(local.tm_year + 1900, local.tm_mon + 1, local.tm_mday);
+    }
+};
+
+#endif // CALENDAR_DATE_H
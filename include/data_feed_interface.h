@@ -2,14 +2,10 @@
 #define DATA_FEED_INTERFACE_H
 
 #include "optional_double.h"
+#include "price_series.h"
 #include <string>
 #include <vector>
 
-struct StockPrice {
-    double price{0.0};
-    std::string timestamp;
-};
-
 /** Abstract base for market data feeds (Alpha Vantage, Paper, Alpaca, etc.). */
 class DataFeedInterface {
 public:
@@ -17,6 +13,14 @@ public:
 
     virtual OptionalDouble getCurrentPrice(const std::string& symbol) const = 0;
 
+    /** Quotes for many symbols, in order. Default: one getCurrentPrice per symbol; feeds that can overlap requests override it. */
+    virtual std::vector<OptionalDouble> getCurrentPrices(const std::vector<std::string>& symbols) const {
+        std::vector<OptionalDouble> prices;
+        prices.reserve(symbols.size());
+        for (const auto& symbol : symbols) prices.push_back(getCurrentPrice(symbol));
+        return prices;
+    }
+
     /** Optional: push a price (no-op for live API feeds; PaperFeed overrides). */
     virtual void setCurrentPrice(const std::string& symbol, double price) { (void)symbol; (void)price; }
 
@@ -26,12 +30,16 @@ public:
         const std::string& end_date
     ) = 0;
 
-    virtual std::vector<StockPrice> getHistoricalPrices(const std::string& symbol) const = 0;
+    /**
+     * Series kept by the last successful fetchHistoricalPrices for symbol (empty if none),
+     * chronological. The view stays valid until the next fetch for that symbol.
+     */
+    virtual PriceSeriesView getHistoricalPrices(const std::string& symbol) const = 0;
 
     /** Last error message (empty if none). Optional for implementers. */
     virtual std::string lastError() const { return {}; }
 
-    /** True if the last quote for symbol is older than max_age_seconds (if feed supports timestamps). */
+    /** True if the last quote for symbol is older than max_age_seconds (if feed supports timestamps; default: never stale). */
     virtual bool isStaleQuote(const std::string& symbol, int max_age_seconds) const { (void)symbol; (void)max_age_seconds; return false; }
 };
 
@@ -13,35 +13,32 @@ public:
     // Calculate historical volatility from a series of prices
     // Returns annualized volatility (as a decimal, not percentage)
     static double calculateFromPrices(const std::vector<double>& prices) {
-        if (prices.size() < 2) {
+        return calculateFromPrices(prices.data(), prices.size());
+    }
+
+    // Same, over count prices in chronological order (no copy)
+    static double calculateFromPrices(const double* prices, std::size_t count) {
+        if (count < 2) {
             throw std::invalid_argument("Need at least two price points to calculate volatility");
         }
 
-        // Calculate log returns: ln(price_t / price_{t-1})
-        std::vector<double> log_returns;
-        log_returns.reserve(prices.size() - 1);
-        
-        for (size_t i = 1; i < prices.size(); ++i) {
+        // Mean of log returns ln(price_t / price_{t-1}), then sample variance around it
+        double sum = 0.0;
+        for (size_t i = 1; i < count; ++i) {
             if (prices[i] <= 0 || prices[i-1] <= 0) {
                 throw std::invalid_argument("Prices must be positive for log return calculation");
             }
-            log_returns.push_back(std::log(prices[i] / prices[i-1]));
-        }
-        
-        // Calculate mean of log returns
-        double sum = 0.0;
-        for (double ret : log_returns) {
-            sum += ret;
+            sum += std::log(prices[i] / prices[i-1]);
         }
-        double mean = sum / log_returns.size();
+        const size_t returns = count - 1;
+        double mean = sum / returns;
         
-        // Calculate variance of log returns
         double variance = 0.0;
-        for (double ret : log_returns) {
-            double diff = ret - mean;
+        for (size_t i = 1; i < count; ++i) {
+            double diff = std::log(prices[i] / prices[i-1]) - mean;
             variance += diff * diff;
         }
-        variance /= (log_returns.size() - 1);  // Use sample variance (n-1 denominator)
+        variance /= (returns - 1);  // Use sample variance (n-1 denominator)
         
         // Standard deviation of log returns
         double volatility = std::sqrt(variance);
@@ -50,24 +47,17 @@ public:
         return volatility * std::sqrt(252.0);  // 252 trading days in a year
     }
     
-    // Calculate historical volatility from StockPrice objects
-    static double calculateFromStockPrices(const std::vector<StockPrice>& stock_prices) {
-        if (stock_prices.empty()) {
-            throw std::invalid_argument("Empty price vector");
+    // Calculate historical volatility from a feed's series (chronological; no copy).
+    // Uses adjusted close when the series has it, else close.
+    static double calculateFromStockPrices(const PriceSeriesView& series) {
+        if (series.empty()) {
+            throw std::invalid_argument("Empty price series");
         }
-        
-        // Extract prices from StockPrice objects
-        std::vector<double> prices;
-        prices.reserve(stock_prices.size());
-        
-        for (const auto& sp : stock_prices) {
-            prices.push_back(sp.price);
+        const double* prices = series.prices();
+        if (!prices) {
+            throw std::invalid_argument("Price series has no close column");
         }
-        
-        // Ensure prices are in chronological order (oldest to newest)
-        std::reverse(prices.begin(), prices.end());
-        
-        return calculateFromPrices(prices);
+        return calculateFromPrices(prices, series.size);
     }
     
     // Calculate historical volatility using a specific timeframe (in trading days)
@@ -80,12 +70,8 @@ public:
         }
         
         // Use only the most recent window_days prices
-        std::vector<double> recent_prices(
-            prices.end() - window_days - 1,
-            prices.end()
-        );
-        
-        return calculateFromPrices(recent_prices);
+        return calculateFromPrices(prices.data() + prices.size() - window_days - 1,
+                                   static_cast<std::size_t>(window_days) + 1);
     }
 };
 
@@ -0,0 +1,91 @@
+#ifndef HTTP_CLIENT_H
+#define HTTP_CLIENT_H
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/**
+ * Token bucket: up to `burst` requests at once, refilled at requests_per_minute / 60 per
+ * second. Thread-safe.
+ */
+class RateLimiter {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit RateLimiter(double requests_per_minute, double burst = 1.0);
+
+    /** Take a token if one is available now. */
+    bool tryAcquire();
+
+    /** Time until tryAcquire() would next succeed (zero if it would now). */
+    Clock::duration timeUntilAvailable();
+
+    /** Blocks until a token is available, then takes it. */
+    void acquire();
+
+private:
+    void refill(Clock::time_point now);
+
+    std::mutex mutex_;
+    double tokens_;
+    double capacity_;
+    double tokens_per_second_;
+    Clock::time_point last_refill_;
+};
+
+/** Outcome of one GET. error is non-empty when the transfer itself failed (no HTTP status). */
+struct HttpResponse {
+    long status{0};
+    std::string body;
+    std::string error;
+};
+
+/**
+ * Asynchronous HTTP GET client on one curl multi handle driven by a background thread.
+ *
+ * Connections (and TLS sessions, DNS lookups) are cached by the multi/share handles and reused
+ * across requests to the same host instead of being set up per call. Requests are started no
+ * faster than the optional RateLimiter allows; waiting requests are queued, not rejected.
+ */
+class AsyncHttpClient {
+public:
+    using Completion = std::function<void(HttpResponse)>;
+
+    /** limiter may be nullptr (no limit); it must outlive the client. */
+    explicit AsyncHttpClient(RateLimiter* limiter = nullptr, long max_host_connections = 6);
+    ~AsyncHttpClient();
+
+    AsyncHttpClient(const AsyncHttpClient&) = delete;
+    AsyncHttpClient& operator=(const AsyncHttpClient&) = delete;
+
+    /** Queue a GET; on_done runs on the client's thread when it finishes. It must not throw. */
+    void get(const std::string& url, Completion on_done);
+
+    /** Queue a GET; the future throws std::runtime_error if the transfer failed. */
+    std::future<HttpResponse> get(const std::string& url);
+
+private:
+    struct Request {
+        std::string url;
+        Completion on_done;
+    };
+
+    void run();
+
+    RateLimiter* limiter_;
+    long max_host_connections_;
+    void* multi_{nullptr};   // CURLM*
+    void* share_{nullptr};   // CURLSH*, only touched from the worker thread, so no lock callbacks
+    std::mutex mutex_;
+    std::deque<Request> queue_;
+    bool stopping_{false};
+    std::thread worker_;
+};
+
+#endif // HTTP_CLIENT_H
@@ -0,0 +1,108 @@
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/** Instrumented hot paths, one latency histogram each. */
+enum Metric : std::uint8_t {
+    METRIC_PRICE_BATCH,     // BlackScholesBatch::price / priceExpirySlice calls
+    METRIC_GREEKS_BATCH,    // BlackScholesGreeks::calculateAllBatch calls
+    METRIC_IMPLIED_VOL,     // BlackScholesBatch::impliedVolatility calls
+    METRIC_MC_CHUNK,        // one Monte Carlo chunk of paths
+    METRIC_HTTP_REQUEST,    // AsyncHttpClient transfer, started (past the rate limiter) to done
+    METRIC_JSON_PARSE,      // parsing one Alpha Vantage response
+    METRIC_REPRICE,         // PaperTradingSystem::repriceDirtyPositions
+    METRIC_PORTFOLIO_RISK,  // PortfolioRiskEngine::compute
+    METRIC_COUNT
+};
+
+/** Totals of one metric over every thread. Percentiles are bucket upper bounds, within 1/16. */
+struct LatencySummary {
+    Metric metric;
+    std::uint64_t count{0};
+    std::uint64_t total_ns{0};
+    std::uint64_t max_ns{0};
+    std::uint64_t p50_ns{0};
+    std::uint64_t p90_ns{0};
+    std::uint64_t p99_ns{0};
+    std::uint64_t p999_ns{0};
+};
+
+/**
+ * Process-wide latency histograms, HDR-style: values below 16 ns are exact, then each power of
+ * two is split into 16 linear sub-buckets. Every thread records into its own block with
+ * relaxed atomic stores (one writer per block, so no read-modify-write and no lock). Readers
+ * merge the blocks, including those of threads that have exited (an exited thread's block is
+ * handed to the next new thread, so short-lived threads do not add blocks). Building with
+ * BS_ENABLE_INSTRUMENTATION off compiles BS_TIMED_SCOPE out; the rest of the API stays and
+ * reports zeros.
+ */
+class Instrumentation {
+public:
+    static constexpr int SUB_BUCKET_BITS = 4;
+    static constexpr int MAX_EXPONENT = 47;  // 2^48 ns ~ 3 days; longer lands in the last bucket
+    static constexpr std::size_t BUCKET_COUNT =
+        static_cast<std::size_t>(MAX_EXPONENT - SUB_BUCKET_BITS + 2) << SUB_BUCKET_BITS;
+
+    /** Whether BS_TIMED_SCOPE is compiled in. */
+    static constexpr bool enabled() {
+#ifdef BS_ENABLE_INSTRUMENTATION
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    static void record(Metric metric, std::uint64_t nanoseconds) noexcept;
+
+    static const char* name(Metric metric);
+    static std::size_t bucketIndex(std::uint64_t nanoseconds) noexcept;
+    /** Largest value that lands in bucket index. */
+    static std::uint64_t bucketUpperBound(std::size_t index) noexcept;
+
+    /** One entry per Metric, in enum order. */
+    static std::vector<LatencySummary> summary();
+    /** {"enabled": ..., "metrics": {"<name>": {"count": ..., "p50_ns": ..., ...}, ...}} */
+    static std::string toJson();
+    /** Prometheus text format: one histogram per metric, buckets in seconds. */
+    static std::string toPrometheus();
+
+    /** Zero every histogram. Records racing with it may be lost; meant for between runs. */
+    static void reset();
+};
+
+/** Records the time from construction to destruction into metric. */
+class ScopedTimer {
+public:
+    explicit ScopedTimer(Metric metric) noexcept : metric_(metric), start_(Clock::now()) {}
+    ~ScopedTimer() {
+        const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start_);
+        Instrumentation::record(metric_, static_cast<std::uint64_t>(elapsed.count()));
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    using Clock = std::chrono::steady_clock;
+    Metric metric_;
+    Clock::time_point start_;
+};
+
+#define BS_INSTRUMENTATION_CONCAT_(a, b) a##b
+#define BS_INSTRUMENTATION_CONCAT(a, b) BS_INSTRUMENTATION_CONCAT_(a, b)
+#ifdef BS_ENABLE_INSTRUMENTATION
+/** Time the rest of the enclosing scope into metric. */
+#define BS_TIMED_SCOPE(metric) const ScopedTimer BS_INSTRUMENTATION_CONCAT(bs_timed_scope_, __LINE__)(metric)
+/** Record an interval measured by the caller (nanoseconds). */
+#define BS_RECORD_LATENCY(metric, nanoseconds) Instrumentation::record(metric, nanoseconds)
+#else
+#define BS_TIMED_SCOPE(metric) ((void)0)
+#define BS_RECORD_LATENCY(metric, nanoseconds) ((void)0)
+#endif
+
+#endif // INSTRUMENTATION_H
@@ -0,0 +1,108 @@
+#ifndef LEG_TABLE_H
+#define LEG_TABLE_H
+
+#include "option.h"
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <limits>
+#include <vector>
+
+class OptionStrategy;
+
+/** Pricing inputs shared by every leg of a LegTable evaluation. */
+struct LegPricingConfig {
+    double risk_free_rate{0.05};
+    double volatility{0.2};
+};
+
+/**
+ * P&L extremes and breakevens of one strategy at its first expiry. An unbounded side is
+ * UNLIMITED; max_loss is positive for a loss, like OptionStrategy::calculateMaxLoss.
+ */
+struct StrategyMetrics {
+    static constexpr double UNLIMITED = std::numeric_limits<double>::infinity();
+
+    double max_profit{0.0};
+    double max_loss{0.0};
+    std::vector<double> breakevens;  // ascending
+};
+
+/**
+ * Any number of multi-leg strategies as structure-of-arrays, one row per option leg.
+ *
+ * Each strategy owns a contiguous row range plus a stock holding and an entry cost (what was
+ * paid to open it, so P&L = value - entry cost). Legs are appended to the most recently added
+ * strategy. Quantities are signed contracts (negative = short); multiplier is shares per contract.
+ * Evaluation prices legs x underlying prices through one BlackScholesGreeks::calculateAllBatch
+ * pass per strategy, without virtual calls or per-leg strings.
+ */
+class LegTable {
+public:
+    static constexpr double DEFAULT_MULTIPLIER = 100.0;
+
+    /** Start a new strategy; returns its index. */
+    std::size_t addStrategy(double stock_shares = 0.0, double entry_cost = 0.0);
+    /** Append a leg to the last strategy added (throws if there is none). */
+    void addLeg(OptionType type, double strike, std::time_t expiry, double quantity,
+                double multiplier = DEFAULT_MULTIPLIER);
+    /** Copy an OptionStrategy's legs, stock and entry price in as a new strategy. */
+    std::size_t addStrategy(const OptionStrategy& strategy);
+
+    /** A table holding just strategy. */
+    static LegTable fromStrategy(const OptionStrategy& strategy);
+
+    std::size_t size() const { return strike_.size(); }
+    std::size_t strategyCount() const { return stock_shares_.size(); }
+    std::size_t rowBegin(std::size_t strategy) const { return row_begin_[strategy]; }
+    std::size_t rowEnd(std::size_t strategy) const {
+        return strategy + 1 < row_begin_.size() ? row_begin_[strategy + 1] : size();
+    }
+    /** Earliest leg expiry of strategy, or 0 if it has no legs. */
+    std::time_t firstExpiry(std::size_t strategy) const;
+
+    const std::vector<OptionType>& type() const { return type_; }
+    const std::vector<double>& strike() const { return strike_; }
+    const std::vector<std::time_t>& expiry() const { return expiry_; }
+    const std::vector<double>& quantity() const { return quantity_; }
+    const std::vector<double>& multiplier() const { return multiplier_; }
+    const std::vector<double>& stockShares() const { return stock_shares_; }
+    const std::vector<double>& entryCost() const { return entry_cost_; }
+
+    /**
+     * Value (and optionally delta) of strategy at each of count underlying prices, valued at time
+     * `at`: legs expiring by then are worth intrinsic. deltas may be nullptr. Non-positive
+     * prices give NaN.
+     */
+    void value(std::size_t strategy, const double* prices, std::size_t count, std::time_t at,
+               const LegPricingConfig& config, double* values, double* deltas = nullptr) const;
+    /** value() - entry cost. */
+    void profitLoss(std::size_t strategy, const double* prices, std::size_t count, std::time_t at,
+                    const LegPricingConfig& config, double* profit_loss) const;
+    /** P&L of every strategy at the same prices: profit_loss[strategy * count + i]. */
+    void profitLossAll(const double* prices, std::size_t count, std::time_t at, const LegPricingConfig& config,
+                       double* profit_loss) const;
+
+    /**
+     * Max profit, max loss and breakevens at firstExpiry(strategy), found numerically. P&L is
+     * evaluated at S = 0, at every strike and (when legs expire on different dates, so the
+     * curve is not piecewise linear) on a 256-point grid up to twice the top strike. Breakevens
+     * are interpolated between points, which is exact when all legs share an expiry. The tail
+     * beyond the last point has slope shares + call contracts x multiplier.
+     */
+    StrategyMetrics metrics(std::size_t strategy, const LegPricingConfig& config) const;
+    std::vector<StrategyMetrics> metricsAll(const LegPricingConfig& config) const;
+
+private:
+    std::vector<OptionType> type_;
+    std::vector<double> strike_;
+    std::vector<std::time_t> expiry_;
+    std::vector<double> quantity_;
+    std::vector<double> multiplier_;
+
+    std::vector<std::uint32_t> row_begin_;
+    std::vector<double> stock_shares_;
+    std::vector<double> entry_cost_;
+};
+
+#endif // LEG_TABLE_H
@@ -3,40 +3,103 @@
 
 #include "data_feed_interface.h"
 #include "optional_double.h"
+#include "quote_store.h"
+#include <chrono>
+#include <condition_variable>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
-#include <unordered_map>
+#include <thread>
 #include <vector>
 
+/**
+ * Quotes and history from a DataFeedInterface. Current prices are cached in a QuoteStore:
+ * reads never block on the network. A missing or stale (older than the TTL) feed quote is
+ * refreshed by a background thread, and the cached value, if any, is returned meanwhile.
+ * Manually set prices are never refreshed from the feed.
+ */
 class MarketDataProvider {
 public:
+    static constexpr std::chrono::seconds DEFAULT_QUOTE_TTL{60};
+
+    /** Called with (symbol id, new price) when a cached price changes. */
+    using QuoteListener = std::function<void(SymbolId, double)>;
+
     /** Take ownership of a data feed (e.g. AlphaVantageFeed or PaperFeed). */
-    explicit MarketDataProvider(std::unique_ptr<DataFeedInterface> feed);
+    explicit MarketDataProvider(std::unique_ptr<DataFeedInterface> feed,
+                                std::chrono::milliseconds quote_ttl = DEFAULT_QUOTE_TTL);
 
     /** Backwards-compatible: build an AlphaVantageFeed from API key. */
     explicit MarketDataProvider(const std::string& alpha_vantage_api_key);
 
+    ~MarketDataProvider();
+
     MarketDataProvider(const MarketDataProvider&) = delete;
     MarketDataProvider& operator=(const MarketDataProvider&) = delete;
 
+    /** Fetch now (blocking) and cache the result. */
     bool updateCurrentPrice(const std::string& symbol);
+    /** Refresh many symbols in one feed call; returns the symbols whose price was updated. */
+    std::vector<std::string> updateCurrentPrices(const std::vector<std::string>& symbols);
     void setCurrentPrice(const std::string& symbol, double price);
+
+    /** Cached price (possibly stale); empty on a miss. Misses and stale quotes queue a background refresh. */
     OptionalDouble getCurrentPrice(const std::string& symbol) const;
 
+    /** Interned id for symbol, for lock-free reads on hot paths. */
+    SymbolId symbolId(const std::string& symbol) const { return quotes_->intern(symbol); }
+    std::string symbolName(SymbolId id) const { return quotes_->symbol(id); }
+    OptionalDouble getCurrentPrice(SymbolId id) const;
+    bool getQuote(SymbolId id, Quote& out) const { return quotes_->read(id, out); }
+
+    /** True if the cached quote is missing or older than max_age_seconds (the TTL if negative). */
+    bool isStaleQuote(const std::string& symbol, int max_age_seconds = -1) const;
+
+    /** Queue a background fetch of symbol (no-op if one was queued within the retry interval). */
+    void requestRefresh(const std::string& symbol) const;
+
+    /**
+     * Register listener for price changes. It runs on the updating thread (possibly the
+     * background refresher), so it must be thread-safe and quick. Returns a token for unsubscribe.
+     */
+    std::size_t subscribe(QuoteListener listener);
+    void unsubscribe(std::size_t token);
+
     bool fetchHistoricalPrices(
         const std::string& symbol,
         const std::string& start_date,
         const std::string& end_date
     );
 
-    std::vector<StockPrice> getHistoricalPrices(const std::string& symbol) const;
+    PriceSeriesView getHistoricalPrices(const std::string& symbol) const;
 
     /** Last error from the underlying feed, if any. */
     std::string lastError() const;
 
 private:
+    void refreshIfStale(SymbolId id, const Quote* quote) const;
+    void enqueueRefresh(SymbolId id) const;
+    void refreshLoop() const;
+    void storeFetched(const std::vector<std::string>& symbols, const std::vector<OptionalDouble>& prices,
+                      std::vector<std::string>* updated) const;
+    /** Write a quote and notify listeners if the price changed. */
+    void storeQuote(SymbolId id, double price, QuoteSource source) const;
+
     std::unique_ptr<DataFeedInterface> feed_;
-    std::unordered_map<std::string, double> current_prices_cache_;
+    mutable std::mutex feed_mutex_;  // feeds are not required to be thread-safe
+    std::unique_ptr<QuoteStore> quotes_;
+
+    mutable std::mutex listeners_mutex_;
+    std::vector<std::pair<std::size_t, QuoteListener>> listeners_;
+    std::size_t next_listener_token_{1};
+
+    // Background refresher, started on first use
+    mutable std::mutex refresh_mutex_;
+    mutable std::condition_variable refresh_wake_;
+    mutable std::vector<SymbolId> refresh_queue_;
+    mutable std::thread refresher_;
+    mutable bool stopping_{false};
 };
 
 #endif
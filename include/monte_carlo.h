@@ -1,17 +1,127 @@
 #ifndef MONTE_CARLO_H
 #define MONTE_CARLO_H
 
+#include "option.h"
 #include <cmath>
+#include <atomic>
 #include <vector>
 #include <functional>
 #include <cstddef>
+#include <cstdint>
+
+class TaskExecutor;
 
 /** Progress callback: (done, total) for UI updates. */
 using MonteCarloProgressCallback = std::function<void(int done, int total)>;
 
+/**
+ * Streamed block of simulated paths: prices[k * (steps_per_path + 1) + t] is step t of path
+ * first_path + k, for k < num_paths. Blocks arrive in no particular order and may be delivered
+ * concurrently from worker threads; the buffer is only valid during the call.
+ */
+using MonteCarloPathCallback = std::function<void(int first_path, int num_paths, const double* prices)>;
+
+/**
+ * One chunk of stepped paths from simulatePathChunks. prices is step-major,
+ * prices[t * num_paths + k] for t = 0..steps (t = 0 is the spot). Both arrays are only valid
+ * during the call.
+ */
+struct MonteCarloPathChunk {
+    std::size_t index;      // chunk number within the call, for merging results in order
+    long long first_path;
+    int num_paths;
+    int steps;
+    bool antithetic;        // path num_paths / 2 + i mirrors path i; score each pair as one sample
+    const double* prices;
+    const double* normals;  // the draws behind the paths, normals[t * num_paths + k] for t < steps
+};
+
+/** Chunks may be delivered concurrently from worker threads, in no particular order. */
+using MonteCarloChunkCallback = std::function<void(const MonteCarloPathChunk& chunk)>;
+
+/** Memory order of a contiguous path buffer of num_paths x (steps_per_path + 1) prices. */
+enum PathLayout {
+    LAYOUT_PATH_MAJOR,  // out[path * (steps_per_path + 1) + step]: each path contiguous
+    LAYOUT_STEP_MAJOR   // out[step * num_paths + path]: each time slice contiguous
+};
+
+/** How paths are generated. */
+enum MonteCarloSampling {
+    SAMPLING_AUTO,      // terminal for path-independent payoffs (all vanillas), stepped otherwise
+    SAMPLING_TERMINAL,  // one exact log-normal draw of S_T per path
+    SAMPLING_STEPPED    // daily GBM steps (252 per year); what path-dependent payoffs need
+};
+
+/** Source of the normal draws. */
+enum MonteCarloGenerator {
+    RNG_MT19937,  // std::mt19937 + std::normal_distribution per chunk (the original generator)
+    RNG_PHILOX,   // Philox4x32-10 with one counter stream per path; inverse-CDF normals
+    RNG_SOBOL     // scrambled Sobol' points, one dimension per time step; inverse-CDF normals
+};
+
+/** Variance reduction techniques; OR together into MonteCarloConfig::variance_reduction. */
+enum VarianceReduction : unsigned {
+    VR_NONE             = 0,
+    VR_ANTITHETIC       = 1u << 0,  // every normal draw z is paired with -z
+    VR_CONTROL_VARIATE  = 1u << 1,  // Black-Scholes call on the same strike, regression beta
+    VR_MOMENT_MATCHING  = 1u << 2   // each chunk's normals rescaled to mean 0, variance 1 per step
+};
+
+/** Estimate plus its standard error; num_paths counts antithetic partners separately. */
+struct MonteCarloResult {
+    double price{0.0};
+    double std_error{0.0};
+    long long num_paths{0};
+    bool cancelled{false};  // stopped early through MonteCarloConfig::cancel; num_paths were used
+};
+
+/** Call and put estimated from the same simulated terminal prices. */
+struct MonteCarloCallPutResult {
+    MonteCarloResult call;
+    MonteCarloResult put;
+};
+
+/** Settings for one Monte Carlo run. */
+struct MonteCarloConfig {
+    int num_simulations{10000};
+    /**
+     * Simulations are split into fixed-size chunks and chunk k is always seeded from (seed, k),
+     * so the same seed gives the same price whatever the thread count or scheduling.
+     */
+    std::uint64_t seed{0};
+    MonteCarloSampling sampling{SAMPLING_AUTO};
+    /**
+     * With RNG_PHILOX path n is drawn from stream (seed, n), so any path can be regenerated on
+     * its own. RNG_SOBOL is quasi-random: the error falls faster than 1/sqrt(n), and std_error
+     * (the i.i.d. formula) overstates it.
+     */
+    MonteCarloGenerator generator{RNG_PHILOX};
+    bool brownian_bridge{true};                 // RNG_SOBOL, stepped: build paths by Brownian bridge
+    unsigned variance_reduction{VR_NONE};       // VarianceReduction bits
+    /**
+     * > 0: after the first num_simulations, keep adding waves of chunks (sized from the error so
+     * far) until std_error <= target_std_error or max_simulations paths have been used.
+     */
+    double target_std_error{0.0};
+    int max_simulations{10000000};
+    TaskExecutor* executor{nullptr};            // nullptr: TaskExecutor::shared()
+    /**
+     * Optional cooperative cancellation, checked before each chunk starts: once set, no new
+     * chunks run and the pricer returns what has been simulated, flagged as cancelled.
+     */
+    const std::atomic<bool>* cancel{nullptr};
+    MonteCarloProgressCallback progress_cb;    // after each chunk; may run on a worker thread
+};
+
 class MonteCarloOptionPricer {
 public:
-    /** Call: single-threaded, no progress. */
+    /** Paths per chunk. Chunk k of a run is always seeded from (seed, k). */
+    static constexpr int CHUNK_SIMULATIONS = 1000;
+
+    /** Daily (252 per year) step count that SAMPLING_STEPPED uses for time_to_expiry, at least 1. */
+    static int steppedStepCount(double time_to_expiry);
+
+    /** Call: no progress, random seed. */
     static double priceCallOption(
         double spot_price,
         double strike_price,
@@ -21,7 +131,7 @@ public:
         int num_simulations = 10000
     );
 
-    /** Call: optional progress callback; uses std::async for parallelism. */
+    /** Call: optional progress callback; random seed, runs on TaskExecutor::shared(). */
     static double priceCallOption(
         double spot_price,
         double strike_price,
@@ -32,7 +142,7 @@ public:
         MonteCarloProgressCallback progress_cb
     );
 
-    /** Put: single-threaded, no progress. */
+    /** Put: no progress, random seed. */
     static double pricePutOption(
         double spot_price,
         double strike_price,
@@ -42,7 +152,7 @@ public:
         int num_simulations = 10000
     );
 
-    /** Put: optional progress callback; uses std::async for parallelism. */
+    /** Put: optional progress callback; random seed, runs on TaskExecutor::shared(). */
     static double pricePutOption(
         double spot_price,
         double strike_price,
@@ -53,6 +163,50 @@ public:
         MonteCarloProgressCallback progress_cb
     );
 
+    /** Call: seeded, reproducible run on config.executor. */
+    static double priceCallOption(
+        double spot_price,
+        double strike_price,
+        double risk_free_rate,
+        double volatility,
+        double time_to_expiry,
+        const MonteCarloConfig& config
+    );
+
+    /** Put: seeded, reproducible run on config.executor. */
+    static double pricePutOption(
+        double spot_price,
+        double strike_price,
+        double risk_free_rate,
+        double volatility,
+        double time_to_expiry,
+        const MonteCarloConfig& config
+    );
+
+    /** European call or put with standard error; honours every MonteCarloConfig field. */
+    static MonteCarloResult priceOption(
+        double spot_price,
+        double strike_price,
+        double risk_free_rate,
+        double volatility,
+        double time_to_expiry,
+        OptionType option_type,
+        const MonteCarloConfig& config
+    );
+
+    /**
+     * Call and put in one pass over the same paths: half the simulation work of pricing them
+     * separately. With target_std_error, runs until both errors are below it.
+     */
+    static MonteCarloCallPutResult priceCallAndPut(
+        double spot_price,
+        double strike_price,
+        double risk_free_rate,
+        double volatility,
+        double time_to_expiry,
+        const MonteCarloConfig& config
+    );
+
     static std::vector<std::vector<double>> simulatePricePaths(
         double spot_price,
         double risk_free_rate,
@@ -61,6 +215,71 @@ public:
         int num_paths = 100,
         int steps_per_path = 252
     );
+
+    /** Paths generated in parallel on config.executor, reproducible under config.seed. */
+    static std::vector<std::vector<double>> simulatePricePaths(
+        double spot_price,
+        double risk_free_rate,
+        double volatility,
+        double time_to_expiry,
+        int num_paths,
+        int steps_per_path,
+        const MonteCarloConfig& config
+    );
+
+    /**
+     * Same paths as above, written into a caller-owned buffer of num_paths * (steps_per_path + 1)
+     * doubles in the given layout; nothing is allocated per path. Step 0 is spot_price.
+     */
+    static void simulatePricePaths(
+        double spot_price,
+        double risk_free_rate,
+        double volatility,
+        double time_to_expiry,
+        int num_paths,
+        int steps_per_path,
+        const MonteCarloConfig& config,
+        double* out,
+        PathLayout layout
+    );
+
+    /**
+     * Same paths again, handed to on_block a block at a time instead of being stored, so
+     * statistics can be aggregated over more paths than fit in memory.
+     */
+    static void streamPricePaths(
+        double spot_price,
+        double risk_free_rate,
+        double volatility,
+        double time_to_expiry,
+        int num_paths,
+        int steps_per_path,
+        const MonteCarloConfig& config,
+        const MonteCarloPathCallback& on_block
+    );
+
+    /**
+     * GBM paths first_path .. first_path + num_paths - 1 in chunks of CHUNK_SIMULATIONS, on
+     * config.executor, with config.generator and the antithetic / moment-matching bits of
+     * config.variance_reduction. Chunk j uses chunkSeed(config.seed, first_chunk + j), so runs
+     * extended in waves stay reproducible. Chunks not started once config.cancel is set are
+     * skipped; progress_cb is not called. The engine behind MonteCarloPayoffPricer.
+     */
+    static void simulatePathChunks(
+        double spot_price,
+        double risk_free_rate,
+        double volatility,
+        double time_to_expiry,
+        int steps,
+        long long first_path,
+        long long num_paths,
+        std::size_t first_chunk,
+        const MonteCarloConfig& config,
+        const MonteCarloChunkCallback& on_chunk
+    );
+
+    /** Seed of chunk (or path block) `index` of a run seeded with `seed` (SplitMix64). */
+    static std::uint64_t chunkSeed(std::uint64_t seed, std::uint64_t index) noexcept;
 };
 
 #endif
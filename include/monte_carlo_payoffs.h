@@ -0,0 +1,530 @@
+#ifndef MONTE_CARLO_PAYOFFS_H
+#define MONTE_CARLO_PAYOFFS_H
+
+#include "black_scholes_greeks.h"
+#include "monte_carlo.h"
+#include "option_strategy.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+// Path observers: building blocks of payoff states. start() sees the spot, observe() every
+// monitoring price (one per step, the last being S_T).
+
+struct TerminalObserver {
+    double last{0.0};
+    void start(double spot) { last = spot; }
+    void observe(double price) { last = price; }
+};
+
+/** Arithmetic average over the monitoring prices (the spot at t = 0 is not included). */
+struct AverageObserver {
+    double sum{0.0};
+    int count{0};
+    void start(double) { sum = 0.0; count = 0; }
+    void observe(double price) { sum += price; ++count; }
+    double average() const { return count ? sum / count : 0.0; }
+};
+
+struct ExtremaObserver {
+    double minimum{0.0};
+    double maximum{0.0};
+    void start(double spot) { minimum = maximum = spot; }
+    void observe(double price) { minimum = std::min(minimum, price); maximum = std::max(maximum, price); }
+};
+
+/** Whether the path has touched a level from below (up) or above (down), spot included. */
+struct BarrierObserver {
+    bool hit{false};
+    void start(double spot, double level, bool up) { hit = up ? spot >= level : spot <= level; }
+    void observe(double price, double level, bool up) { hit = hit || (up ? price >= level : price <= level); }
+};
+
+/**
+ * Payoffs for MonteCarloPayoffPricer. Each one has a State built from observers,
+ * start(state, spot), observe(state, price) and payoff(state) (undiscounted). PATH_DEPENDENT
+ * payoffs make the pricer take daily steps; if none is, one exact terminal step is used unless
+ * config.sampling is SAMPLING_STEPPED. PATHWISE_GREEKS payoffs are differentiated along the
+ * path in priceWithGreeks; the others get likelihood-ratio estimates.
+ */
+struct VanillaPayoff {
+    static constexpr bool PATH_DEPENDENT = false;
+    static constexpr bool PATHWISE_GREEKS = true;
+    using State = TerminalObserver;
+
+    OptionType type;
+    double strike;
+
+    void start(State& state, double spot) const { state.start(spot); }
+    void observe(State& state, double price) const { state.observe(price); }
+    double payoff(const State& state) const {
+        return type == CALL ? std::max(state.last - strike, 0.0) : std::max(strike - state.last, 0.0);
+    }
+};
+
+/** Cash-or-nothing digital: pays amount if S_T finishes in the money. */
+struct DigitalPayoff {
+    static constexpr bool PATH_DEPENDENT = false;
+    static constexpr bool PATHWISE_GREEKS = false;  // discontinuous: the pathwise derivative is 0
+    using State = TerminalObserver;
+
+    OptionType type;
+    double strike;
+    double amount{1.0};
+
+    void start(State& state, double spot) const { state.start(spot); }
+    void observe(State& state, double price) const { state.observe(price); }
+    double payoff(const State& state) const {
+        return (type == CALL ? state.last > strike : state.last < strike) ? amount : 0.0;
+    }
+};
+
+/** Fixed-strike arithmetic-average (Asian) option, averaging every step. */
+struct AsianPayoff {
+    static constexpr bool PATH_DEPENDENT = true;
+    static constexpr bool PATHWISE_GREEKS = false;
+    using State = AverageObserver;
+
+    OptionType type;
+    double strike;
+
+    void start(State& state, double spot) const { state.start(spot); }
+    void observe(State& state, double price) const { state.observe(price); }
+    double payoff(const State& state) const {
+        const double average = state.average();
+        return type == CALL ? std::max(average - strike, 0.0) : std::max(strike - average, 0.0);
+    }
+};
+
+enum BarrierType {
+    BARRIER_UP_AND_OUT,
+    BARRIER_DOWN_AND_OUT,
+    BARRIER_UP_AND_IN,
+    BARRIER_DOWN_AND_IN
+};
+
+/**
+ * Vanilla that is knocked in or out by the barrier, monitored at every step (discrete
+ * monitoring, so prices sit slightly above continuous-barrier formulas for knock-outs).
+ * A knocked-out option, or a knock-in never activated, pays rebate at expiry.
+ */
+struct BarrierPayoff {
+    static constexpr bool PATH_DEPENDENT = true;
+    static constexpr bool PATHWISE_GREEKS = false;
+    struct State {
+        TerminalObserver terminal;
+        BarrierObserver barrier;
+    };
+
+    OptionType type;
+    double strike;
+    double barrier;
+    BarrierType barrier_type;
+    double rebate{0.0};
+
+    bool up() const { return barrier_type == BARRIER_UP_AND_OUT || barrier_type == BARRIER_UP_AND_IN; }
+    bool knockIn() const { return barrier_type == BARRIER_UP_AND_IN || barrier_type == BARRIER_DOWN_AND_IN; }
+    void start(State& state, double spot) const {
+        state.terminal.start(spot);
+        state.barrier.start(spot, barrier, up());
+    }
+    void observe(State& state, double price) const {
+        state.terminal.observe(price);
+        state.barrier.observe(price, barrier, up());
+    }
+    double payoff(const State& state) const {
+        const bool alive = knockIn() ? state.barrier.hit : !state.barrier.hit;
+        if (!alive) return rebate;
+        const double s = state.terminal.last;
+        return type == CALL ? std::max(s - strike, 0.0) : std::max(strike - s, 0.0);
+    }
+};
+
+/**
+ * Lookback on the step extremes. Floating strike: call S_T - min, put max - S_T. Fixed
+ * strike: call max(max - K, 0), put max(K - min, 0).
+ */
+struct LookbackPayoff {
+    static constexpr bool PATH_DEPENDENT = true;
+    static constexpr bool PATHWISE_GREEKS = false;
+    struct State {
+        TerminalObserver terminal;
+        ExtremaObserver extrema;
+    };
+
+    OptionType type;
+    bool floating_strike{true};
+    double strike{0.0};  // fixed strike only
+
+    void start(State& state, double spot) const {
+        state.terminal.start(spot);
+        state.extrema.start(spot);
+    }
+    void observe(State& state, double price) const {
+        state.terminal.observe(price);
+        state.extrema.observe(price);
+    }
+    double payoff(const State& state) const {
+        if (floating_strike) {
+            return type == CALL ? state.terminal.last - state.extrema.minimum
+                                : state.extrema.maximum - state.terminal.last;
+        }
+        return type == CALL ? std::max(state.extrema.maximum - strike, 0.0)
+                            : std::max(strike - state.extrema.minimum, 0.0);
+    }
+};
+
+/** Per-leg estimates plus the weighted total, all from the same paths. */
+struct MonteCarloPortfolioResult {
+    MonteCarloResult total;              // sum of weight * leg (+ any deterministic stock value)
+    std::vector<MonteCarloResult> legs;  // undiscounted weights: one unit of each payoff
+};
+
+/**
+ * Price and Greeks from one run. greeks holds delta, gamma and vega in BlackScholesGreeks units
+ * (vega per 1% vol); theta and rho are left 0. std_error holds their standard errors.
+ */
+struct MonteCarloGreeksResult {
+    MonteCarloResult price;
+    OptionGreeks greeks;
+    OptionGreeks std_error;
+};
+
+/**
+ * Prices any number of payoffs on one set of simulated GBM paths: every payoff's inline
+ * start/observe/payoff runs over each chunk from MonteCarloOptionPricer::simulatePathChunks,
+ * so adding a leg costs its payoff arithmetic, not another simulation. Honours seed, generator,
+ * antithetic and moment matching, target_std_error (the largest error among the outputs must
+ * meet it) and cancel; VR_CONTROL_VARIATE is ignored (no generic control). Results are the same
+ * for a given seed whatever the thread count.
+ */
+class MonteCarloPayoffPricer {
+public:
+    /** One result per payoff, in argument order. */
+    template <typename... Payoffs>
+    static std::array<MonteCarloResult, sizeof...(Payoffs)> price(
+        double spot_price, double risk_free_rate, double volatility, double time_to_expiry,
+        const MonteCarloConfig& config, const Payoffs&... payoffs
+    );
+
+    /** Legs of one payoff type with weights (e.g. signed quantities); total is their weighted sum. */
+    template <typename Payoff>
+    static MonteCarloPortfolioResult pricePortfolio(
+        double spot_price, double risk_free_rate, double volatility, double time_to_expiry,
+        const MonteCarloConfig& config, const std::vector<Payoff>& legs, const std::vector<double>& weights
+    );
+
+    /**
+     * Price, delta, gamma and vega of payoff from the same paths, with no bumped reruns.
+     * PATHWISE_GREEKS payoffs (vanillas) use pathwise delta and vega and the mixed
+     * likelihood-ratio/pathwise gamma. Others use likelihood-ratio weights on the path's normals:
+     * delta and gamma through the first step's draw, so their variance grows with the step
+     * count (use VR_ANTITHETIC, or more paths, for barriers). target_std_error applies to the
+     * price only.
+     */
+    template <typename Payoff>
+    static MonteCarloGreeksResult priceWithGreeks(
+        double spot_price, double risk_free_rate, double volatility, double time_to_expiry,
+        const MonteCarloConfig& config, const Payoff& payoff
+    );
+
+    /**
+     * Every leg of strategy as a vanilla on the same paths, weighted by its signed quantity
+     * times OptionStrategy::CONTRACT_MULTIPLIER; the stock position adds shares * spot to the
+     * total. Legs must share one expiry (std::invalid_argument otherwise).
+     */
+    static MonteCarloPortfolioResult priceStrategy(
+        const OptionStrategy& strategy, double spot_price, double risk_free_rate, double volatility,
+        const MonteCarloConfig& config
+    );
+
+private:
+    // Welford moments, merged in chunk order
+    struct Moments {
+        double count{0.0};
+        double mean{0.0};
+        double m2{0.0};
+
+        void add(double y) {
+            count += 1.0;
+            const double delta = y - mean;
+            mean += delta / count;
+            m2 += delta * (y - mean);
+        }
+        void merge(const Moments& other) {
+            if (other.count == 0.0) return;
+            if (count == 0.0) {
+                *this = other;
+                return;
+            }
+            const double n = count + other.count;
+            const double delta = other.mean - mean;
+            m2 += other.m2 + delta * delta * count * other.count / n;
+            mean += delta * other.count / n;
+            count = n;
+        }
+    };
+
+    // Per-path discounted samples of one output: antithetic pairs are averaged into one sample
+    static void addSamples(const MonteCarloPathChunk& chunk, const double* samples, Moments& out) {
+        const int draws = chunk.antithetic ? chunk.num_paths / 2 : chunk.num_paths;
+        for (int i = 0; i < draws; ++i) {
+            out.add(chunk.antithetic ? 0.5 * (samples[i] + samples[draws + i]) : samples[i]);
+        }
+    }
+
+    // Runs state through every step of the chunk and writes discount * payoff per path
+    template <typename Payoff>
+    static void scorePayoff(const Payoff& payoff, const MonteCarloPathChunk& chunk, double discount,
+                            std::vector<typename Payoff::State>& states, double* samples) {
+        const std::size_t n = static_cast<std::size_t>(chunk.num_paths);
+        states.resize(n);
+        for (std::size_t k = 0; k < n; ++k) payoff.start(states[k], chunk.prices[k]);
+        for (int t = 1; t <= chunk.steps; ++t) {
+            const double* slice = chunk.prices + static_cast<std::size_t>(t) * n;
+            for (std::size_t k = 0; k < n; ++k) payoff.observe(states[k], slice[k]);
+        }
+        for (std::size_t k = 0; k < n; ++k) samples[k] = discount * payoff.payoff(states[k]);
+    }
+
+    static int stepsFor(bool path_dependent, double time_to_expiry, const MonteCarloConfig& config) {
+        if (path_dependent && config.sampling == SAMPLING_TERMINAL) {
+            throw std::invalid_argument("MonteCarloPayoffPricer: path-dependent payoffs need stepped sampling");
+        }
+        return path_dependent || config.sampling == SAMPLING_STEPPED
+            ? MonteCarloOptionPricer::steppedStepCount(time_to_expiry)
+            : 1;
+    }
+
+    static MonteCarloResult finish(const Moments& moments, const MonteCarloConfig& config) {
+        MonteCarloResult result;
+        const bool antithetic = (config.variance_reduction & VR_ANTITHETIC) != 0;
+        result.num_paths = static_cast<long long>(moments.count) * (antithetic ? 2 : 1);
+        result.price = moments.mean;
+        if (moments.count >= 2.0) result.std_error = std::sqrt(moments.m2 / (moments.count - 1.0) / moments.count);
+        return result;
+    }
+
+    /**
+     * Wave loop shared by the entry points: score_chunk(chunk, Moments* out) fills `outputs`
+     * moments for one chunk. Mirrors the vanilla pricer's target_std_error waves, which wait for
+     * the first target_outputs outputs.
+     */
+    template <typename ScoreChunk>
+    static std::vector<MonteCarloResult> run(
+        double spot_price, double risk_free_rate, double volatility, double time_to_expiry, int steps,
+        std::size_t outputs, std::size_t target_outputs, const MonteCarloConfig& config,
+        const ScoreChunk& score_chunk
+    ) {
+        const int chunk_size = MonteCarloOptionPricer::CHUNK_SIMULATIONS;
+        const bool antithetic = (config.variance_reduction & VR_ANTITHETIC) != 0;
+        auto round_paths = [antithetic](long long n) { return antithetic ? n + (n & 1) : n; };
+        auto cancelled = [&config] { return config.cancel && config.cancel->load(std::memory_order_relaxed); };
+        const long long cap = round_paths(std::max(config.max_simulations, config.num_simulations));
+        long long planned = round_paths(std::max(1, config.num_simulations));
+        long long simulated = 0;
+        std::size_t first_chunk = 0;
+        std::vector<Moments> total(outputs);
+
+        for (;;) {
+            const long long wave = planned - simulated;
+            const std::size_t num_chunks = static_cast<std::size_t>((wave + chunk_size - 1) / chunk_size);
+            std::vector<Moments> chunk_moments(num_chunks * outputs);
+            MonteCarloOptionPricer::simulatePathChunks(
+                spot_price, risk_free_rate, volatility, time_to_expiry, steps, simulated, wave, first_chunk, config,
+                [&](const MonteCarloPathChunk& chunk) { score_chunk(chunk, &chunk_moments[chunk.index * outputs]); });
+            for (std::size_t j = 0; j < num_chunks; ++j) {
+                for (std::size_t o = 0; o < outputs; ++o) total[o].merge(chunk_moments[j * outputs + o]);
+            }
+            simulated = planned;
+            first_chunk += num_chunks;
+
+            std::vector<MonteCarloResult> results;
+            double std_error = 0.0;
+            for (std::size_t o = 0; o < outputs; ++o) {
+                results.push_back(finish(total[o], config));
+                if (o < target_outputs) std_error = std::max(std_error, results.back().std_error);
+            }
+            if (cancelled()) {
+                for (MonteCarloResult& result : results) result.cancelled = true;
+                return results;
+            }
+            if (config.target_std_error <= 0.0 || std_error <= config.target_std_error || simulated >= cap) {
+                return results;
+            }
+            const double ratio = std_error / config.target_std_error;
+            const double needed = 1.1 * static_cast<double>(simulated) * ratio * ratio;
+            const long long next = std::max(simulated + chunk_size,
+                                            static_cast<long long>(std::min(needed, static_cast<double>(cap))));
+            planned = std::min(round_paths(next), cap);
+        }
+    }
+
+    template <typename Tuple, std::size_t... I>
+    static void scoreAll(const Tuple& payoffs, const MonteCarloPathChunk& chunk, double discount,
+                         std::vector<double>& samples, Moments* moments, std::index_sequence<I...>) {
+        auto score_one = [&](const auto& payoff, std::size_t index) {
+            std::vector<typename std::decay_t<decltype(payoff)>::State> states;
+            scorePayoff(payoff, chunk, discount, states, samples.data());
+            addSamples(chunk, samples.data(), moments[index]);
+        };
+        (score_one(std::get<I>(payoffs), I), ...);
+    }
+};
+
+template <typename... Payoffs>
+std::array<MonteCarloResult, sizeof...(Payoffs)> MonteCarloPayoffPricer::price(
+    double spot_price, double risk_free_rate, double volatility, double time_to_expiry,
+    const MonteCarloConfig& config, const Payoffs&... payoffs
+) {
+    static_assert(sizeof...(Payoffs) > 0, "price() needs at least one payoff");
+    const int steps = stepsFor((Payoffs::PATH_DEPENDENT || ...), time_to_expiry, config);
+    const double discount = std::exp(-risk_free_rate * time_to_expiry);
+    const auto tuple = std::tie(payoffs...);
+    const std::vector<MonteCarloResult> results = run(
+        spot_price, risk_free_rate, volatility, time_to_expiry, steps, sizeof...(Payoffs), sizeof...(Payoffs), config,
+        [&](const MonteCarloPathChunk& chunk, Moments* out) {
+            std::vector<double> samples(static_cast<std::size_t>(chunk.num_paths));
+            scoreAll(tuple, chunk, discount, samples, out, std::index_sequence_for<Payoffs...>{});
+        });
+    std::array<MonteCarloResult, sizeof...(Payoffs)> out;
+    std::copy(results.begin(), results.end(), out.begin());
+    return out;
+}
+
+template <typename Payoff>
+MonteCarloPortfolioResult MonteCarloPayoffPricer::pricePortfolio(
+    double spot_price, double risk_free_rate, double volatility, double time_to_expiry,
+    const MonteCarloConfig& config, const std::vector<Payoff>& legs, const std::vector<double>& weights
+) {
+    if (legs.empty() || weights.size() != legs.size()) {
+        throw std::invalid_argument("MonteCarloPayoffPricer: need one weight per leg");
+    }
+    const int steps = stepsFor(Payoff::PATH_DEPENDENT, time_to_expiry, config);
+    const double discount = std::exp(-risk_free_rate * time_to_expiry);
+    const std::size_t n_legs = legs.size();
+    std::vector<MonteCarloResult> results = run(
+        spot_price, risk_free_rate, volatility, time_to_expiry, steps, n_legs + 1, n_legs + 1, config,
+        [&](const MonteCarloPathChunk& chunk, Moments* out) {
+            const std::size_t n = static_cast<std::size_t>(chunk.num_paths);
+            std::vector<typename Payoff::State> states;
+            std::vector<double> samples(n), total(n, 0.0);
+            for (std::size_t leg = 0; leg < n_legs; ++leg) {
+                scorePayoff(legs[leg], chunk, discount, states, samples.data());
+                addSamples(chunk, samples.data(), out[leg]);
+                for (std::size_t k = 0; k < n; ++k) total[k] += weights[leg] * samples[k];
+            }
+            addSamples(chunk, total.data(), out[n_legs]);
+        });
+    MonteCarloPortfolioResult portfolio;
+    portfolio.total = results.back();
+    results.pop_back();
+    portfolio.legs = std::move(results);
+    return portfolio;
+}
+
+template <typename Payoff>
+MonteCarloGreeksResult MonteCarloPayoffPricer::priceWithGreeks(
+    double spot_price, double risk_free_rate, double volatility, double time_to_expiry,
+    const MonteCarloConfig& config, const Payoff& payoff
+) {
+    enum { OUT_PRICE, OUT_DELTA, OUT_GAMMA, OUT_VEGA, OUT_COUNT };
+    const int steps = stepsFor(Payoff::PATH_DEPENDENT, time_to_expiry, config);
+    const double S0 = spot_price;
+    const double r = risk_free_rate;
+    const double sigma = volatility;
+    const double T = time_to_expiry;
+    const double discount = std::exp(-r * T);
+    const double dt = T / steps;
+    const double sigma_sqrt_dt = sigma * std::sqrt(dt);
+    const double sigma_sqrt_T = sigma * std::sqrt(T);
+    // sigma or T ~ 0: no diffusion to differentiate, Greeks stay 0
+    const bool degenerate = !(sigma_sqrt_dt > 1e-12);
+
+    const std::vector<MonteCarloResult> results = run(
+        S0, r, sigma, T, steps, OUT_COUNT, 1, config,
+        [&](const MonteCarloPathChunk& chunk, Moments* out) {
+            const std::size_t n = static_cast<std::size_t>(chunk.num_paths);
+            std::vector<typename Payoff::State> states;
+            std::vector<double> price(n), delta(n, 0.0), gamma(n, 0.0), vega(n, 0.0);
+            scorePayoff(payoff, chunk, discount, states, price.data());
+            if (!degenerate) {
+                if constexpr (Payoff::PATHWISE_GREEKS) {
+                    // d S_T / d S0 = S_T / S0, d S_T / d sigma = S_T (ln(S_T / S0) - (r + sigma^2/2) T) / sigma
+                    const double* terminal = chunk.prices + static_cast<std::size_t>(chunk.steps) * n;
+                    const double strike = payoff.strike;
+                    const double sign = payoff.type == CALL ? 1.0 : -1.0;
+                    for (std::size_t k = 0; k < n; ++k) {
+                        const double S_T = terminal[k];
+                        const bool in_the_money = payoff.type == CALL ? S_T > strike : S_T < strike;
+                        const double weight = in_the_money ? sign * discount : 0.0;
+                        const double log_return = std::log(S_T / S0);
+                        const double z = (log_return - (r - 0.5 * sigma * sigma) * T) / sigma_sqrt_T;
+                        delta[k] = weight * S_T / S0;
+                        vega[k] = weight * S_T * (log_return - (r + 0.5 * sigma * sigma) * T) / sigma;
+                        gamma[k] = weight * strike * z / (S0 * S0 * sigma_sqrt_T);
+                    }
+                } else {
+                    // Score functions of the GBM transition densities
+                    const double sqrt_dt = std::sqrt(dt);
+                    for (std::size_t k = 0; k < n; ++k) {
+                        const double z1 = chunk.normals[k];
+                        double vega_score = 0.0;
+                        for (int t = 0; t < chunk.steps; ++t) {
+                            const double z = chunk.normals[static_cast<std::size_t>(t) * n + k];
+                            vega_score += (z * z - 1.0) / sigma - z * sqrt_dt;
+                        }
+                        delta[k] = price[k] * z1 / (S0 * sigma_sqrt_dt);
+                        gamma[k] = price[k] * (z1 * z1 - 1.0 - z1 * sigma_sqrt_dt) / (S0 * S0 * sigma_sqrt_dt * sigma_sqrt_dt);
+                        vega[k] = price[k] * vega_score;
+                    }
+                }
+            }
+            addSamples(chunk, price.data(), out[OUT_PRICE]);
+            addSamples(chunk, delta.data(), out[OUT_DELTA]);
+            addSamples(chunk, gamma.data(), out[OUT_GAMMA]);
+            addSamples(chunk, vega.data(), out[OUT_VEGA]);
+        });
+
+    MonteCarloGreeksResult result;
+    result.price = results[OUT_PRICE];
+    result.greeks.delta = results[OUT_DELTA].price;
+    result.greeks.gamma = results[OUT_GAMMA].price;
+    result.greeks.vega = results[OUT_VEGA].price / 100.0;
+    result.std_error.delta = results[OUT_DELTA].std_error;
+    result.std_error.gamma = results[OUT_GAMMA].std_error;
+    result.std_error.vega = results[OUT_VEGA].std_error / 100.0;
+    return result;
+}
+
+inline MonteCarloPortfolioResult MonteCarloPayoffPricer::priceStrategy(
+    const OptionStrategy& strategy, double spot_price, double risk_free_rate, double volatility,
+    const MonteCarloConfig& config
+) {
+    const std::vector<Option>& options = strategy.getOptions();
+    const std::vector<int>& quantities = strategy.getOptionQuantities();
+    if (options.empty()) throw std::invalid_argument("MonteCarloPayoffPricer: strategy has no option legs");
+    std::vector<VanillaPayoff> legs;
+    std::vector<double> weights;
+    for (std::size_t i = 0; i < options.size(); ++i) {
+        if (options[i].getExpirationDate() != options[0].getExpirationDate()) {
+            throw std::invalid_argument("MonteCarloPayoffPricer: strategy legs must share one expiry");
+        }
+        legs.push_back({options[i].getType(), options[i].getStrikePrice()});
+        weights.push_back(static_cast<double>(i < quantities.size() ? quantities[i] : 1) *
+                          OptionStrategy::CONTRACT_MULTIPLIER);
+    }
+    const double T = std::max(0.0, std::difftime(options[0].getExpirationDate(), std::time(nullptr)) /
+                                       (365.25 * 24 * 60 * 60));
+    MonteCarloPortfolioResult result =
+        pricePortfolio(spot_price, risk_free_rate, volatility, T, config, legs, weights);
+    result.total.price += strategy.getStockPosition() * spot_price;
+    return result;
+}
+
+#endif // MONTE_CARLO_PAYOFFS_H
@@ -9,6 +9,7 @@
 #include "../include/option.h"
 #include "../include/black_scholes.h"
 #include "../include/black_scholes_greeks.h"
+#include "../include/leg_table.h"
 
 // Forward declaration
 class OptionStrategy;
@@ -42,11 +43,17 @@ class OptionStrategy {
 protected:
     std::string symbol;
     std::vector<Option> options;
+    std::vector<int> option_quantities; // Contracts per leg, parallel to options (negative for short)
     int stock_position = 0; // Number of shares (positive for long, negative for short)
     double entry_price = 0.0; // Cost basis for the strategy
+    double risk_free_rate = 0.02; // Pricing inputs the strategy was built with
+    double volatility = 0.3;
     
 public:
-    OptionStrategy(const std::string& symbol) : symbol(symbol) {}
+    static constexpr int CONTRACT_MULTIPLIER = 100; // Shares per option contract
+
+    OptionStrategy(const std::string& symbol, double risk_free_rate = 0.02, double volatility = 0.3)
+        : symbol(symbol), risk_free_rate(risk_free_rate), volatility(volatility) {}
     virtual ~OptionStrategy() = default;
     
     // Calculate the strategy's value at a given underlying price
@@ -67,9 +74,22 @@ public:
     
     // Calculate breakeven points
     virtual std::vector<double> calculateBreakevens() const = 0;
+
+    /**
+     * Value, P&L (value - entry price) and delta at each of count underlying prices, at the
+     * strategy's own rate and volatility. All legs and prices go through one
+     * BlackScholesGreeks::calculateAllBatch pass; legs sharing a strike share its lanes, since
+     * the kernel returns the call and the put together. Outputs may be nullptr.
+     * time_to_expiry 0 gives the payoff at expiry. Non-positive prices give NaN.
+     */
+    void calculateCurve(const double* underlying_prices, std::size_t count, double time_to_expiry,
+                        double* value, double* profit_loss, double* delta) const;
     
     // Get all options in the strategy
     const std::vector<Option>& getOptions() const { return options; }
+
+    // Get signed contract counts, one per option
+    const std::vector<int>& getOptionQuantities() const { return option_quantities; }
     
     // Get stock position
     int getStockPosition() const { return stock_position; }
@@ -79,10 +99,15 @@ public:
 
     // Get entry price
     double getEntryPrice() const { return entry_price; }
+
+    // Get the rate and volatility used for pricing
+    double getRiskFreeRate() const { return risk_free_rate; }
+    double getVolatility() const { return volatility; }
     
-    // Add option to the strategy
-    void addOption(const Option& option) {
+    // Add option to the strategy (quantity in contracts, negative for a short leg)
+    void addOption(const Option& option, int quantity = 1) {
         options.push_back(option);
+        option_quantities.push_back(quantity);
     }
     
     // Set stock position
@@ -110,7 +135,7 @@ public:
         double volatility,
         double risk_free_rate,
         std::time_t expiry
-    ) : OptionStrategy(symbol), entry_stock_price(current_price) {
+    ) : OptionStrategy(symbol, risk_free_rate, volatility), entry_stock_price(current_price) {
         // Long 100 shares of stock
         stock_position = 100;
         
@@ -124,7 +149,7 @@ public:
         );
         
         call_option.setCurrentPrice(call_premium);
-        addOption(call_option);
+        addOption(call_option, -1);
         
         // Set the entry price (cost basis minus premium received)
         entry_price = entry_stock_price * 100 - call_premium * 100;
@@ -139,7 +164,7 @@ public:
         for (const auto& option : options) {
             if (option.getType() == CALL) {
                 double call_price = BlackScholes::calculateCallPrice(
-                    underlying_price, option.getStrikePrice(), 0.02, 0.3, time_to_expiry
+                    underlying_price, option.getStrikePrice(), risk_free_rate, volatility, time_to_expiry
                 );
                 option_value -= call_price * 100; // 100 shares per contract
             }
@@ -217,7 +242,7 @@ public:
         double volatility,
         double risk_free_rate,
         std::time_t expiry
-    ) : OptionStrategy(symbol), entry_stock_price(current_price) {
+    ) : OptionStrategy(symbol, risk_free_rate, volatility), entry_stock_price(current_price) {
         // Long 100 shares of stock
         stock_position = 100;
         
@@ -245,7 +270,7 @@ public:
         for (const auto& option : options) {
             if (option.getType() == PUT) {
                 double put_price = BlackScholes::calculatePutPrice(
-                    underlying_price, option.getStrikePrice(), 0.02, 0.3, time_to_expiry
+                    underlying_price, option.getStrikePrice(), risk_free_rate, volatility, time_to_expiry
                 );
                 option_value += put_price * 100; // 100 shares per contract
             }
@@ -328,7 +353,7 @@ public:
         double volatility,
         double risk_free_rate,
         std::time_t expiry
-    ) : OptionStrategy(symbol), long_call_strike(long_strike), short_call_strike(short_strike) {
+    ) : OptionStrategy(symbol, risk_free_rate, volatility), long_call_strike(long_strike), short_call_strike(short_strike) {
         if (long_strike >= short_strike) {
             throw std::invalid_argument("Long call strike must be lower than short call strike for a bull call spread");
         }
@@ -350,7 +375,7 @@ public:
             current_price, short_strike, risk_free_rate, volatility, time_to_expiry
         );
         short_call.setCurrentPrice(short_call_premium);
-        addOption(short_call);
+        addOption(short_call, -1);
         
         // Set the entry price (net debit)
         entry_price = (long_call_premium - short_call_premium) * 100;
@@ -361,12 +386,12 @@ public:
         
         // Long call value
         double long_call_value = BlackScholes::calculateCallPrice(
-            underlying_price, long_call_strike, 0.02, 0.3, time_to_expiry
+            underlying_price, long_call_strike, risk_free_rate, volatility, time_to_expiry
         );
         
         // Short call value
         double short_call_value = BlackScholes::calculateCallPrice(
-            underlying_price, short_call_strike, 0.02, 0.3, time_to_expiry
+            underlying_price, short_call_strike, risk_free_rate, volatility, time_to_expiry
         );
         
         // Total value = long call value - short call value
@@ -433,7 +458,7 @@ public:
         double volatility,
         double risk_free_rate,
         std::time_t expiry
-    ) : OptionStrategy(symbol), long_put_strike(long_strike), short_put_strike(short_strike) {
+    ) : OptionStrategy(symbol, risk_free_rate, volatility), long_put_strike(long_strike), short_put_strike(short_strike) {
         if (long_strike <= short_strike) {
             throw std::invalid_argument("Long put strike must be higher than short put strike for a bear put spread");
         }
@@ -455,7 +480,7 @@ public:
             current_price, short_strike, risk_free_rate, volatility, time_to_expiry
         );
         short_put.setCurrentPrice(short_put_premium);
-        addOption(short_put);
+        addOption(short_put, -1);
         
         // Set the entry price (net debit)
         entry_price = (long_put_premium - short_put_premium) * 100;
@@ -466,12 +491,12 @@ public:
         
         // Long put value
         double long_put_value = BlackScholes::calculatePutPrice(
-            underlying_price, long_put_strike, 0.02, 0.3, time_to_expiry
+            underlying_price, long_put_strike, risk_free_rate, volatility, time_to_expiry
         );
         
         // Short put value
         double short_put_value = BlackScholes::calculatePutPrice(
-            underlying_price, short_put_strike, 0.02, 0.3, time_to_expiry
+            underlying_price, short_put_strike, risk_free_rate, volatility, time_to_expiry
         );
         
         // Total value = long put value - short put value
@@ -536,7 +561,7 @@ public:
         double volatility,
         double risk_free_rate,
         std::time_t expiry
-    ) : OptionStrategy(symbol), strike_price(strike) {
+    ) : OptionStrategy(symbol, risk_free_rate, volatility), strike_price(strike) {
         // Calculate time to expiry
         double time_to_expiry = difftime(expiry, std::time(nullptr)) / (60 * 60 * 24 * 365); // Convert to years
         
@@ -565,12 +590,12 @@ public:
         
         // Call value
         double call_value = BlackScholes::calculateCallPrice(
-            underlying_price, strike_price, 0.02, 0.3, time_to_expiry
+            underlying_price, strike_price, risk_free_rate, volatility, time_to_expiry
         );
         
         // Put value
         double put_value = BlackScholes::calculatePutPrice(
-            underlying_price, strike_price, 0.02, 0.3, time_to_expiry
+            underlying_price, strike_price, risk_free_rate, volatility, time_to_expiry
         );
         
         // Total value = call value + put value
@@ -627,6 +652,126 @@ public:
     }
 };
 
+// Any combination of legs; max profit/loss and breakevens are found numerically through a LegTable
+class MultiLegStrategy : public OptionStrategy {
+public:
+    MultiLegStrategy(
+        const std::string& symbol,
+        double current_price,
+        double volatility,
+        double risk_free_rate,
+        int shares = 0
+    ) : OptionStrategy(symbol, risk_free_rate, volatility), entry_stock_price(current_price) {
+        stock_position = shares;
+        entry_price = shares * current_price;
+    }
+
+    // Add a leg priced at the entry price (quantity in contracts, negative for a short leg)
+    void addLeg(OptionType type, double strike, std::time_t expiry, int quantity) {
+        double time_to_expiry = difftime(expiry, std::time(nullptr)) / (60 * 60 * 24 * 365); // Convert to years
+        double premium = type == CALL
+            ? BlackScholes::calculateCallPrice(entry_stock_price, strike, risk_free_rate, volatility, time_to_expiry)
+            : BlackScholes::calculatePutPrice(entry_stock_price, strike, risk_free_rate, volatility, time_to_expiry);
+        Option option(symbol, type, strike, expiry);
+        option.setCurrentPrice(premium);
+        addOption(option, quantity);
+        entry_price += quantity * premium * CONTRACT_MULTIPLIER;
+    }
+
+    double calculateValue(double underlying_price, double time_to_expiry) const override {
+        double value = 0.0;
+        calculateCurve(&underlying_price, 1, time_to_expiry, &value, nullptr, nullptr);
+        return value;
+    }
+
+    double calculateDelta(double underlying_price, double time_to_expiry,
+                       double risk_free_rate, double volatility) const override {
+        double delta = stock_position;
+        for (std::size_t i = 0; i < options.size(); ++i) {
+            OptionValuation valuation = BlackScholesGreeks::calculateAll<OUTPUT_DELTA>(
+                underlying_price, options[i].getStrikePrice(), risk_free_rate, volatility, time_to_expiry
+            );
+            double leg_delta = options[i].getType() == CALL ? valuation.call_greeks.delta : valuation.put_greeks.delta;
+            delta += leg_delta * option_quantities[i] * CONTRACT_MULTIPLIER;
+        }
+        return delta;
+    }
+
+    double calculateMaxProfit() const override { return metrics().max_profit; }
+
+    double calculateMaxLoss() const override { return metrics().max_loss; }
+
+    std::vector<double> calculateBreakevens() const override { return metrics().breakevens; }
+
+    double calculateProfitLoss(double stockPrice) const override {
+        double profit_loss = 0.0;
+        calculateCurve(&stockPrice, 1, 0.0, nullptr, &profit_loss, nullptr);
+        return profit_loss;
+    }
+
+private:
+    double entry_stock_price;
+
+    StrategyMetrics metrics() const {
+        LegPricingConfig config;
+        config.risk_free_rate = risk_free_rate;
+        config.volatility = volatility;
+        return LegTable::fromStrategy(*this).metrics(0, config);
+    }
+};
+
+inline void OptionStrategy::calculateCurve(const double* underlying_prices, std::size_t count,
+                                           double time_to_expiry, double* value, double* profit_loss,
+                                           double* delta) const {
+    // Distinct strikes with the net call and put shares held at each
+    std::vector<double> strikes, call_shares, put_shares;
+    for (std::size_t leg = 0; leg < options.size(); ++leg) {
+        const double strike = options[leg].getStrikePrice();
+        const double shares = (leg < option_quantities.size() ? option_quantities[leg] : 1) * CONTRACT_MULTIPLIER;
+        std::size_t j = std::find(strikes.begin(), strikes.end(), strike) - strikes.begin();
+        if (j == strikes.size()) {
+            strikes.push_back(strike);
+            call_shares.push_back(0.0);
+            put_shares.push_back(0.0);
+        }
+        (options[leg].getType() == CALL ? call_shares : put_shares)[j] += shares;
+    }
+
+    // Lane j * count + i prices strike j at underlying_prices[i]
+    const std::size_t lanes = strikes.size() * count;
+    std::vector<double> spot(lanes), strike(lanes), rate(lanes, risk_free_rate), vol(lanes, volatility);
+    std::vector<double> expiry(lanes, time_to_expiry);
+    std::vector<double> call_price(lanes), put_price(lanes), call_delta(lanes), put_delta(lanes);
+    for (std::size_t j = 0; j < strikes.size(); ++j) {
+        std::copy(underlying_prices, underlying_prices + count, spot.begin() + j * count);
+        std::fill(strike.begin() + j * count, strike.begin() + (j + 1) * count, strikes[j]);
+    }
+    const OptionChainView chain{spot.data(), strike.data(), rate.data(), vol.data(), expiry.data(), nullptr, lanes};
+    GreeksBatchOutput out;
+    out.call_price = call_price.data();
+    out.put_price = put_price.data();
+    out.call_delta = call_delta.data();
+    out.put_delta = put_delta.data();
+    BlackScholesGreeks::calculateAllBatch<OUTPUT_PRICE | OUTPUT_DELTA>(chain, out, nullptr);
+
+    std::vector<double> total(count), total_delta(count, static_cast<double>(stock_position));
+    for (std::size_t i = 0; i < count; ++i) total[i] = stock_position * underlying_prices[i];
+    for (std::size_t j = 0; j < strikes.size(); ++j) {
+        const double calls = call_shares[j];
+        const double puts = put_shares[j];
+        const std::size_t lane = j * count;
+        for (std::size_t i = 0; i < count; ++i) {
+            total[i] += calls * call_price[lane + i] + puts * put_price[lane + i];
+            total_delta[i] += calls * call_delta[lane + i] + puts * put_delta[lane + i];
+        }
+    }
+    if (value) std::copy(total.begin(), total.end(), value);
+    if (profit_loss) {
+        for (std::size_t i = 0; i < count; ++i) profit_loss[i] = total[i] - entry_price;
+    }
+    if (delta) std::copy(total_delta.begin(), total_delta.end(), delta);
+}
+
 // Implementation of the factory method (inline to avoid duplicate symbols when header is included in multiple TUs)
 inline std::unique_ptr<OptionStrategy> OptionStrategyFactory::createStrategy(
     StrategyType type,
@@ -663,8 +808,31 @@ inline std::unique_ptr<OptionStrategy> OptionStrategyFactory::createStrategy(
             return std::make_unique<StraddleStrategy>(
                 symbol, current_price, current_price, volatility, risk_free_rate, expiry
             );
-            
-            
+
+        case STRANGLE: {
+            auto strangle = std::make_unique<MultiLegStrategy>(symbol, current_price, volatility, risk_free_rate);
+            strangle->addLeg(PUT, current_price * 0.95, expiry, 1);
+            strangle->addLeg(CALL, current_price * 1.05, expiry, 1);
+            return strangle;
+        }
+
+        case IRON_CONDOR: {
+            auto condor = std::make_unique<MultiLegStrategy>(symbol, current_price, volatility, risk_free_rate);
+            condor->addLeg(PUT, current_price * 0.90, expiry, 1);
+            condor->addLeg(PUT, current_price * 0.95, expiry, -1);
+            condor->addLeg(CALL, current_price * 1.05, expiry, -1);
+            condor->addLeg(CALL, current_price * 1.10, expiry, 1);
+            return condor;
+        }
+
+        case BUTTERFLY: {
+            auto butterfly = std::make_unique<MultiLegStrategy>(symbol, current_price, volatility, risk_free_rate);
+            butterfly->addLeg(CALL, current_price * 0.95, expiry, 1);
+            butterfly->addLeg(CALL, current_price, expiry, -2);
+            butterfly->addLeg(CALL, current_price * 1.05, expiry, 1);
+            return butterfly;
+        }
+
         default:
             throw std::invalid_argument("Strategy type not implemented");
     }
@@ -11,8 +11,13 @@
 #include <QTableWidget>
 #include <QChart>
 #include <QChartView>
+#include <QProgressBar>
+#include <QPushButton>
+#include <QThread>
+#include <atomic>
 
 #include "option_strategy.h"
+#include "monte_carlo.h"
 
 QT_BEGIN_NAMESPACE
 namespace QtCharts {
@@ -25,12 +30,14 @@ class OptionsCalculatorGUI : public QMainWindow {
 
 public:
     OptionsCalculatorGUI(QWidget *parent = nullptr);
+    ~OptionsCalculatorGUI();
 
 private slots:
     void calculateOptionPrices();
     void analyzeStrategy();
     void calculateHistoricalVolatility();
     void runMonteCarloSimulation();
+    void cancelMonteCarloSimulation();
 
 private:
     // Your private member declarations here (same as in your cpp file)
@@ -84,6 +91,12 @@ private:
     QLabel *bsCallPriceOutput;
     QLabel *bsPutPriceOutput;
     QtCharts::QChartView *mcChartView;
+    QPushButton *mcRunButton;
+    QPushButton *mcCancelButton;
+    QProgressBar *mcProgressBar;
+    QLabel *mcStatusLabel;  // wall time, throughput and chunk latency of the last run
+    QThread *mcWorker = nullptr;                 // background run in progress, if any
+    std::atomic<bool> mcCancelRequested{false};
     
     void createOptionCalculatorTab(QTabWidget *tabWidget);
     void createStrategyAnalyzerTab(QTabWidget *tabWidget);
@@ -92,6 +105,9 @@ private:
     void updateStrategyChart(OptionStrategy* strategy, double spotPrice, int daysToExpiry, double riskFreeRate, double volatility);
     void updateVolatilityChart(const std::vector<double>& prices);
     void updateMonteCarloChart(double spotPrice, double riskFreeRate, double volatility, double timeToExpiry);
+    void showMonteCarloResults(const MonteCarloCallPutResult& result, double spotPrice, double riskFreeRate,
+                               double volatility, double timeToExpiry);
+    void showMonteCarloStatus(long long numPaths, qint64 elapsedNs);
     double generateNormalRandom();
 };
 
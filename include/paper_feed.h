@@ -10,11 +10,14 @@ public:
     OptionalDouble getCurrentPrice(const std::string& symbol) const override;
     void setCurrentPrice(const std::string& symbol, double price) override;
     bool fetchHistoricalPrices(const std::string& symbol, const std::string& start_date, const std::string& end_date) override;
-    std::vector<StockPrice> getHistoricalPrices(const std::string& symbol) const override;
+    PriceSeriesView getHistoricalPrices(const std::string& symbol) const override;
+
+    /** Install the series later calls to getHistoricalPrices(symbol) return. */
+    void setHistoricalPrices(const std::string& symbol, PriceSeries series);
 
 private:
     std::unordered_map<std::string, double> current_prices_;
-    std::unordered_map<std::string, std::vector<StockPrice>> historical_prices_;
+    std::unordered_map<std::string, PriceSeries> historical_prices_;
 };
 
 #endif
@@ -3,41 +3,99 @@
 
 #include "option.h"
 #include "market_data.h"
+#include "portfolio_risk.h"
+#include "position_book.h"
+#include "scenario_engine.h"
+#include "vol_surface.h"
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
 #include <vector>
-#include <unordered_map>
 #include <string>
 #include <ctime>
 
-struct OptionPosition {
-    Option option;
-    int quantity;
-    double entry_price;
-    std::time_t entry_time;
-};
-
 class PaperTradingSystem {
+public:
+    /** Source of "now" for entry times, expiry and repricing. */
+    using Clock = std::function<std::time_t()>;
+
 private:
     double cash_balance;
     double initial_balance;
-    std::vector<OptionPosition> open_positions;
-    MarketDataProvider market_data;
+    Clock clock;               // empty: std::time(nullptr)
+    bool console_logging{true};
+    PositionBook positions;  // one row per contract; buying the same contract again adds to it
+
+    // Event-driven repricing: quote changes mark an underlying dirty (from any thread);
+    // repriceDirtyPositions() reprices only those underlyings' rows.
+    std::mutex dirty_mutex;
+    std::vector<SymbolId> dirty_underlyings;
+    std::vector<std::uint8_t> underlying_dirty;  // indexed by SymbolId
+    std::vector<double> batch_strike, batch_vol, batch_expiry, batch_spot, batch_rate, batch_price;
+    std::vector<OptionType> batch_type;
+
+    VolSurfaceSet vol_surfaces;  // indexed by SymbolId
+
+    PortfolioRiskEngine risk_engine;
+    std::vector<double> risk_spots;  // indexed by SymbolId
+
+    const std::vector<double>& currentSpots();
+
+    MarketDataProvider market_data;  // last member: stops its refresher (and listener calls) first
+    std::size_t quote_subscription;
+
+    void markDirty(SymbolId underlying);
 
 public:
     // Constructor with initial balance and API key
     PaperTradingSystem(double initial_balance, const std::string& alpha_vantage_api_key);
+    // Constructor with any data feed (e.g. PaperFeed for offline runs and backtests)
+    PaperTradingSystem(double initial_balance, std::unique_ptr<DataFeedInterface> feed);
+    ~PaperTradingSystem();
+
+    PaperTradingSystem(const PaperTradingSystem&) = delete;
+    PaperTradingSystem& operator=(const PaperTradingSystem&) = delete;
 
-    // Trading operations
-    bool buyOption(const Option& option, int quantity);
+    // Replace the wall clock, e.g. with a backtest's simulated time (empty: back to std::time)
+    void setClock(Clock clock);
+    std::time_t now() const;
+    // Trade and expiry messages on std::cout / std::cerr (on by default)
+    void setConsoleLogging(bool enabled);
+
+    // Trading operations. volatility is the position's own vol for repricing (NaN: default).
+    bool buyOption(const Option& option, int quantity,
+                   double volatility = std::numeric_limits<double>::quiet_NaN());
     bool sellOption(const Option& option, int quantity);
 
-    // Update option fair-value prices from market data (underlying price -> Black-Scholes)
+    // Update option fair-value prices from market data (underlying price -> Black-Scholes), all positions.
+    // volatility applies to positions without their own vol or a fitted surface.
     void updateOptionPricesFromMarket(double risk_free_rate, double volatility);
 
+    // Reprice only positions whose underlying quote changed since the last pass (or whose vol
+    // surface was refit, or that were opened since), one batch per underlying. Positions without
+    // their own volatility use their underlying's vol surface once it is fitted, else
+    // default_volatility. Returns the number of positions repriced.
+    std::size_t repriceDirtyPositions(double risk_free_rate, double default_volatility);
+
+    // Implied vol surface of symbol (created empty on first use): set its quotes, then fitVolSurfaces()
+    VolSurface& volSurface(const std::string& symbol);
+    // Refit the changed expiries of every surface; underlyings with a refit are repriced on the
+    // next pass. Returns the number of expiries refit.
+    std::size_t fitVolSurfaces();
+
     // Expose market data for pushing prices (e.g. setCurrentPrice after API fetch)
     MarketDataProvider& getMarketData();
 
     // Portfolio management
+    const PositionBook& getPositions() const;
     double calculatePortfolioValue() const;
+    // Position-weighted Greeks of the whole book, in total and by underlying and expiry bucket
+    PortfolioRisk calculateRisk(double risk_free_rate, double default_volatility);
+    void printRisk(const PortfolioRisk& risk) const;
+    // Book value over a spot x vol x time shock grid (positions without a quote are left out)
+    ScenarioCube runScenarios(const ScenarioGrid& grid, double risk_free_rate, double default_volatility);
     void closeExpiredPositions();
 
     // Reporting
@@ -0,0 +1,86 @@
+#ifndef PORTFOLIO_RISK_H
+#define PORTFOLIO_RISK_H
+
+#include "position_book.h"
+#include "vol_surface.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <vector>
+
+class TaskExecutor;
+
+/** Time-to-expiry buckets for the risk breakdown; each holds expiries up to its bound. */
+enum ExpiryBucket : std::uint8_t {
+    EXPIRY_WEEK,       // <= 7 days
+    EXPIRY_MONTH,      // <= 30 days
+    EXPIRY_QUARTER,    // <= 90 days
+    EXPIRY_HALF_YEAR,  // <= 180 days
+    EXPIRY_YEAR,       // <= 365 days
+    EXPIRY_LONG,       // beyond a year
+    EXPIRY_BUCKET_COUNT
+};
+
+/**
+ * Position-weighted sums: value and each Greek times quantity, in the units of
+ * BlackScholesGreeks (theta per day, vega and rho per 1%).
+ */
+struct RiskTotals {
+    double value{0.0};
+    double delta{0.0};
+    double gamma{0.0};
+    double theta{0.0};
+    double vega{0.0};
+    double rho{0.0};
+    std::size_t positions{0};
+
+    void add(const RiskTotals& other);
+};
+
+struct UnderlyingRisk {
+    SymbolId underlying;
+    RiskTotals total;
+    std::array<RiskTotals, EXPIRY_BUCKET_COUNT> by_expiry;
+};
+
+struct PortfolioRisk {
+    RiskTotals total;
+    std::array<RiskTotals, EXPIRY_BUCKET_COUNT> by_expiry;
+    std::vector<UnderlyingRisk> by_underlying;  // ascending SymbolId, underlyings with priced rows only
+    std::size_t unpriced{0};                    // rows left out: no spot, or inputs the kernel rejects
+};
+
+struct PortfolioRiskConfig {
+    double risk_free_rate{0.05};
+    double default_volatility{0.2};   // for rows without their own volatility or a surface
+    const VolSurfaceSet* vol_surfaces{nullptr};  // by SymbolId, for rows without their own volatility
+    std::time_t now{0};               // valuation time; 0 = std::time(nullptr)
+    TaskExecutor* executor{nullptr};  // nullptr = TaskExecutor::shared()
+};
+
+/**
+ * Net Greeks of a whole PositionBook in one batched, parallel pass.
+ *
+ * Rows are split into contiguous ranges and each range runs through
+ * BlackScholesGreeks::calculateAllBatch in tiles, writing weighted per-row results. The
+ * reduce is then parallel per underlying and sums rows in book order, so the result does not
+ * depend on the thread count. Scratch buffers are kept between calls, so refreshing on every
+ * quote update does not allocate once the book stops growing.
+ */
+class PortfolioRiskEngine {
+public:
+    static ExpiryBucket bucketFor(double time_to_expiry_years);
+    static const char* bucketName(ExpiryBucket bucket);
+
+    /** spot_by_symbol is indexed by SymbolId; rows whose spot is missing, NaN or <= 0 are unpriced. */
+    PortfolioRisk compute(const PositionBook& book, const std::vector<double>& spot_by_symbol,
+                          const PortfolioRiskConfig& config);
+
+private:
+    // Weighted per-row results of the map phase (NaN value: unpriced)
+    std::vector<double> value_, delta_, gamma_, theta_, vega_, rho_;
+    std::vector<std::uint8_t> bucket_;
+};
+
+#endif // PORTFOLIO_RISK_H
@@ -0,0 +1,126 @@
+#ifndef POSITION_BOOK_H
+#define POSITION_BOOK_H
+
+#include "option.h"
+#include "quote_store.h"
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+/** Identity of an option contract in a PositionBook. Strikes compare in ticks of STRIKE_TICK. */
+struct PositionKey {
+    SymbolId underlying;
+    OptionType type;
+    std::int64_t strike_ticks;
+    std::time_t expiry;
+
+    bool operator==(const PositionKey& other) const {
+        return underlying == other.underlying && type == other.type &&
+               strike_ticks == other.strike_ticks && expiry == other.expiry;
+    }
+};
+
+struct PositionKeyHash {
+    std::size_t operator()(const PositionKey& key) const noexcept {
+        std::uint64_t h = key.underlying * 0x9E3779B97F4A7C15ull;
+        h ^= static_cast<std::uint64_t>(key.strike_ticks) + 0x9E3779B97F4A7C15ull + (h << 6) + (h >> 2);
+        h ^= static_cast<std::uint64_t>(key.expiry) + 0x9E3779B97F4A7C15ull + (h << 6) + (h >> 2);
+        return static_cast<std::size_t>(h ^ static_cast<std::uint64_t>(key.type));
+    }
+};
+
+/**
+ * Open option positions as structure-of-arrays, one row per contract.
+ *
+ * Rows are dense (removal moves the last row into the hole), so each column is a contiguous
+ * array the batch kernels can read directly. A hash index maps PositionKey to its row, rows are
+ * grouped by underlying, and an expiry min-heap lets removeExpired() touch only the positions
+ * that expire. Row indices change when rows are removed; look contracts up by key.
+ */
+class PositionBook {
+public:
+    static constexpr double STRIKE_TICK = 1e-4;
+    static constexpr std::size_t NPOS = static_cast<std::size_t>(-1);
+
+    static std::int64_t strikeTicks(double strike) { return std::llround(strike / STRIKE_TICK); }
+    static PositionKey makeKey(SymbolId underlying, OptionType type, double strike, std::time_t expiry) {
+        return {underlying, type, strikeTicks(strike), expiry};
+    }
+
+    /**
+     * Open quantity contracts, or add to the open position on the same contract (its entry price
+     * becomes the quantity-weighted average). Returns the row.
+     */
+    std::size_t add(SymbolId underlying, OptionType type, double strike, std::time_t expiry, int quantity,
+                    double entry_price, std::time_t entry_time, double volatility, double mark);
+
+    /** Row holding key, or NPOS. */
+    std::size_t find(const PositionKey& key) const;
+
+    /** Take quantity off row; the row is removed when nothing is left. */
+    void reduce(std::size_t row, int quantity);
+    void remove(std::size_t row);
+
+    /**
+     * Remove every position with expiry <= now, calling on_expired(row) just before each one
+     * goes. Returns the number removed.
+     */
+    std::size_t removeExpired(std::time_t now, const std::function<void(std::size_t)>& on_expired);
+
+    /** Rows on underlying (order unspecified); empty if none. */
+    const std::vector<std::uint32_t>& rowsFor(SymbolId underlying) const;
+    /** Underlyings with at least one open position. */
+    std::vector<SymbolId> underlyings() const;
+
+    std::size_t size() const { return underlying_.size(); }
+    bool empty() const { return underlying_.empty(); }
+
+    // Columns, each size() long
+    const SymbolId* underlying() const { return underlying_.data(); }
+    const OptionType* type() const { return type_.data(); }
+    const double* strike() const { return strike_.data(); }
+    const std::time_t* expiry() const { return expiry_.data(); }
+    const int* quantity() const { return quantity_.data(); }
+    const double* entryPrice() const { return entry_price_.data(); }
+    const std::time_t* entryTime() const { return entry_time_.data(); }
+    const double* volatility() const { return volatility_.data(); }  // NaN: use the caller's default
+    const double* mark() const { return mark_.data(); }
+    double* mark() { return mark_.data(); }
+
+    PositionKey key(std::size_t row) const {
+        return makeKey(underlying_[row], type_[row], strike_[row], expiry_[row]);
+    }
+
+private:
+    void compactExpiries();
+
+    struct ExpiryEntry {
+        std::time_t expiry;
+        PositionKey key;
+        bool operator>(const ExpiryEntry& other) const { return expiry > other.expiry; }
+    };
+
+    std::vector<SymbolId> underlying_;
+    std::vector<OptionType> type_;
+    std::vector<double> strike_;
+    std::vector<std::time_t> expiry_;
+    std::vector<int> quantity_;
+    std::vector<double> entry_price_;
+    std::vector<std::time_t> entry_time_;
+    std::vector<double> volatility_;
+    std::vector<double> mark_;
+    std::vector<std::uint32_t> group_slot_;  // row's index within rows_by_underlying_[underlying]
+
+    std::unordered_map<PositionKey, std::uint32_t, PositionKeyHash> index_;
+    std::unordered_map<SymbolId, std::vector<std::uint32_t>> rows_by_underlying_;
+    // Lazy: entries whose contract was closed are skipped when they reach the top, and the heap
+    // is rebuilt from the open rows once they make up less than half of it
+    std::priority_queue<ExpiryEntry, std::vector<ExpiryEntry>, std::greater<ExpiryEntry>> expiries_;
+};
+
+#endif // POSITION_BOOK_H
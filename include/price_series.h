@@ -0,0 +1,82 @@
+#ifndef PRICE_SERIES_H
+#define PRICE_SERIES_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/** Per-day columns a price series may carry. */
+enum PriceField : unsigned {
+    FIELD_OPEN,
+    FIELD_HIGH,
+    FIELD_LOW,
+    FIELD_CLOSE,
+    FIELD_ADJUSTED_CLOSE,
+    FIELD_VOLUME,
+    PRICE_FIELD_COUNT
+};
+
+/**
+ * Non-owning view of a daily series: an int32 day column (CalendarDate day numbers, strictly
+ * ascending) and one contiguous double column per field the source provides (nullptr for the
+ * others). Cheap to copy; valid as long as the series it points into.
+ */
+struct PriceSeriesView {
+    const std::int32_t* days{nullptr};
+    const double* fields[PRICE_FIELD_COUNT] = {};
+    std::size_t size{0};
+
+    bool empty() const { return size == 0; }
+    bool has(PriceField field) const { return fields[field] != nullptr; }
+    const double* column(PriceField field) const { return fields[field]; }
+
+    /** Column to compute returns from: adjusted close when present, else close (nullptr if neither). */
+    const double* prices() const {
+        return fields[FIELD_ADJUSTED_CLOSE] ? fields[FIELD_ADJUSTED_CLOSE] : fields[FIELD_CLOSE];
+    }
+
+    /** Rows [first, first + count), clamped to the series. */
+    PriceSeriesView slice(std::size_t first, std::size_t count) const {
+        PriceSeriesView out;
+        first = std::min(first, size);
+        out.size = std::min(count, size - first);
+        out.days = days ? days + first : nullptr;
+        for (unsigned f = 0; f < PRICE_FIELD_COUNT; ++f) out.fields[f] = fields[f] ? fields[f] + first : nullptr;
+        return out;
+    }
+
+    /** Rows with first_day <= day <= last_day (binary search on the day column). */
+    PriceSeriesView between(std::int32_t first_day, std::int32_t last_day) const {
+        const std::int32_t* begin = std::lower_bound(days, days + size, first_day);
+        const std::int32_t* end = std::upper_bound(begin, days + size, last_day);
+        return slice(static_cast<std::size_t>(begin - days), static_cast<std::size_t>(end - begin));
+    }
+};
+
+/** Owning daily series: same layout as PriceSeriesView, one std::vector per column. */
+class PriceSeries {
+public:
+    PriceSeries() = default;
+
+    /** days must be strictly ascending; throws std::invalid_argument otherwise. */
+    explicit PriceSeries(std::vector<std::int32_t> days);
+
+    /** Attach or replace a column; values.size() must equal size() (std::invalid_argument). */
+    void setColumn(PriceField field, std::vector<double> values);
+
+    std::size_t size() const { return days_.size(); }
+    bool empty() const { return days_.empty(); }
+    bool has(PriceField field) const { return present_[field]; }
+    const std::vector<std::int32_t>& days() const { return days_; }
+    const std::vector<double>& column(PriceField field) const { return columns_[field]; }
+
+    PriceSeriesView view() const;
+
+private:
+    std::vector<std::int32_t> days_;
+    std::vector<double> columns_[PRICE_FIELD_COUNT];
+    bool present_[PRICE_FIELD_COUNT] = {};
+};
+
+#endif // PRICE_SERIES_H
@@ -0,0 +1,78 @@
+#ifndef PRICE_STORE_H
+#define PRICE_STORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "price_series.h"
+
+/**
+ * One symbol's stored daily series, memory-mapped read-only. Columns are contiguous and sorted
+ * by day number (see CalendarDate). Move-only; the mapping is released on destruction.
+ */
+class MappedPriceSeries {
+public:
+    MappedPriceSeries() = default;
+    ~MappedPriceSeries();
+    MappedPriceSeries(MappedPriceSeries&& other) noexcept;
+    MappedPriceSeries& operator=(MappedPriceSeries&& other) noexcept;
+    MappedPriceSeries(const MappedPriceSeries&) = delete;
+    MappedPriceSeries& operator=(const MappedPriceSeries&) = delete;
+
+    std::size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    const std::int32_t* days() const { return days_; }
+    const double* adjustedClose() const { return adjusted_close_; }
+
+    /** The mapped columns (FIELD_ADJUSTED_CLOSE only), zero-copy. */
+    PriceSeriesView view() const {
+        PriceSeriesView out;
+        out.days = days_;
+        out.fields[FIELD_ADJUSTED_CLOSE] = adjusted_close_;
+        out.size = size_;
+        return out;
+    }
+
+    /** Day the series was last brought up to date from the API. */
+    std::int32_t refreshedDay() const { return refreshed_day_; }
+
+private:
+    friend class PriceStore;
+    void release();
+
+    void* mapping_{nullptr};
+    std::size_t mapped_bytes_{0};
+    std::vector<unsigned char> buffer_;  // platforms without mmap read the file into memory
+    std::size_t size_{0};
+    const std::int32_t* days_{nullptr};
+    const double* adjusted_close_{nullptr};
+    std::int32_t refreshed_day_{0};
+};
+
+/**
+ * Directory of binary columnar price files, one per symbol ("<SYMBOL>.bsp"):
+ * a 32-byte header, the int32 day column (padded to 8 bytes), then the double adjusted-close
+ * column. Files are replaced atomically (write to a uniquely named temp file in the same
+ * directory, then rename), so readers never see a partial file and concurrent writers of one
+ * symbol never share a temp file; the last rename wins.
+ */
+class PriceStore {
+public:
+    explicit PriceStore(std::string directory);
+
+    const std::string& directory() const { return directory_; }
+    std::string pathFor(const std::string& symbol) const;
+
+    /** Map the symbol's file; false if it is missing or not a valid store file. */
+    bool load(const std::string& symbol, MappedPriceSeries& out) const;
+
+    /** Replace the symbol's file. days must be strictly ascending. Throws std::runtime_error. */
+    void write(const std::string& symbol, const std::int32_t* days, const double* adjusted_close,
+               std::size_t count, std::int32_t refreshed_day) const;
+
+private:
+    std::string directory_;
+};
+
+#endif // PRICE_STORE_H
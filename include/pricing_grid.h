@@ -0,0 +1,166 @@
+#ifndef PRICING_GRID_H
+#define PRICING_GRID_H
+
+#include "black_scholes_greeks.h"
+#include "quote_store.h"
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+class TaskExecutor;
+
+/** Axes, resolution and accuracy of a PricingGrid. Axes are uniform. */
+struct PricingGridConfig {
+    double max_log_moneyness{1.0};      // |ln(F / K)| covered, F = S e^(rT)
+    std::size_t moneyness_points{256};
+    double min_total_volatility{0.02};  // sigma * sqrt(T)
+    double max_total_volatility{1.5};
+    std::size_t volatility_points{192};
+    double max_error{1e-5};             // on price / strike, delta and gamma x spot; cells that miss it go analytic
+    TaskExecutor* executor{nullptr};    // nullptr = TaskExecutor::shared()
+};
+
+/**
+ * Precomputed Black-Scholes values answered by bicubic (4x4 Lagrange) interpolation.
+ *
+ * Per unit strike, price and Greeks depend on (spot, T, vol, rate) only through the forward
+ * log-moneyness y = ln(S / K) + rT and the total volatility s = sigma sqrt(T). The grid stores
+ * the undiscounted call e^y N(d1) - N(d2), N(d1) and phi(d1) over (y, s). Every call and put
+ * price and Greek is rebuilt from those three and the query's S, K, T and r, so one grid
+ * serves any rate and vol surface. After the build, each cell is checked at 25 points (corners,
+ * edge midpoints, quarter points) against the analytic values. Cells that miss
+ * config.max_error on price, delta or gamma, and queries off the grid (including T or
+ * sigma ~ 0), fall back to BlackScholesGreeks::calculateAll. The grid is immutable once
+ * built, so any number of threads can query it.
+ */
+class PricingGrid {
+public:
+    /** Build the grid, one total-volatility row per parallel task on config.executor. */
+    static std::shared_ptr<const PricingGrid> build(const PricingGridConfig& config);
+
+    /**
+     * Interpolated call and put price and Greeks, in BlackScholesGreeks units. Returns false
+     * and leaves out untouched when the point is off the grid or in a cell over the error bound.
+     */
+    bool interpolate(double spot_price, double strike_price, double risk_free_rate, double volatility,
+                     double time_to_expiry, OptionValuation& out) const;
+    /** interpolate(), or the analytic kernel where it declines (which throws on invalid inputs). */
+    OptionValuation quote(double spot_price, double strike_price, double risk_free_rate, double volatility,
+                          double time_to_expiry) const;
+
+    const PricingGridConfig& config() const { return config_; }
+    /** True if the axes reach |ln(F / K)| = log_moneyness and sigma sqrt(T) = total_volatility. */
+    bool covers(double log_moneyness, double total_volatility) const {
+        return log_moneyness <= config_.max_log_moneyness && total_volatility <= config_.max_total_volatility;
+    }
+    std::size_t cellCount() const { return fallback_.size(); }
+    /** Cells that answer analytically because interpolation missed max_error there. */
+    std::size_t fallbackCells() const { return fallback_count_; }
+
+private:
+    struct Node {
+        double call;    // e^y N(d1) - N(d2)
+        double n_d1;    // N(d1)
+        double pdf_d1;  // phi(d1)
+    };
+
+    explicit PricingGrid(const PricingGridConfig& config);
+
+    void buildRow(std::size_t volatility_index);
+    void checkRow(std::size_t volatility_index);
+    // Interpolated node, or false off the axes; also returns the cell index
+    bool interpolateNode(double log_moneyness, double total_volatility, Node& node, std::size_t& cell) const;
+    // 4x4 Lagrange sum from the stencils' first nodes and weights along each axis
+    Node interpolateStencils(std::size_t first_y, const double* weight_y, std::size_t first_s,
+                             const double* weight_s) const;
+    std::size_t nodeIndex(std::size_t y, std::size_t s) const { return s * config_.moneyness_points + y; }
+    std::size_t cellIndex(std::size_t y, std::size_t s) const { return s * (config_.moneyness_points - 1) + y; }
+
+    PricingGridConfig config_;
+    double step_y_, step_s_;
+    double inverse_step_y_, inverse_step_s_;  // lookups multiply instead of divide
+    std::vector<Node> nodes_;
+    std::vector<std::uint8_t> fallback_;
+    std::size_t fallback_count_{0};
+};
+
+/**
+ * Immutable grid plus the per-underlying rates it quotes at, as published by PricingGridCache.
+ * Querying one takes no lock and touches no shared counter, so hot loops should hold a
+ * snapshot and quote through it.
+ */
+class PricingGridSnapshot {
+public:
+    /** The grid (nullptr until the cache's first build finishes). */
+    const std::shared_ptr<const PricingGrid>& grid() const { return grid_; }
+    /** Rate recorded for underlying; throws std::out_of_range if it was never update()d. */
+    double riskFreeRate(SymbolId underlying) const;
+    /** Grid quote at underlying's rate, analytic while there is no grid. Throws like riskFreeRate. */
+    OptionValuation quote(SymbolId underlying, double spot_price, double strike_price, double volatility,
+                          double time_to_expiry) const;
+
+private:
+    friend class PricingGridCache;
+    std::shared_ptr<const PricingGrid> grid_;
+    std::unordered_map<SymbolId, double> rates_;
+};
+
+/**
+ * Grid quotes per underlying. The grid does not depend on rates or vols, so update() usually
+ * just records them. A rebuild is needed only when an underlying's rate, top vol and longest
+ * expiry take quotes off the current axes: |ln(S / K)| up to the configured max_log_moneyness
+ * must stay on the grid after the rT shift. The wider grid keeps the configured resolution. It
+ * is built in the background on the executor while the current one keeps answering, and
+ * swapped in when ready. A build that finishes after a newer one is dropped.
+ *
+ * Readers never take the cache's mutex: a changed rate or a finished build publishes a new
+ * PricingGridSnapshot through an atomic shared_ptr, and quote() / grid() / riskFreeRate() load
+ * it. That load still costs a reference count, so hot loops should take snapshot() once and
+ * quote through it.
+ */
+class PricingGridCache {
+public:
+    explicit PricingGridCache(const PricingGridConfig& config = PricingGridConfig());
+    ~PricingGridCache();  // waits for builds in flight
+
+    PricingGridCache(const PricingGridCache&) = delete;
+    PricingGridCache& operator=(const PricingGridCache&) = delete;
+
+    /** Record underlying's rate and the vol / expiry range it quotes; widens the grid if needed. */
+    void update(SymbolId underlying, double risk_free_rate, double max_volatility, double max_time_to_expiry);
+
+    /** Current grid and rates; never nullptr. Later updates publish new snapshots and leave this one as is. */
+    std::shared_ptr<const PricingGridSnapshot> snapshot() const;
+    /** Current grid (nullptr until the first build finishes); hot loops can hold on to it. */
+    std::shared_ptr<const PricingGrid> grid() const;
+    /** Rate recorded for underlying; throws std::out_of_range if it was never update()d. */
+    double riskFreeRate(SymbolId underlying) const;
+
+    /** Grid quote at underlying's rate, analytic while no grid is ready. Throws like riskFreeRate. */
+    OptionValuation quote(SymbolId underlying, double spot_price, double strike_price, double volatility,
+                          double time_to_expiry) const;
+
+    /** Block until every scheduled build has finished. */
+    void waitForBuilds();
+
+private:
+    // Replace the published snapshot with grid_ and rates_; mutex_ held
+    void publish();
+
+    PricingGridConfig base_;       // as configured
+    PricingGridConfig config_;     // axes of the newest grid built or scheduled
+    mutable std::mutex mutex_;     // writers only
+    std::condition_variable idle_;
+    std::unordered_map<SymbolId, double> rates_;
+    std::shared_ptr<const PricingGrid> grid_;
+    std::shared_ptr<const PricingGridSnapshot> snapshot_;  // std::atomic_load / atomic_store only
+    std::uint64_t generation_{0};  // bumped per scheduled build; 0 = none yet
+    std::uint64_t installed_{0};   // generation of grid_
+    std::size_t builds_in_flight_{0};
+};
+
+#endif // PRICING_GRID_H
@@ -0,0 +1,108 @@
+#ifndef QUOTE_STORE_H
+#define QUOTE_STORE_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+/** Interned symbol: a dense index into QuoteStore, stable for the store's lifetime. */
+using SymbolId = std::uint32_t;
+
+enum QuoteSource : std::uint8_t {
+    SOURCE_NONE,    // no quote yet
+    SOURCE_FEED,    // fetched from the data feed
+    SOURCE_MANUAL   // pushed with setCurrentPrice (paper trading, tests)
+};
+
+struct Quote {
+    double price{0.0};
+    std::int64_t timestamp_ns{0};  // system_clock time of the update, ns since the epoch
+    QuoteSource source{SOURCE_NONE};
+};
+
+/**
+ * Concurrent last-quote cache. Symbols are interned to SymbolIds through a sharded,
+ * reader-writer-locked map. Each quote lives in a seqlock slot, so reads by id never take a
+ * lock and never block writers. Writers to the same slot serialize on its sequence number.
+ */
+class QuoteStore {
+public:
+    using Clock = std::chrono::system_clock;
+
+    static constexpr std::size_t MAX_SYMBOLS = 1u << 20;
+
+    explicit QuoteStore(std::chrono::milliseconds ttl);
+    ~QuoteStore();
+
+    QuoteStore(const QuoteStore&) = delete;
+    QuoteStore& operator=(const QuoteStore&) = delete;
+
+    /** Id for symbol, assigned on first use. Throws std::length_error past MAX_SYMBOLS. */
+    SymbolId intern(const std::string& symbol);
+
+    /** Id for symbol if it was interned before. */
+    bool find(const std::string& symbol, SymbolId& id) const;
+
+    /** Symbol interned as id. */
+    std::string symbol(SymbolId id) const;
+
+    void write(SymbolId id, double price, QuoteSource source, std::int64_t timestamp_ns = nowNs());
+
+    /** Latest quote for id, lock-free; false if there is none. */
+    bool read(SymbolId id, Quote& out) const;
+
+    /** True if there is no quote, or it is older than max_age (the store's TTL by default). */
+    bool isStale(SymbolId id, std::chrono::milliseconds max_age) const;
+    bool isStale(SymbolId id) const { return isStale(id, ttl_); }
+
+    /**
+     * Claim a refresh of id: true at most once per min_interval, so callers that all see the
+     * same stale quote issue one fetch between them.
+     */
+    bool claimRefresh(SymbolId id, std::chrono::milliseconds min_interval);
+
+    std::chrono::milliseconds ttl() const { return ttl_; }
+    std::size_t size() const { return size_.load(std::memory_order_acquire); }
+
+    static std::int64_t nowNs();
+
+private:
+    static constexpr std::size_t SLOTS_PER_CHUNK = 1024;
+    static constexpr std::size_t NUM_CHUNKS = MAX_SYMBOLS / SLOTS_PER_CHUNK;
+    static constexpr std::size_t NUM_SHARDS = 16;
+
+    // Seqlock slot: odd sequence while a write is in progress. Fields are atomics (relaxed) so
+    // a torn read is detected by the sequence check rather than being a data race.
+    struct alignas(64) Slot {
+        std::atomic<std::uint32_t> sequence{0};
+        std::atomic<double> price{0.0};
+        std::atomic<std::int64_t> timestamp_ns{0};
+        std::atomic<std::uint8_t> source{SOURCE_NONE};
+        std::atomic<std::int64_t> refresh_claimed_ns{0};
+    };
+
+    struct Shard {
+        mutable std::shared_mutex mutex;
+        std::unordered_map<std::string, SymbolId> ids;
+    };
+
+    Slot& slot(SymbolId id) const;
+    Shard& shardFor(const std::string& symbol) const;
+
+    std::chrono::milliseconds ttl_;
+    mutable std::array<Shard, NUM_SHARDS> shards_;
+    std::array<std::atomic<Slot*>, NUM_CHUNKS> chunks_;  // published once, never moved
+    std::atomic<std::size_t> size_{0};
+    mutable std::mutex names_mutex_;
+    std::unordered_map<SymbolId, std::string> names_;
+    std::mutex grow_mutex_;
+};
+
+#endif // QUOTE_STORE_H
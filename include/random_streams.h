@@ -0,0 +1,108 @@
+#ifndef RANDOM_STREAMS_H
+#define RANDOM_STREAMS_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Philox4x32-10 counter-based generator (Salmon et al., "Parallel random numbers: as easy as
+ * 1, 2, 3"). Output block n of stream s is a pure function of (key, n, s), so any thread can
+ * jump straight to any path: there is no state to advance or share.
+ */
+class Philox4x32 {
+public:
+    using Block = std::array<std::uint32_t, 4>;
+    using Key = std::array<std::uint32_t, 2>;
+
+    /** Stream `stream` of the generator keyed by `seed`; starts at block 0. */
+    Philox4x32(std::uint64_t seed, std::uint64_t stream) noexcept;
+
+    /** The Philox bijection: 10 rounds over counter block ctr under key. */
+    static Block round10(Block ctr, Key key) noexcept;
+
+    /** Jump to block `position` of this stream (each block yields two doubles). */
+    void seek(std::uint64_t position) noexcept;
+
+    /** n uniforms in (0, 1) with 53 random bits each, consuming ceil(n / 2) blocks. */
+    void fillUniform(double* out, std::size_t n) noexcept;
+
+    /**
+     * The first per_stream uniforms of streams first_stream .. first_stream + count - 1, row by
+     * row: out[k * per_stream + i] equals uniform i of stream first_stream + k.
+     */
+    static void fillStreams(std::uint64_t seed, std::uint64_t first_stream, std::size_t count,
+                            std::size_t per_stream, double* out) noexcept;
+
+private:
+    Key key_;
+    Block counter_;
+};
+
+/** Standard normal quantile, Wichura's AS241 (PPND16): relative error ~1e-16 on (0, 1). */
+class InverseNormal {
+public:
+    static double quantile(double p) noexcept;
+
+    /** In place: uniforms in (0, 1) become standard normals. */
+    static void transform(double* values, std::size_t n) noexcept;
+};
+
+/**
+ * Sobol' low-discrepancy sequence in up to a few thousand dimensions.
+ *
+ * Primitive polynomials are enumerated at construction and the initial direction numbers are
+ * odd integers drawn from a fixed SplitMix64 stream; any such choice gives a valid Sobol'
+ * sequence. With a non-zero scramble seed the sequence is randomised by a random linear matrix
+ * scramble plus a digital shift (Matousek), which keeps the net structure and makes the
+ * estimator unbiased with a measurable error across seeds.
+ */
+class SobolSequence {
+public:
+    static constexpr int BITS = 32;
+
+    SobolSequence(unsigned dimensions, std::uint64_t scramble_seed);
+
+    unsigned dimensions() const noexcept { return dimensions_; }
+
+    /**
+     * Points first .. first + count - 1 (Gray-code order) as uniforms in (0, 1), written
+     * point-major: out[k * dimensions() + d]. Starting anywhere costs one direct evaluation.
+     */
+    void fill(std::uint64_t first, std::size_t count, double* out) const;
+
+private:
+    unsigned dimensions_;
+    std::vector<std::uint32_t> directions_;  // [dimension][bit]
+    std::vector<std::uint32_t> shift_;
+};
+
+/**
+ * Brownian bridge over `steps` equal time steps. The first normal fixes W(T), the next ones
+ * the midpoints of ever finer intervals, so the low (best-distributed) Sobol' dimensions carry
+ * most of the path's variance.
+ */
+class BrownianBridge {
+public:
+    explicit BrownianBridge(int steps);
+
+    int steps() const noexcept { return steps_; }
+
+    /**
+     * z[0..steps) in bridge order -> standardised increments out[0..steps) (dW_i / sqrt(dt)),
+     * i.e. i.i.d. standard normals in time order with the same joint law.
+     */
+    void transform(const double* z, double* out) const;
+
+private:
+    int steps_;
+    std::vector<int> point_;   // W index fixed by z[k]
+    std::vector<int> left_;
+    std::vector<int> right_;
+    std::vector<double> left_weight_;
+    std::vector<double> right_weight_;
+    std::vector<double> std_dev_;
+};
+
+#endif // RANDOM_STREAMS_H
@@ -0,0 +1,106 @@
+#ifndef ROLLING_VOLATILITY_H
+#define ROLLING_VOLATILITY_H
+
+#include <cstddef>
+#include <vector>
+#include "price_series.h"
+
+class TaskExecutor;
+
+/** Volatility estimators over a rolling window of daily bars. */
+enum VolatilityEstimator {
+    VOL_CLOSE_TO_CLOSE,  // sample std of log close-to-close returns (as HistoricalVolatility)
+    VOL_PARKINSON,       // high-low range
+    VOL_GARMAN_KLASS,    // open-high-low-close
+    VOL_YANG_ZHANG,      // overnight + open-to-close + Rogers-Satchell, drift independent
+    VOL_ESTIMATOR_COUNT
+};
+
+struct RollingVolatilityConfig {
+    std::vector<int> windows{10, 20, 30, 60, 90};  // in returns (bars after the first)
+    double ewma_lambda{0.94};                      // RiskMetrics daily decay
+    double periods_per_year{252.0};
+    TaskExecutor* executor{nullptr};               // computeAll; nullptr: TaskExecutor::shared()
+};
+
+/** Rolling series for one symbol, aligned with its bars. Values are annualized; NaN until a window fills. */
+struct RollingVolatilitySeries {
+    std::size_t bars{0};
+    std::vector<int> windows;
+    std::vector<double> values[VOL_ESTIMATOR_COUNT];  // window-major: [w * bars + i]; range estimators empty without OHLC
+    std::vector<double> ewma;                         // RiskMetrics, one value per bar
+
+    /** Series for estimator over windows[w] (nullptr if it was not computed). */
+    const double* series(VolatilityEstimator estimator, std::size_t w) const {
+        return values[estimator].empty() ? nullptr : values[estimator].data() + w * bars;
+    }
+};
+
+/**
+ * Incremental volatility over several windows at once. Each bar adds its log terms to every
+ * window's running moments (Welford) and removes the term that falls out of the window, so a
+ * bar costs O(1) per window instead of recomputing the window from scratch.
+ */
+class RollingVolatilityEngine {
+public:
+    explicit RollingVolatilityEngine(const RollingVolatilityConfig& config = RollingVolatilityConfig());
+
+    void reset();
+
+    /** Next close-only bar (chronological). */
+    void addClose(double close);
+
+    /** Next OHLC bar; also feeds the range estimators. */
+    void addBar(double open, double high, double low, double close);
+
+    /** Annualized estimate over windows()[w]; NaN until the window is full (or without OHLC bars). */
+    double volatility(std::size_t w, VolatilityEstimator estimator = VOL_CLOSE_TO_CLOSE) const;
+
+    /** Annualized RiskMetrics EWMA; NaN before the second bar. */
+    double ewmaVolatility() const;
+
+    const std::vector<int>& windows() const { return windows_; }
+    std::size_t bars() const { return bars_; }
+
+    /**
+     * Rolling series for every estimator the view's columns allow, in one pass. OHLC bars are
+     * first rescaled by adjusted / raw close, so splits and dividends don't read as returns.
+     */
+    static RollingVolatilitySeries compute(const PriceSeriesView& series,
+                                           const RollingVolatilityConfig& config = RollingVolatilityConfig());
+
+    /** compute() for many symbols in parallel on config.executor; result i belongs to series[i]. */
+    static std::vector<RollingVolatilitySeries> computeAll(const std::vector<PriceSeriesView>& series,
+                                                           const RollingVolatilityConfig& config = RollingVolatilityConfig());
+
+private:
+    // Running mean and sum of squared deviations, with removal for sliding windows
+    struct Moments {
+        double n{0.0};
+        double mean{0.0};
+        double m2{0.0};
+        void add(double x);
+        void remove(double x);
+        double variance() const { return n > 1.0 ? m2 / (n - 1.0) : 0.0; }
+    };
+
+    // Per-bar terms, kept in a ring of the longest window so expired terms can be removed
+    enum Term { TERM_RETURN, TERM_PARKINSON, TERM_GARMAN_KLASS, TERM_OVERNIGHT, TERM_OPEN_CLOSE, TERM_ROGERS_SATCHELL, TERM_COUNT };
+
+    void push(const double* terms, bool ohlc);
+
+    std::vector<int> windows_;
+    double lambda_;
+    double periods_per_year_;
+    std::size_t capacity_;
+    std::vector<double> ring_[TERM_COUNT];
+    std::vector<unsigned char> ring_ohlc_;
+    std::vector<Moments> moments_[TERM_COUNT];  // [term][w]
+    std::vector<std::size_t> ohlc_in_window_;   // [w]: bars in the window that carried OHLC
+    std::size_t bars_{0};
+    std::size_t terms_{0};
+    double previous_close_{0.0};
+    double ewma_variance_{0.0};
+};
+
+#endif // ROLLING_VOLATILITY_H
@@ -0,0 +1,117 @@
+#ifndef SCENARIO_ENGINE_H
+#define SCENARIO_ENGINE_H
+
+#include "option.h"
+#include "position_book.h"
+#include "vol_surface.h"
+#include <cstddef>
+#include <ctime>
+#include <map>
+#include <utility>
+#include <vector>
+
+class OptionStrategy;
+class TaskExecutor;
+
+/** Shock axes of a scenario cube. Every combination (spot, vol, time) is evaluated. */
+struct ScenarioGrid {
+    std::vector<double> spot_shifts{0.0};  // relative: -0.1 = spot down 10%
+    std::vector<double> vol_shifts{0.0};   // absolute: 0.05 = vol up 5 points (floored at 0)
+    std::vector<double> time_steps{0.0};   // days forward; expiries reached are worth intrinsic
+
+    /** points evenly spaced values from -range to +range (just 0 if points < 2). */
+    static std::vector<double> symmetric(double range, std::size_t points);
+    /** points evenly spaced values from 0 to last (just 0 if points < 2). */
+    static std::vector<double> steps(double last, std::size_t points);
+};
+
+struct ScenarioConfig {
+    double risk_free_rate{0.05};
+    double default_volatility{0.2};   // for positions without their own volatility or a surface
+    const VolSurfaceSet* vol_surfaces{nullptr};  // by SymbolId, for book rows without their own volatility
+    std::time_t now{0};               // valuation time; 0 = std::time(nullptr)
+    TaskExecutor* executor{nullptr};  // nullptr = TaskExecutor::shared()
+};
+
+/**
+ * Flat portfolio for scenario runs: option legs grouped into (underlying, expiry) slices plus a
+ * stock holding per underlying. Quantities are in units of the underlying, so a contract of 100
+ * shares counts as 100.
+ */
+class ScenarioPortfolio {
+public:
+    explicit ScenarioPortfolio(std::time_t now = 0);
+
+    /**
+     * Book rows at their own volatility, else the underlying's surface in config.vol_surfaces,
+     * else config.default_volatility. Rows without a spot are skipped.
+     */
+    static ScenarioPortfolio fromBook(const PositionBook& book, const std::vector<double>& spot_by_symbol,
+                                      const ScenarioConfig& config);
+    /** Strategy legs and stock at one volatility, scaled by OptionStrategy::CONTRACT_MULTIPLIER. */
+    static ScenarioPortfolio fromStrategy(const OptionStrategy& strategy, double spot, double volatility,
+                                          const ScenarioConfig& config);
+
+    /** Index of a new underlying for addLeg. */
+    std::size_t addUnderlying(double spot, double shares = 0.0);
+    void addLeg(std::size_t underlying, OptionType type, double strike, std::time_t expiry, double quantity,
+                double volatility);
+
+    std::size_t legCount() const;
+    std::size_t underlyingCount() const { return spots_.size(); }
+    std::size_t skipped() const { return skipped_; }
+
+private:
+    friend class ScenarioEngine;
+
+    struct Slice {
+        std::size_t underlying;
+        std::time_t expiry;
+        double time_to_expiry;  // years from now
+        std::vector<double> strike, volatility, quantity;
+        std::vector<OptionType> type;
+    };
+
+    std::time_t now_;
+    std::vector<double> spots_;
+    std::vector<double> shares_;
+    std::vector<Slice> slices_;
+    std::map<std::pair<std::size_t, std::time_t>, std::size_t> slice_index_;
+    std::size_t skipped_{0};
+};
+
+/** Portfolio value at every grid point, with [time][vol][spot] layout (spot fastest). */
+struct ScenarioCube {
+    std::size_t spot_count{0};
+    std::size_t vol_count{0};
+    std::size_t time_count{0};
+    double base_value{0.0};  // unshocked value, same pricer
+    std::vector<double> value;
+
+    std::size_t index(std::size_t spot, std::size_t vol, std::size_t time) const {
+        return (time * vol_count + vol) * spot_count + spot;
+    }
+    double profitLoss(std::size_t spot, std::size_t vol, std::size_t time) const {
+        return value[index(spot, vol, time)] - base_value;
+    }
+};
+
+/**
+ * Spot x vol x time stress tests. Each (time, vol) pair is one parallel task; within it every
+ * slice prices all of its strikes per spot shift with sqrt(T) and exp(-rT) computed once per
+ * slice: through BlackScholesKernel::priceSlice<CALL/PUT> on one ExpiryContext when every leg
+ * is inDomain(), else through BlackScholesBatch::priceExpirySlice. Shifts apply to all
+ * underlyings together. Invalid legs (e.g. a non-positive shocked spot) contribute nothing.
+ */
+class ScenarioEngine {
+public:
+    static ScenarioCube run(const ScenarioPortfolio& portfolio, const ScenarioGrid& grid,
+                            const ScenarioConfig& config);
+
+private:
+    // Value at every spot shift for one (vol shift, days forward), into values[0..spot_count)
+    static void evaluate(const ScenarioPortfolio& portfolio, const std::vector<double>& spot_shifts,
+                         double vol_shift, double days_forward, double risk_free_rate, double* values);
+};
+
+#endif // SCENARIO_ENGINE_H
@@ -0,0 +1,73 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Persistent work-stealing thread pool shared by the Monte Carlo pricer, the path simulator
+ * and the batch kernels.
+ *
+ * Each worker owns a deque: it pops its own work LIFO and steals from the other end of its
+ * neighbours' deques when idle. Tasks submitted from a worker go to that worker's deque; tasks
+ * from other threads are spread round-robin. Threads are created once, so repeated pricings
+ * don't pay for thread start-up and concurrent pricings share the same cores instead of
+ * oversubscribing them.
+ */
+class TaskExecutor {
+public:
+    /**
+     * num_threads = 0 uses std::thread::hardware_concurrency(). With pin_threads, worker i is
+     * bound to CPU i (mod CPU count) where the platform supports it (Linux); ignored elsewhere.
+     */
+    explicit TaskExecutor(unsigned num_threads = 0, bool pin_threads = false);
+    ~TaskExecutor();
+
+    TaskExecutor(const TaskExecutor&) = delete;
+    TaskExecutor& operator=(const TaskExecutor&) = delete;
+
+    /** Process-wide pool with one worker per hardware thread, created on first use. */
+    static TaskExecutor& shared();
+
+    unsigned threadCount() const noexcept { return static_cast<unsigned>(workers_.size()); }
+
+    /** Fire-and-forget. The task must not throw; wrap it if it can. */
+    void submit(std::function<void()> task);
+
+    /**
+     * Run body(i) for every i in [0, count) and return when all calls have finished. Indices are
+     * handed out dynamically, so which thread runs which index is unspecified; anything that must
+     * be reproducible (e.g. RNG seeds) has to be derived from i, not from the thread. The calling
+     * thread takes part, so this may be called from inside a pool task. The first exception thrown
+     * by body is rethrown here once the remaining indices are done (or skipped).
+     */
+    void parallelFor(std::size_t count, const std::function<void(std::size_t)>& body);
+
+private:
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    void workerLoop(unsigned index);
+    bool tryRunOne(unsigned preferred);
+    bool popLocal(unsigned index, std::function<void()>& task);
+    bool steal(unsigned thief, std::function<void()>& task);
+
+    std::vector<std::unique_ptr<WorkQueue>> queues_;
+    std::vector<std::thread> workers_;
+    std::mutex sleep_mutex_;
+    std::condition_variable wake_;
+    std::atomic<std::size_t> pending_{0};
+    std::atomic<unsigned> next_queue_{0};
+    bool stopping_{false};
+};
+
+#endif // THREAD_POOL_H
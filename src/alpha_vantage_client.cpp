@@ -1,79 +1,152 @@
 #include "../include/alpha_vantage_client.h"
-#include <curl/curl.h>
+#include "../include/calendar_date.h"
+#include "../include/instrumentation.h"
+#include <algorithm>
+#include <charconv>
+#include <limits>
 #include <stdexcept>
 #include <sstream>
 #include <iomanip>
 #include <ctime>
 #include <iostream> 
 
-// Callback function for libcurl
-static size_t WriteCallback(void* contents, size_t size, size_t nmemb, std::string* output) {
-    size_t total_size = size * nmemb;
-    output->append((char*)contents, total_size);
-    return total_size;
-}
+namespace {
+constexpr double RATE_LIMIT_BURST = 5.0;
+constexpr const char* SERIES_KEY = "Time Series (Daily)";
+constexpr const char* ADJUSTED_CLOSE_KEY = "5. adjusted close";
+constexpr std::size_t BYTES_PER_DAILY_ENTRY = 200;  // a full-history entry is ~220 bytes of JSON
 
-// Constructor (empty API key allowed for offline/demo use; API calls will fail until key is set)
-AlphaVantageClient::AlphaVantageClient(const std::string& api_key)
-    : api_key(api_key) {
-    curl_global_init(CURL_GLOBAL_DEFAULT);
-}
+/**
+ * SAX handler for TIME_SERIES_DAILY_ADJUSTED: keeps only the adjusted close of days in range.
+ * Depth 1 is the response object, depth 2 the series (keyed by date), depth 3 one day's fields.
+ * Alpha Vantage lists days newest first, so parsing stops once it passes first_day.
+ */
+class DailyCloseSax : public nlohmann::json_sax<nlohmann::json> {
+public:
+    DailyCloseSax(std::int32_t first_day, std::int32_t last_day, DailyCloseColumns& out)
+        : first_day_(first_day), last_day_(last_day), out_(out) {}
 
-// Perform HTTP GET request
-std::string AlphaVantageClient::performHttpGet(const std::string& url) {
-    CURL* curl;
-    CURLcode res;
-    std::string response_string;
+    bool null() override { return true; }
+    bool boolean(bool) override { return true; }
+    bool number_integer(number_integer_t) override { return true; }
+    bool number_unsigned(number_unsigned_t) override { return true; }
+    bool number_float(number_float_t, const string_t&) override { return true; }
+    bool binary(binary_t&) override { return true; }
+    bool start_array(std::size_t) override { ++depth_; return true; }
+    bool end_array() override { --depth_; return true; }
 
-    curl = curl_easy_init();
-    if (!curl) {
-        throw std::runtime_error("Failed to initialize CURL");
+    bool start_object(std::size_t) override {
+        ++depth_;
+        if (depth_ == 2 && top_key_ == SERIES_KEY) found_series_ = true;
+        return true;
     }
 
-    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response_string);
+    bool end_object() override {
+        --depth_;
+        return true;
+    }
+
+    bool key(string_t& key) override {
+        if (depth_ == 1) {
+            top_key_ = key;
+        } else if (depth_ == 2 && in_series()) {
+            keep_day_ = CalendarDate::parseIso(key.data(), key.size(), day_) &&
+                        day_ >= first_day_ && day_ <= last_day_;
+            if (have_previous_ && day_ < previous_day_ && day_ < first_day_) {
+                stopped_early_ = true;  // descending and past the range: nothing left to keep
+                return false;
+            }
+            previous_day_ = day_;
+            have_previous_ = true;
+        } else if (depth_ == 3) {
+            adjusted_close_field_ = keep_day_ && key == ADJUSTED_CLOSE_KEY;
+        }
+        return true;
+    }
 
-    // Perform the request
-    res = curl_easy_perform(curl);
+    bool string(string_t& value) override {
+        if (depth_ == 1 && message_.empty()) {
+            // "Error Message", "Note" or "Information" explain a missing series
+            message_ = top_key_ + ": " + value;
+        } else if (depth_ == 3 && adjusted_close_field_) {
+            double close = 0.0;
+            const auto result = std::from_chars(value.data(), value.data() + value.size(), close);
+            if (result.ec == std::errc()) {
+                out_.days.push_back(day_);
+                out_.adjusted_close.push_back(close);
+            }
+            adjusted_close_field_ = false;
+        }
+        return true;
+    }
 
-    // Check for errors
-    if (res != CURLE_OK) {
-        curl_easy_cleanup(curl);
-        throw std::runtime_error("CURL request failed: " + std::string(curl_easy_strerror(res)));
+    bool parse_error(std::size_t position, const std::string&, const nlohmann::detail::exception& e) override {
+        error_ = "JSON parse error at byte " + std::to_string(position) + ": " + e.what();
+        return false;
     }
 
-    // Clean up
-    curl_easy_cleanup(curl);
+    bool foundSeries() const { return found_series_; }
+    bool stoppedEarly() const { return stopped_early_; }
+    const std::string& error() const { return error_; }
+    const std::string& message() const { return message_; }
+
+private:
+    bool in_series() const { return top_key_ == SERIES_KEY; }
 
-    return response_string;
+    std::int32_t first_day_;
+    std::int32_t last_day_;
+    DailyCloseColumns& out_;
+    int depth_{0};
+    std::string top_key_;
+    std::int32_t day_{0};
+    std::int32_t previous_day_{0};
+    bool have_previous_{false};
+    bool keep_day_{false};
+    bool adjusted_close_field_{false};
+    bool found_series_{false};
+    bool stopped_early_{false};
+    std::string error_;
+    std::string message_;
+};
 }
 
-// Get current stock price
-OptionalDouble AlphaVantageClient::getCurrentPrice(const std::string& symbol) {
-    // Add a small delay to respect API rate limits
-    std::this_thread::sleep_for(std::chrono::milliseconds(250));
+// Constructor (empty API key allowed for offline/demo use; API calls will fail until key is set)
+AlphaVantageClient::AlphaVantageClient(const std::string& api_key, double requests_per_minute)
+    : api_key(api_key),
+      rate_limiter(std::make_unique<RateLimiter>(requests_per_minute, RATE_LIMIT_BURST)),
+      http(std::make_unique<AsyncHttpClient>(rate_limiter.get())) {}
 
-    // Construct URL for global quote
-    std::string url = base_url + 
+// Perform HTTP GET request
+std::string AlphaVantageClient::performHttpGet(const std::string& url) {
+    return http->get(url).get().body;
+}
+
+std::string AlphaVantageClient::quoteUrl(const std::string& symbol) const {
+    return base_url + 
         "?function=GLOBAL_QUOTE" + 
         "&symbol=" + symbol + 
         "&apikey=" + api_key;
+}
 
-    try {
-        std::string response = performHttpGet(url);
-        
-        // Parse JSON response
-        auto json = nlohmann::json::parse(response);
-
-        // Extract price
-        if (json.contains("Global Quote") && 
-            json["Global Quote"].contains("05. price")) {
-            return OptionalDouble(std::stod(json["Global Quote"]["05. price"].get<std::string>()));
-        }
+OptionalDouble AlphaVantageClient::parseQuote(const std::string& symbol, const std::string& response) {
+    BS_TIMED_SCOPE(METRIC_JSON_PARSE);
+    // Parse JSON response
+    auto json = nlohmann::json::parse(response);
 
-        std::cerr << "No price data found for " << symbol << std::endl;
-        return OptionalDouble();
+    // Extract price
+    if (json.contains("Global Quote") && 
+        json["Global Quote"].contains("05. price")) {
+        return OptionalDouble(std::stod(json["Global Quote"]["05. price"].get<std::string>()));
+    }
+
+    std::cerr << "No price data found for " << symbol << std::endl;
+    return OptionalDouble();
+}
+
+// Get current stock price
+OptionalDouble AlphaVantageClient::getCurrentPrice(const std::string& symbol) {
+    try {
+        return parseQuote(symbol, performHttpGet(quoteUrl(symbol)));
     }
     catch (const std::exception& e) {
         std::cerr << "Error fetching current price for " << symbol << ": " << e.what() << std::endl;
@@ -81,52 +154,134 @@ OptionalDouble AlphaVantageClient::getCurrentPrice(const std::string& symbol) {
     }
 }
 
-// Get historical prices
-std::vector<std::pair<std::string, double>> AlphaVantageClient::getHistoricalPrices(
-    const std::string& symbol, 
-    const std::string& start_date, 
-    const std::string& end_date
+// Get current prices for many symbols; requests overlap, paced by the rate limiter
+std::vector<std::future<OptionalDouble>> AlphaVantageClient::getCurrentPrices(const std::vector<std::string>& symbols) {
+    std::vector<std::future<OptionalDouble>> prices;
+    prices.reserve(symbols.size());
+    for (const std::string& symbol : symbols) {
+        auto promise = std::make_shared<std::promise<OptionalDouble>>();
+        prices.push_back(promise->get_future());
+        http->get(quoteUrl(symbol), [promise, symbol](HttpResponse response) {
+            OptionalDouble price;
+            try {
+                if (!response.error.empty()) throw std::runtime_error("CURL request failed: " + response.error);
+                price = parseQuote(symbol, response.body);
+            }
+            catch (const std::exception& e) {
+                std::cerr << "Error fetching current price for " << symbol << ": " << e.what() << std::endl;
+            }
+            promise->set_value(price);
+        });
+    }
+    return prices;
+}
+
+// Parse daily adjusted closes without building a JSON document
+bool AlphaVantageClient::parseDailyCloses(
+    const std::string& response,
+    std::int32_t first_day,
+    std::int32_t last_day,
+    DailyCloseColumns& out,
+    std::string& error
 ) {
-    // Add a small delay to respect API rate limits
-    std::this_thread::sleep_for(std::chrono::milliseconds(250));
+    BS_TIMED_SCOPE(METRIC_JSON_PARSE);
+    out.days.clear();
+    out.adjusted_close.clear();
+    const std::size_t estimate = response.size() / BYTES_PER_DAILY_ENTRY + 1;
+    // 64-bit: the feed passes the full int32 range, whose width overflows int
+    const std::size_t span =
+        last_day >= first_day ? static_cast<std::size_t>(static_cast<std::int64_t>(last_day) - first_day + 1) : 0;
+    out.days.reserve(std::min(estimate, span));
+    out.adjusted_close.reserve(std::min(estimate, span));
 
+    DailyCloseSax handler(first_day, last_day, out);
+    const bool complete = nlohmann::json::sax_parse(response, &handler);
+    if (!complete && !handler.stoppedEarly()) {
+        error = handler.error().empty() ? "JSON parse stopped" : handler.error();
+        return false;
+    }
+    if (!handler.foundSeries()) {
+        error = handler.message().empty() ? "No historical data found" : handler.message();
+        return false;
+    }
+
+    // Responses list days newest first; callers get them ascending
+    if (out.days.size() > 1 && out.days.front() > out.days.back()) {
+        std::reverse(out.days.begin(), out.days.end());
+        std::reverse(out.adjusted_close.begin(), out.adjusted_close.end());
+    }
+    if (!std::is_sorted(out.days.begin(), out.days.end())) {
+        std::vector<std::size_t> order(out.days.size());
+        for (std::size_t i = 0; i < order.size(); ++i) order[i] = i;
+        std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) { return out.days[a] < out.days[b]; });
+        DailyCloseColumns sorted;
+        sorted.days.reserve(order.size());
+        sorted.adjusted_close.reserve(order.size());
+        for (std::size_t i : order) {
+            sorted.days.push_back(out.days[i]);
+            sorted.adjusted_close.push_back(out.adjusted_close[i]);
+        }
+        out = std::move(sorted);
+    }
+    return true;
+}
+
+// Get historical adjusted closes as columns
+bool AlphaVantageClient::getHistoricalCloses(
+    const std::string& symbol,
+    std::int32_t first_day,
+    std::int32_t last_day,
+    HistoryRange range,
+    DailyCloseColumns& out,
+    std::string* error
+) {
     // Construct URL for daily adjusted prices
     std::string url = base_url + 
         "?function=TIME_SERIES_DAILY_ADJUSTED" + 
         "&symbol=" + symbol + 
-        "&outputsize=full" +  // Full historical data
+        "&outputsize=" + (range == HISTORY_FULL ? "full" : "compact") + 
         "&apikey=" + api_key;
 
-    std::vector<std::pair<std::string, double>> historical_prices;
-
     try {
-        std::string response = performHttpGet(url);
-        
-        // Parse JSON response
-        auto json = nlohmann::json::parse(response);
-
-        // Check if time series data exists
-        if (!json.contains("Time Series (Daily)")) {
-            std::cerr << "No historical data found for " << symbol << std::endl;
-            return historical_prices;
-        }
-
-        // Iterate through time series
-        for (const auto& [date, price_data] : json["Time Series (Daily)"].items()) {
-            // Check date range
-            if (date >= start_date && date <= end_date) {
-                // Use adjusted close price
-                double adjusted_close = std::stod(price_data["5. adjusted close"].get<std::string>());
-                historical_prices.emplace_back(date, adjusted_close);
-            }
+        std::string parse_error;
+        if (!parseDailyCloses(performHttpGet(url), first_day, last_day, out, parse_error)) {
+            std::cerr << "No historical data found for " << symbol << ": " << parse_error << std::endl;
+            if (error) *error = "No historical data found for " + symbol + ": " + parse_error;
+            return false;
         }
-
-        return historical_prices;
+        return true;
     }
     catch (const std::exception& e) {
         std::cerr << "Error fetching historical prices for " << symbol << ": " << e.what() << std::endl;
-        return historical_prices;
+        if (error) *error = "Error fetching historical prices for " + symbol + ": " + e.what();
+        out.days.clear();
+        out.adjusted_close.clear();
+        return false;
+    }
+}
+
+// Get historical prices
+std::vector<std::pair<std::string, double>> AlphaVantageClient::getHistoricalPrices(
+    const std::string& symbol, 
+    const std::string& start_date, 
+    const std::string& end_date,
+    HistoryRange range
+) {
+    std::vector<std::pair<std::string, double>> historical_prices;
+
+    // Unparseable bounds fall back to the open range, as the old string comparison would
+    std::int32_t first_day = std::numeric_limits<std::int32_t>::min();
+    std::int32_t last_day = std::numeric_limits<std::int32_t>::max();
+    CalendarDate::parseIso(start_date.data(), start_date.size(), first_day);
+    CalendarDate::parseIso(end_date.data(), end_date.size(), last_day);
+
+    DailyCloseColumns closes;
+    if (!getHistoricalCloses(symbol, first_day, last_day, range, closes)) return historical_prices;
+    historical_prices.reserve(closes.days.size());
+    for (std::size_t i = 0; i < closes.days.size(); ++i) {
+        historical_prices.emplace_back(CalendarDate::toIso(closes.days[i]), closes.adjusted_close[i]);
     }
+    return historical_prices;
 }
 
 // Get implied volatility (Note: Alpha Vantage doesn't directly provide this)
@@ -1,28 +1,112 @@
 #include "alpha_vantage_feed.h"
+#include "calendar_date.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
-AlphaVantageFeed::AlphaVantageFeed(const std::string& api_key) : client_(api_key) {
+namespace {
+// outputsize=compact returns the last 100 trading days, about 140 calendar days
+constexpr std::int32_t COMPACT_REFRESH_MAX_GAP_DAYS = 120;
+constexpr double ADJUSTMENT_TOLERANCE = 1e-6;  // relative change that signals re-adjusted history
+constexpr std::int32_t EARLIEST_DAY = std::numeric_limits<std::int32_t>::min();
+constexpr std::int32_t LATEST_DAY = std::numeric_limits<std::int32_t>::max();
+}
+
+AlphaVantageFeed::AlphaVantageFeed(const std::string& api_key, double requests_per_minute,
+                                   const std::string& cache_directory)
+    : client_(api_key, requests_per_minute),
+      store_(cache_directory.empty() ? nullptr : std::make_unique<PriceStore>(cache_directory)) {
     last_error_.clear();
 }
 
 OptionalDouble AlphaVantageFeed::getCurrentPrice(const std::string& symbol) const {
     last_error_.clear();
     try {
-        return client_.getCurrentPrice(symbol);
+        OptionalDouble price = client_.getCurrentPrice(symbol);
+        if (price) recordQuote(symbol);
+        return price;
     } catch (const std::exception& e) {
         last_error_ = e.what();
         return OptionalDouble();
     }
 }
 
+std::vector<OptionalDouble> AlphaVantageFeed::getCurrentPrices(const std::vector<std::string>& symbols) const {
+    last_error_.clear();
+    std::vector<OptionalDouble> prices;
+    prices.reserve(symbols.size());
+    try {
+        auto pending = client_.getCurrentPrices(symbols);
+        for (auto& price : pending) prices.push_back(price.get());
+    } catch (const std::exception& e) {
+        last_error_ = e.what();
+        prices.resize(symbols.size());
+    }
+    for (std::size_t i = 0; i < prices.size(); ++i)
+        if (prices[i]) recordQuote(symbols[i]);
+    return prices;
+}
+
+void AlphaVantageFeed::recordQuote(const std::string& symbol) const {
+    std::lock_guard<std::mutex> lock(quote_times_mutex_);
+    quote_times_[symbol] = std::chrono::steady_clock::now();
+}
+
+bool AlphaVantageFeed::isStaleQuote(const std::string& symbol, int max_age_seconds) const {
+    std::lock_guard<std::mutex> lock(quote_times_mutex_);
+    auto it = quote_times_.find(symbol);
+    if (it == quote_times_.end()) return true;
+    return std::chrono::steady_clock::now() - it->second > std::chrono::seconds(max_age_seconds);
+}
+
 bool AlphaVantageFeed::fetchHistoricalPrices(const std::string& symbol, const std::string& start_date, const std::string& end_date) {
     last_error_.clear();
     try {
-        auto pairs = client_.getHistoricalPrices(symbol, start_date, end_date);
-        if (pairs.empty()) return false;
-        std::vector<StockPrice> out;
-        for (const auto& p : pairs)
-            out.push_back({p.second, p.first});
-        historical_cache_[symbol] = std::move(out);
+        const std::int32_t first = CalendarDate::fromIso(start_date);
+        const std::int32_t last = CalendarDate::fromIso(end_date);
+        if (!store_) {
+            DailyCloseColumns closes;
+            if (!client_.getHistoricalCloses(symbol, first, last, HISTORY_FULL, closes, &last_error_)) return false;
+            if (closes.days.empty()) {
+                last_error_ = "No daily history for " + symbol + " between " + start_date + " and " + end_date;
+                return false;
+            }
+            CachedHistory& cached = historical_cache_[symbol];
+            cached.mapped = MappedPriceSeries();
+            cached.owned = PriceSeries(std::move(closes.days));
+            cached.owned.setColumn(FIELD_ADJUSTED_CLOSE, std::move(closes.adjusted_close));
+            cached.view = cached.owned.view();
+            return true;
+        }
+
+        const std::int32_t today = CalendarDate::today();
+
+        MappedPriceSeries stored;
+        store_->load(symbol, stored);
+        const bool covered = !stored.empty() && stored.days()[stored.size() - 1] >= last;
+        if (stored.refreshedDay() < today && !covered) {
+            try {
+                if (refreshStore(symbol, stored, today)) store_->load(symbol, stored);
+            } catch (const std::exception& e) {
+                // Keep serving what is on disk; the caller can still see why the refresh failed
+                last_error_ = e.what();
+            }
+        }
+        if (stored.empty()) {
+            if (last_error_.empty()) last_error_ = "No daily history cached or downloaded for " + symbol;
+            return false;
+        }
+
+        // Serve straight from the mapping: no copy of the columns
+        const PriceSeriesView range = stored.view().between(first, last);
+        if (range.empty()) {
+            last_error_ = "No daily history for " + symbol + " between " + start_date + " and " + end_date;
+            return false;
+        }
+        CachedHistory& cached = historical_cache_[symbol];
+        cached.owned = PriceSeries();
+        cached.mapped = std::move(stored);
+        cached.view = range;
         return true;
     } catch (const std::exception& e) {
         last_error_ = e.what();
@@ -30,9 +114,55 @@ bool AlphaVantageFeed::fetchHistoricalPrices(const std::string& symbol, const st
     }
 }
 
-std::vector<StockPrice> AlphaVantageFeed::getHistoricalPrices(const std::string& symbol) const {
+bool AlphaVantageFeed::refreshStore(const std::string& symbol, const MappedPriceSeries& stored, std::int32_t today) {
+    const std::size_t n = stored.size();
+    bool compact = n > 0 && today - stored.days()[n - 1] <= COMPACT_REFRESH_MAX_GAP_DAYS;
+
+    for (;;) {
+        DailyCloseColumns fetched;
+        if (!client_.getHistoricalCloses(symbol, EARLIEST_DAY, LATEST_DAY,
+                                         compact ? HISTORY_COMPACT : HISTORY_FULL, fetched, &last_error_)) {
+            return false;
+        }
+        if (fetched.days.empty()) {
+            last_error_ = "Alpha Vantage returned no daily history for " + symbol;
+            return false;
+        }
+
+        std::vector<std::int32_t> days;
+        std::vector<double> closes;
+        if (compact) {
+            days.assign(stored.days(), stored.days() + n);
+            closes.assign(stored.adjustedClose(), stored.adjustedClose() + n);
+        }
+
+        bool readjusted = false;
+        for (std::size_t i = 0; i < fetched.days.size(); ++i) {
+            const std::int32_t day = fetched.days[i];
+            const double close = fetched.adjusted_close[i];
+            if (!days.empty() && day <= days.back()) {
+                // Overlap with stored history: adjusted closes only change when it was re-adjusted
+                const std::int32_t* hit = std::lower_bound(days.data(), days.data() + days.size(), day);
+                const double old = closes[static_cast<std::size_t>(hit - days.data())];
+                if (*hit == day && std::fabs(close - old) > ADJUSTMENT_TOLERANCE * std::fabs(old)) readjusted = true;
+                continue;
+            }
+            days.push_back(day);
+            closes.push_back(close);
+        }
+
+        if (compact && readjusted) {
+            compact = false;  // appended days would not line up with the old adjustment; start over
+            continue;
+        }
+        store_->write(symbol, days.data(), closes.data(), days.size(), today);
+        return true;
+    }
+}
+
+PriceSeriesView AlphaVantageFeed::getHistoricalPrices(const std::string& symbol) const {
     auto it = historical_cache_.find(symbol);
     if (it != historical_cache_.end())
-        return it->second;
+        return it->second.view;
     return {};
 }
@@ -0,0 +1,183 @@
+#include "../include/backtest.h"
+#include "../include/black_scholes.h"
+#include "../include/paper_feed.h"
+#include "../include/paper_trading.h"
+#include "../include/price_store.h"
+#include "../include/thread_pool.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+constexpr double SECONDS_PER_YEAR = 365.25 * 24 * 60 * 60;
+constexpr std::time_t SECONDS_PER_DAY = 24 * 60 * 60;
+}
+
+// ---------------------------------------------------------------------------------------------
+
+BacktestData BacktestData::fromStore(const PriceStore& store, const std::vector<std::string>& symbols,
+                                     std::int32_t first_day, std::int32_t last_day) {
+    std::vector<MappedPriceSeries> mapped(symbols.size());
+    std::vector<PriceSeriesView> views;
+    views.reserve(symbols.size());
+    for (std::size_t s = 0; s < symbols.size(); ++s) {
+        if (!store.load(symbols[s], mapped[s])) {
+            throw std::runtime_error("Backtest: no cached prices for " + symbols[s] + " in " + store.directory());
+        }
+        views.push_back(mapped[s].view());
+    }
+    return fromSeries(symbols, views, first_day, last_day);
+}
+
+BacktestData BacktestData::fromSeries(const std::vector<std::string>& symbols,
+                                      const std::vector<PriceSeriesView>& series, std::int32_t first_day,
+                                      std::int32_t last_day) {
+    if (symbols.size() != series.size()) throw std::invalid_argument("Backtest: one series per symbol");
+    BacktestData data;
+    data.symbols_ = symbols;
+
+    // Calendar: every day in range on which any symbol has a close
+    std::vector<PriceSeriesView> in_range(series.size());
+    for (std::size_t s = 0; s < series.size(); ++s) {
+        if (!series[s].prices()) throw std::invalid_argument("Backtest: no close column for " + symbols[s]);
+        in_range[s] = series[s].between(first_day, last_day);
+        data.days_.insert(data.days_.end(), in_range[s].days, in_range[s].days + in_range[s].size);
+    }
+    std::sort(data.days_.begin(), data.days_.end());
+    data.days_.erase(std::unique(data.days_.begin(), data.days_.end()), data.days_.end());
+
+    // Closes per symbol on that calendar, the last close carried over days it has none
+    const std::size_t day_count = data.days_.size();
+    data.closes_.assign(series.size() * day_count, std::numeric_limits<double>::quiet_NaN());
+    for (std::size_t s = 0; s < series.size(); ++s) {
+        const PriceSeriesView& view = in_range[s];
+        const double* prices = view.prices();
+        double* out = data.closes_.data() + s * day_count;
+        double last = std::numeric_limits<double>::quiet_NaN();
+        for (std::size_t d = 0, i = 0; d < day_count; ++d) {
+            if (i < view.size && view.days[i] == data.days_[d]) last = prices[i++];
+            out[d] = last;
+        }
+    }
+    return data;
+}
+
+// ---------------------------------------------------------------------------------------------
+
+void BacktestJournal::reserve(std::size_t days) {
+    day.reserve(days);
+    cash.reserve(days);
+    position_value.reserve(days);
+    equity.reserve(days);
+    pnl.reserve(days);
+    open_positions.reserve(days);
+    trades.reserve(days);
+}
+
+// ---------------------------------------------------------------------------------------------
+
+std::int32_t BacktestContext::day() const {
+    return data_.days()[day_index_];
+}
+
+std::size_t BacktestContext::symbolCount() const {
+    return data_.symbolCount();
+}
+
+const std::string& BacktestContext::symbol(std::size_t s) const {
+    return data_.symbol(s);
+}
+
+const double* BacktestContext::closes(std::size_t s) const {
+    return data_.closes(s);
+}
+
+double BacktestContext::fairValue(std::size_t s, OptionType type, double strike, std::time_t expiry) const {
+    const double S = spot(s);
+    if (!(S > 0) || !(strike > 0)) return std::numeric_limits<double>::quiet_NaN();
+    const double T = std::max(0.0, std::difftime(expiry, now_) / SECONDS_PER_YEAR);
+    return type == CALL ? BlackScholes::calculateCallPrice(S, strike, config_.risk_free_rate, config_.volatility, T)
+                        : BlackScholes::calculatePutPrice(S, strike, config_.risk_free_rate, config_.volatility, T);
+}
+
+bool BacktestContext::buy(std::size_t s, OptionType type, double strike, std::time_t expiry, int quantity) {
+    const double price = fairValue(s, type, strike, expiry);
+    if (std::isnan(price)) return false;
+    Option option(symbol(s), type, strike, expiry);
+    option.setCurrentPrice(price);
+    if (!system_.buyOption(option, quantity)) return false;
+    ++trades_;
+    return true;
+}
+
+bool BacktestContext::sell(std::size_t s, OptionType type, double strike, std::time_t expiry, int quantity) {
+    const double price = fairValue(s, type, strike, expiry);
+    if (std::isnan(price)) return false;
+    Option option(symbol(s), type, strike, expiry);
+    option.setCurrentPrice(price);
+    if (!system_.sellOption(option, quantity)) return false;
+    ++trades_;
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------------
+
+BacktestResult BacktestEngine::run(const BacktestData& data, BacktestStrategy& strategy,
+                                   const BacktestConfig& config) {
+    PaperTradingSystem system(config.initial_balance, std::make_unique<PaperFeed>());
+    system.setConsoleLogging(false);
+    BacktestContext context(data, config, system);
+    system.setClock([&context] { return context.now_; });
+    MarketDataProvider& market_data = system.getMarketData();
+
+    BacktestResult result;
+    BacktestJournal& journal = result.journal;
+    journal.reserve(data.dayCount());
+    double previous_equity = config.initial_balance;
+    double peak = config.initial_balance;
+    for (std::size_t d = 0; d < data.dayCount(); ++d) {
+        context.day_index_ = d;
+        context.now_ = static_cast<std::time_t>(data.days()[d]) * SECONDS_PER_DAY + config.close_time_seconds;
+        context.trades_ = 0;
+
+        for (std::size_t s = 0; s < data.symbolCount(); ++s) {
+            const double close = data.closes(s)[d];
+            if (close > 0) market_data.setCurrentPrice(data.symbol(s), close);
+        }
+        // Every position ages a day, so the whole book is repriced, not just moved underlyings
+        system.updateOptionPricesFromMarket(config.risk_free_rate, config.volatility);
+        system.closeExpiredPositions();
+        strategy.onDay(context);
+        system.repriceDirtyPositions(config.risk_free_rate, config.volatility);
+
+        const double equity = system.calculatePortfolioValue();
+        const double cash = system.getCashBalance();
+        journal.day.push_back(data.days()[d]);
+        journal.cash.push_back(cash);
+        journal.position_value.push_back(equity - cash);
+        journal.equity.push_back(equity);
+        journal.pnl.push_back(equity - previous_equity);
+        journal.open_positions.push_back(static_cast<std::uint32_t>(system.getPositions().size()));
+        journal.trades.push_back(context.trades_);
+
+        previous_equity = equity;
+        peak = std::max(peak, equity);
+        if (peak > 0) result.max_drawdown = std::max(result.max_drawdown, (peak - equity) / peak);
+        result.trades += context.trades_;
+    }
+    result.final_equity = previous_equity;
+    result.total_return = config.initial_balance > 0 ? previous_equity / config.initial_balance - 1.0 : 0.0;
+    return result;
+}
+
+std::vector<BacktestResult> BacktestEngine::sweep(const BacktestData& data, std::size_t runs,
+                                                  const StrategyFactory& factory, const BacktestConfig& config) {
+    std::vector<BacktestResult> results(runs);
+    TaskExecutor& executor = config.executor ? *config.executor : TaskExecutor::shared();
+    executor.parallelFor(runs, [&](std::size_t i) {
+        const std::unique_ptr<BacktestStrategy> strategy = factory(i);
+        results[i] = run(data, *strategy, config);
+    });
+    return results;
+}
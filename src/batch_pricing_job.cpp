@@ -0,0 +1,559 @@
+#include "../include/batch_pricing_job.h"
+#include "../include/black_scholes_greeks.h"
+#include "../include/thread_pool.h"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <system_error>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define BS_BATCH_JOB_MMAP 1
+#endif
+
+namespace {
+constexpr char CONTRACT_MAGIC[4] = {'B', 'S', 'C', 'T'};
+constexpr char RESULT_MAGIC[4] = {'B', 'S', 'R', 'S'};
+constexpr std::uint32_t FILE_VERSION = 1;
+constexpr std::uint32_t FLAG_MARKET_PRICE = 1u << 0;  // contract file: market_price column present
+constexpr std::uint32_t FLAG_IMPLIED_VOL = 1u << 0;   // result file: implied_vol / iv_status present
+
+constexpr std::size_t CSV_BYTES_PER_LINE = 48;  // typical contract line, to cut CSV input into blocks
+constexpr std::size_t BLOCKS_PER_WORKER = 2;    // blocks per wave, so a slow block doesn't idle the rest
+constexpr std::size_t MAX_CSV_FIELD = 32;       // longest to_chars output at <= 17 digits, plus comma
+constexpr std::size_t MAX_CSV_ROW = 10 * MAX_CSV_FIELD;
+constexpr std::size_t CONTRACT_DOUBLE_COLUMNS = 5;  // spot, strike, rate, volatility, time_to_expiry
+constexpr std::size_t RESULT_DOUBLE_COLUMNS = 6;    // price, delta, gamma, theta, vega, rho
+
+struct FileHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint64_t count;     // contracts; 0 in result files (each block record carries its own)
+    std::uint32_t flags;
+    std::uint32_t reserved0;
+    std::uint64_t reserved1;
+};
+static_assert(sizeof(FileHeader) == 32, "batch file header must stay 32 bytes");
+
+std::size_t padded8(std::size_t bytes) {
+    return (bytes + 7) / 8 * 8;
+}
+
+std::size_t contractFileBytes(std::size_t count, bool market_price) {
+    return sizeof(FileHeader) + count * sizeof(double) * (CONTRACT_DOUBLE_COLUMNS + (market_price ? 1 : 0)) + count;
+}
+
+// Read-only view of a whole file: memory-mapped where available, else read into memory
+class InputFile {
+public:
+    explicit InputFile(const std::string& path) {
+#ifdef BS_BATCH_JOB_MMAP
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error("BatchPricingJob: cannot open " + path);
+        struct stat info;
+        if (::fstat(fd, &info) != 0) {
+            ::close(fd);
+            throw std::runtime_error("BatchPricingJob: cannot stat " + path);
+        }
+        size_ = static_cast<std::size_t>(info.st_size);
+        if (size_ > 0) {
+            mapping_ = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping_ == MAP_FAILED) {
+                mapping_ = nullptr;
+                ::close(fd);
+                throw std::runtime_error("BatchPricingJob: cannot map " + path);
+            }
+            ::madvise(mapping_, size_, MADV_SEQUENTIAL);
+            data_ = static_cast<const char*>(mapping_);
+        }
+        ::close(fd);  // the mapping keeps the file alive
+#else
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file) throw std::runtime_error("BatchPricingJob: cannot open " + path);
+        size_ = static_cast<std::size_t>(file.tellg());
+        buffer_.resize(size_);
+        file.seekg(0);
+        if (!file.read(buffer_.data(), static_cast<std::streamsize>(size_))) {
+            throw std::runtime_error("BatchPricingJob: cannot read " + path);
+        }
+        data_ = buffer_.data();
+#endif
+    }
+
+    ~InputFile() {
+#ifdef BS_BATCH_JOB_MMAP
+        if (mapping_) ::munmap(mapping_, size_);
+#endif
+    }
+
+    InputFile(const InputFile&) = delete;
+    InputFile& operator=(const InputFile&) = delete;
+
+    const char* data() const { return data_; }
+    std::size_t size() const { return size_; }
+
+private:
+    void* mapping_{nullptr};
+    std::vector<char> buffer_;
+    const char* data_{""};
+    std::size_t size_{0};
+};
+
+// stdout or a file opened for writing; write() and close() throw on failure
+class OutputFile {
+public:
+    explicit OutputFile(const std::string& path) : path_(path.empty() || path == "-" ? "stdout" : path) {
+        if (path.empty() || path == "-") {
+            file_ = stdout;
+        } else {
+            file_ = std::fopen(path.c_str(), "wb");
+            if (!file_) throw std::runtime_error("BatchPricingJob: cannot create " + path);
+            owned_ = true;
+        }
+    }
+
+    ~OutputFile() {
+        if (owned_) std::fclose(file_);
+    }
+
+    OutputFile(const OutputFile&) = delete;
+    OutputFile& operator=(const OutputFile&) = delete;
+
+    void write(const void* data, std::size_t bytes) {
+        if (bytes && std::fwrite(data, 1, bytes, file_) != bytes) {
+            throw std::runtime_error("BatchPricingJob: failed to write " + path_);
+        }
+    }
+
+    void close() {
+        const bool failed = owned_ ? std::fclose(file_) != 0 : std::fflush(file_) != 0;
+        owned_ = false;
+        if (failed) throw std::runtime_error("BatchPricingJob: failed to write " + path_);
+    }
+
+private:
+    std::string path_;
+    std::FILE* file_{nullptr};
+    bool owned_{false};
+};
+
+// Contracts of one block as the kernels take them
+struct ContractColumns {
+    const double* spot;
+    const double* strike;
+    const double* rate;
+    const double* volatility;
+    const double* time_to_expiry;
+    const double* market_price;  // nullptr unless solving IV
+    const OptionType* type;
+    std::size_t size;
+};
+
+// Per-task workspace, reused wave after wave
+struct Block {
+    // CSV input is parsed into these; binary input is read in place except for the type column
+    std::vector<double> spot, strike, rate, volatility, time_to_expiry, market_price;
+    std::vector<OptionType> type;
+
+    // Both sides from the Greeks kernel; the contract's own side is then gathered into call_*
+    std::vector<double> call_price, put_price, call_delta, put_delta, gamma;
+    std::vector<double> call_theta, put_theta, vega, call_rho, put_rho, implied_vol;
+    std::vector<std::uint8_t> status, iv_status;
+
+    std::vector<char> output;  // formatted block, output[0..output_size)
+    std::size_t output_size{0};
+    std::size_t contracts{0};
+    std::size_t invalid{0};
+    std::size_t iv_unsolved{0};
+
+    void resizeResults(std::size_t n) {
+        for (auto* column : {&call_price, &put_price, &call_delta, &put_delta, &gamma, &call_theta, &put_theta,
+                             &vega, &call_rho, &put_rho, &implied_vol}) {
+            if (column->size() < n) column->resize(n);
+        }
+        if (status.size() < n) status.resize(n);
+        if (iv_status.size() < n) iv_status.resize(n);
+    }
+
+    char* reserveOutput(std::size_t bytes) {
+        if (output.size() < bytes) output.resize(bytes);
+        return output.data();
+    }
+};
+
+const char* skipBlanks(const char* first, const char* last) {
+    while (first != last && (*first == ' ' || *first == '\t')) ++first;
+    return first;
+}
+
+const char* trimBlanks(const char* first, const char* last) {
+    while (last != first && (last[-1] == ' ' || last[-1] == '\t' || last[-1] == '\r')) --last;
+    return last;
+}
+
+// Empty fields parse as NaN, so the lane is reported invalid instead of failing the file
+bool parseNumber(const char* first, const char* last, double& value) {
+    first = skipBlanks(first, last);
+    last = trimBlanks(first, last);
+    if (first == last) {
+        value = std::numeric_limits<double>::quiet_NaN();
+        return true;
+    }
+    if (*first == '+') ++first;
+    const auto result = std::from_chars(first, last, value);
+    return result.ec == std::errc() && result.ptr == last;
+}
+
+bool parseType(const char* first, const char* last, OptionType& type) {
+    first = skipBlanks(first, last);
+    last = trimBlanks(first, last);
+    const auto matches = [&](const char* word) {
+        const std::size_t length = std::strlen(word);
+        if (static_cast<std::size_t>(last - first) != length) return false;
+        for (std::size_t i = 0; i < length; ++i) {
+            if ((first[i] | 0x20) != word[i]) return false;
+        }
+        return true;
+    };
+    if (matches("c") || matches("call")) {
+        type = CALL;
+        return true;
+    }
+    if (matches("p") || matches("put")) {
+        type = PUT;
+        return true;
+    }
+    return false;
+}
+
+[[noreturn]] void throwParseError(const char* file_data, const char* where, const char* message) {
+    const std::size_t line = 1 + static_cast<std::size_t>(std::count(file_data, where, '\n'));
+    throw std::runtime_error("BatchPricingJob: line " + std::to_string(line) + ": " + message);
+}
+
+// Parse the lines of [first, last) into block; first is at a line start
+void parseCsv(const char* file_data, const char* first, const char* last, bool may_have_header,
+              bool need_market_price, Block& block) {
+    block.contracts = 0;
+    std::size_t capacity = block.spot.size();  // every input column has this size
+    double* columns[6] = {block.spot.data(), block.strike.data(), block.rate.data(), block.volatility.data(),
+                          block.time_to_expiry.data(), block.market_price.data()};
+    for (const char* line = first; line < last;) {
+        const char* line_end = static_cast<const char*>(std::memchr(line, '\n', static_cast<std::size_t>(last - line)));
+        if (!line_end) line_end = last;
+        const char* next = line_end == last ? last : line_end + 1;
+        if (skipBlanks(line, trimBlanks(line, line_end)) == trimBlanks(line, line_end)) {
+            line = next;
+            continue;
+        }
+
+        const char* fields[8];
+        std::size_t field_count = 0;
+        fields[field_count++] = line;
+        for (const char* p = line; p < line_end && field_count < 8; ++p) {
+            if (*p == ',') fields[field_count++] = p + 1;
+        }
+        const auto fieldEnd = [&](std::size_t f) { return f + 1 < field_count ? fields[f + 1] - 1 : line_end; };
+
+        OptionType type = CALL;
+        if (!parseType(fields[0], fieldEnd(0), type)) {
+            if (may_have_header) {
+                may_have_header = false;
+                line = next;
+                continue;
+            }
+            throwParseError(file_data, line, "option type must be C, P, call or put");
+        }
+        may_have_header = false;
+        if (field_count < 6 || field_count > 7) {
+            throwParseError(file_data, line, "expected type,spot,strike,rate,volatility,time_to_expiry[,market_price]");
+        }
+        if (need_market_price && field_count < 7) {
+            throwParseError(file_data, line, "implied volatility needs a market_price column");
+        }
+
+        if (block.contracts == capacity) {
+            capacity = std::max<std::size_t>(2 * capacity, 1024);
+            for (auto* column : {&block.spot, &block.strike, &block.rate, &block.volatility, &block.time_to_expiry,
+                                 &block.market_price}) {
+                if (column->size() < capacity) column->resize(capacity);
+            }
+            if (block.type.size() < capacity) block.type.resize(capacity);
+            columns[0] = block.spot.data();
+            columns[1] = block.strike.data();
+            columns[2] = block.rate.data();
+            columns[3] = block.volatility.data();
+            columns[4] = block.time_to_expiry.data();
+            columns[5] = block.market_price.data();
+        }
+
+        const std::size_t i = block.contracts;
+        block.type[i] = type;
+        columns[5][i] = std::numeric_limits<double>::quiet_NaN();
+        for (std::size_t f = 1; f < field_count; ++f) {
+            if (!parseNumber(fields[f], fieldEnd(f), columns[f - 1][i])) {
+                throwParseError(file_data, line, "malformed number");
+            }
+        }
+        ++block.contracts;
+        line = next;
+    }
+}
+
+// Solve (optionally), price and take the contract's own side; results land in block.call_*
+void priceBlock(const ContractColumns& contracts, Block& block) {
+    const std::size_t n = contracts.size;
+    block.resizeResults(n);
+    block.contracts = n;
+    block.iv_unsolved = 0;
+
+    const double* volatility = contracts.volatility;
+    if (contracts.market_price) {
+        const ImpliedVolChainView chain{contracts.market_price, contracts.spot, contracts.strike, contracts.rate,
+                                        contracts.time_to_expiry, contracts.type, n};
+        block.iv_unsolved = BlackScholesBatch::impliedVolatility(chain, block.implied_vol.data(), nullptr,
+                                                                 block.iv_status.data());
+        volatility = block.implied_vol.data();
+    }
+
+    const OptionChainView chain{contracts.spot, contracts.strike, contracts.rate, volatility,
+                                contracts.time_to_expiry, contracts.type, n};
+    GreeksBatchOutput out;
+    out.call_price = block.call_price.data();
+    out.put_price = block.put_price.data();
+    out.call_delta = block.call_delta.data();
+    out.put_delta = block.put_delta.data();
+    out.gamma = block.gamma.data();
+    out.call_theta = block.call_theta.data();
+    out.put_theta = block.put_theta.data();
+    out.vega = block.vega.data();
+    out.call_rho = block.call_rho.data();
+    out.put_rho = block.put_rho.data();
+    block.invalid = BlackScholesGreeks::calculateAllBatch<OUTPUT_ALL>(chain, out, block.status.data());
+
+    const OptionType* type = contracts.type;
+    double* price = block.call_price.data();
+    double* delta = block.call_delta.data();
+    double* theta = block.call_theta.data();
+    double* rho = block.call_rho.data();
+    const double* put_price = block.put_price.data();
+    const double* put_delta = block.put_delta.data();
+    const double* put_theta = block.put_theta.data();
+    const double* put_rho = block.put_rho.data();
+    for (std::size_t i = 0; i < n; ++i) {
+        const bool put = type[i] == PUT;
+        price[i] = put ? put_price[i] : price[i];
+        delta[i] = put ? put_delta[i] : delta[i];
+        theta[i] = put ? put_theta[i] : theta[i];
+        rho[i] = put ? put_rho[i] : rho[i];
+    }
+}
+
+char* putDouble(char* out, double value, int precision) {
+    return std::to_chars(out, out + MAX_CSV_FIELD, value, std::chars_format::general, precision).ptr;
+}
+
+char* putInt(char* out, unsigned value) {
+    return std::to_chars(out, out + MAX_CSV_FIELD, value).ptr;
+}
+
+void formatCsv(Block& block, bool implied_volatility, int precision) {
+    const std::size_t n = block.contracts;
+    char* const begin = block.reserveOutput(n * MAX_CSV_ROW);
+    char* out = begin;
+    const double* columns[] = {block.call_price.data(), block.call_delta.data(), block.gamma.data(),
+                               block.call_theta.data(), block.vega.data(), block.call_rho.data()};
+    for (std::size_t i = 0; i < n; ++i) {
+        for (const double* column : columns) {
+            out = putDouble(out, column[i], precision);
+            *out++ = ',';
+        }
+        if (implied_volatility) {
+            out = putDouble(out, block.implied_vol[i], precision);
+            *out++ = ',';
+            out = putInt(out, block.iv_status[i]);
+            *out++ = ',';
+        }
+        out = putInt(out, block.status[i]);
+        *out++ = '\n';
+    }
+    block.output_size = static_cast<std::size_t>(out - begin);
+}
+
+void formatBinary(Block& block, bool implied_volatility) {
+    const std::size_t n = block.contracts;
+    const std::size_t doubles = RESULT_DOUBLE_COLUMNS + (implied_volatility ? 1 : 0);
+    const std::size_t bytes = sizeof(std::uint64_t) + n * sizeof(double) * doubles +
+                              padded8(n) * (implied_volatility ? 2 : 1);
+    char* out = block.reserveOutput(bytes);
+    std::memset(out, 0, bytes);
+
+    const std::uint64_t count = n;
+    std::memcpy(out, &count, sizeof(count));
+    out += sizeof(count);
+    const double* columns[] = {block.call_price.data(), block.call_delta.data(), block.gamma.data(),
+                               block.call_theta.data(), block.vega.data(), block.call_rho.data(),
+                               block.implied_vol.data()};
+    for (std::size_t c = 0; c < doubles; ++c) {
+        std::memcpy(out, columns[c], n * sizeof(double));
+        out += n * sizeof(double);
+    }
+    std::memcpy(out, block.status.data(), n);
+    if (implied_volatility) std::memcpy(out + padded8(n), block.iv_status.data(), n);
+    block.output_size = bytes;
+}
+
+void writeColumn(std::ofstream& file, const void* data, std::size_t bytes) {
+    file.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+}
+}
+
+BatchPricingStats BatchPricingJob::run(const std::string& input_path, const std::string& output_path,
+                                       const BatchPricingConfig& config) {
+    const auto started = std::chrono::steady_clock::now();
+    const InputFile input(input_path);
+    const char* data = input.data();
+    const std::size_t block_size = std::max<std::size_t>(config.block_size, 1);
+    const int precision = std::min(std::max(config.csv_precision, 1), 17);
+
+    // Input blocks: contract ranges of a binary file, or byte ranges of CSV cut after a newline
+    const bool binary = input.size() >= sizeof(CONTRACT_MAGIC) &&
+                        std::memcmp(data, CONTRACT_MAGIC, sizeof(CONTRACT_MAGIC)) == 0;
+    std::vector<std::pair<std::size_t, std::size_t>> ranges;
+    FileHeader header{};
+    std::size_t csv_start = 0;
+    if (binary) {
+        if (input.size() < sizeof(FileHeader)) throw std::runtime_error("BatchPricingJob: truncated " + input_path);
+        std::memcpy(&header, data, sizeof(header));
+        const bool has_market = (header.flags & FLAG_MARKET_PRICE) != 0;
+        if (header.version != FILE_VERSION ||
+            input.size() != contractFileBytes(static_cast<std::size_t>(header.count), has_market)) {
+            throw std::runtime_error("BatchPricingJob: not a valid contract file: " + input_path);
+        }
+        if (config.implied_volatility && !has_market) {
+            throw std::runtime_error("BatchPricingJob: implied volatility needs market prices in " + input_path);
+        }
+        for (std::size_t first = 0; first < header.count; first += block_size) {
+            ranges.emplace_back(first, std::min<std::size_t>(first + block_size, header.count));
+        }
+    } else {
+        if (input.size() >= 3 && std::memcmp(data, "\xEF\xBB\xBF", 3) == 0) csv_start = 3;  // UTF-8 BOM
+        const std::size_t target = block_size * CSV_BYTES_PER_LINE;
+        for (std::size_t begin = csv_start; begin < input.size();) {
+            std::size_t end = begin + target;
+            if (end >= input.size()) {
+                end = input.size();
+            } else {
+                const void* newline = std::memchr(data + end, '\n', input.size() - end);
+                end = newline ? static_cast<std::size_t>(static_cast<const char*>(newline) - data) + 1 : input.size();
+            }
+            ranges.emplace_back(begin, end);
+            begin = end;
+        }
+    }
+
+    OutputFile output(output_path);
+    if (config.output_format == BATCH_BINARY) {
+        FileHeader result{};
+        std::memcpy(result.magic, RESULT_MAGIC, sizeof(RESULT_MAGIC));
+        result.version = FILE_VERSION;
+        result.flags = config.implied_volatility ? FLAG_IMPLIED_VOL : 0;
+        output.write(&result, sizeof(result));
+    } else {
+        const std::string columns = config.implied_volatility
+            ? "price,delta,gamma,theta,vega,rho,implied_vol,iv_status,status\n"
+            : "price,delta,gamma,theta,vega,rho,status\n";
+        output.write(columns.data(), columns.size());
+    }
+
+    const std::size_t count = binary ? static_cast<std::size_t>(header.count) : 0;
+    const bool has_market = binary && (header.flags & FLAG_MARKET_PRICE) != 0;
+    const double* column_base = reinterpret_cast<const double*>(data + sizeof(FileHeader));
+    const auto contractColumn = [&](std::size_t c) { return column_base + c * count; };
+    const std::uint8_t* type_column = reinterpret_cast<const std::uint8_t*>(
+        data + sizeof(FileHeader) + count * sizeof(double) * (CONTRACT_DOUBLE_COLUMNS + (has_market ? 1 : 0)));
+
+    const auto processBlock = [&](std::size_t r, Block& block) {
+        const std::size_t first = ranges[r].first;
+        const std::size_t last = ranges[r].second;
+        ContractColumns contracts;
+        if (binary) {
+            const std::size_t n = last - first;
+            if (block.type.size() < n) block.type.resize(n);
+            for (std::size_t i = 0; i < n; ++i) block.type[i] = type_column[first + i] ? PUT : CALL;
+            contracts = {contractColumn(0) + first, contractColumn(1) + first, contractColumn(2) + first,
+                         contractColumn(3) + first, contractColumn(4) + first,
+                         config.implied_volatility ? contractColumn(5) + first : nullptr, block.type.data(), n};
+        } else {
+            parseCsv(data, data + first, data + last, first == csv_start, config.implied_volatility, block);
+            contracts = {block.spot.data(), block.strike.data(), block.rate.data(), block.volatility.data(),
+                         block.time_to_expiry.data(),
+                         config.implied_volatility ? block.market_price.data() : nullptr, block.type.data(),
+                         block.contracts};
+        }
+        priceBlock(contracts, block);
+        if (config.output_format == BATCH_BINARY) {
+            formatBinary(block, config.implied_volatility);
+        } else {
+            formatCsv(block, config.implied_volatility, precision);
+        }
+    };
+
+    // A wave at a time: blocks in parallel, then their buffers written in input order
+    TaskExecutor& executor = config.executor ? *config.executor : TaskExecutor::shared();
+    const std::size_t wave = std::max<std::size_t>(executor.threadCount(), 1) * BLOCKS_PER_WORKER;
+    std::vector<Block> blocks(std::min(wave, ranges.size()));
+    BatchPricingStats stats;
+    for (std::size_t first = 0; first < ranges.size(); first += wave) {
+        const std::size_t blocks_in_wave = std::min(wave, ranges.size() - first);
+        executor.parallelFor(blocks_in_wave, [&](std::size_t i) { processBlock(first + i, blocks[i]); });
+        for (std::size_t i = 0; i < blocks_in_wave; ++i) {
+            const Block& block = blocks[i];
+            if (config.output_format == BATCH_BINARY && block.contracts == 0) continue;
+            output.write(block.output.data(), block.output_size);
+            stats.contracts += block.contracts;
+            stats.invalid += block.invalid;
+            stats.iv_unsolved += block.iv_unsolved;
+        }
+    }
+    output.close();
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    return stats;
+}
+
+void BatchPricingJob::writeContracts(const std::string& path, const OptionChainView& chain,
+                                     const double* market_price) {
+    const std::size_t n = chain.size;
+    FileHeader header{};
+    std::memcpy(header.magic, CONTRACT_MAGIC, sizeof(CONTRACT_MAGIC));
+    header.version = FILE_VERSION;
+    header.count = n;
+    header.flags = market_price ? FLAG_MARKET_PRICE : 0;
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) throw std::runtime_error("BatchPricingJob: cannot create " + path);
+    writeColumn(file, &header, sizeof(header));
+    for (const double* column : {chain.spot_price, chain.strike_price, chain.risk_free_rate, chain.volatility,
+                                 chain.time_to_expiry}) {
+        writeColumn(file, column, n * sizeof(double));
+    }
+    if (market_price) writeColumn(file, market_price, n * sizeof(double));
+
+    // Type column in fixed-size pieces, so huge chains don't need a second full copy
+    std::vector<std::uint8_t> types(std::min<std::size_t>(n, 1 << 16));
+    for (std::size_t first = 0; first < n; first += types.size()) {
+        const std::size_t count = std::min(types.size(), n - first);
+        for (std::size_t i = 0; i < count; ++i) types[i] = chain.option_type[first + i] == PUT ? 1 : 0;
+        writeColumn(file, types.data(), count);
+    }
+    if (!file.flush()) throw std::runtime_error("BatchPricingJob: failed to write " + path);
+}
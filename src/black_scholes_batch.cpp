@@ -0,0 +1,298 @@
+#include "../include/black_scholes_batch.h"
+#include "../include/fast_math.h"
+#include "../include/instrumentation.h"
+#include <cmath>
+#include <algorithm>
+#include <limits>
+
+namespace {
+constexpr double MIN_VOLATILITY = 1e-10;
+constexpr double MIN_TIME_TO_EXPIRY = 1e-10;
+constexpr double INF = std::numeric_limits<double>::infinity();
+constexpr double NOT_A_PRICE = std::numeric_limits<double>::quiet_NaN();
+
+constexpr double IV_MAX_VOLATILITY = 5.0;   // same ceiling as the scalar solver
+constexpr double IV_MIN_GUESS = 1e-3;
+constexpr double IV_VOL_TOLERANCE = 1e-10;
+constexpr double IV_NOISE_ULPS = 8.0;
+constexpr double DBL_EPS = std::numeric_limits<double>::epsilon();
+constexpr double DBL_MIN_NORMAL = std::numeric_limits<double>::min();
+constexpr int IV_MAX_ITERATIONS = 64;
+constexpr std::size_t IV_TILE = 64;
+constexpr double SQRT_2PI = 2.50662827463100050242;
+constexpr double INV_PI = 0.31830988618379067154;
+
+// The kernels below (like BlackScholesBatch::laneValid) use bitwise & / | on comparisons and
+// pick results with selects rather than && / || / if: every comparison is unconditional, so
+// the loops have no control flow and the compiler can if-convert and vectorize them.
+
+inline std::uint8_t laneStatus(double spot, double strike, double rate, double vol, double T) {
+    const bool spot_ok = (spot > 0.0) & (spot < INF);
+    const bool strike_ok = (strike > 0.0) & (strike < INF);
+    const bool expiry_ok = (T >= 0.0) & (T < INF);
+    const bool params_ok = (std::fabs(rate) < INF) & (std::fabs(vol) < INF);
+    const bool edge = (T < MIN_TIME_TO_EXPIRY) | (vol < MIN_VOLATILITY);
+    return static_cast<std::uint8_t>((spot_ok ? 0 : LANE_INVALID_SPOT)
+                                     | (strike_ok ? 0 : LANE_INVALID_STRIKE)
+                                     | (expiry_ok ? 0 : LANE_INVALID_EXPIRY)
+                                     | (params_ok ? 0 : LANE_INVALID_PARAM)
+                                     | (edge ? LANE_EDGE_CASE : 0));
+}
+
+// max(x, 0) as a plain select; std::fmax's NaN rules keep it from vectorizing
+inline double positivePart(double x) {
+    return x > 0.0 ? x : 0.0;
+}
+
+// One contract. sqrt_T and discount come from T clamped to MIN_TIME_TO_EXPIRY; T is raw.
+// Every branch of the scalar pricer is evaluated and the result selected.
+inline double priceLane(double spot, double strike, double rate, double vol, double T,
+                        double sqrt_T, double discount, double log_moneyness, bool is_call) {
+    const double T_c = T < MIN_TIME_TO_EXPIRY ? MIN_TIME_TO_EXPIRY : T;
+    const double vol_c = vol < MIN_VOLATILITY ? MIN_VOLATILITY : vol;
+    const double sigma_sqrt_T = vol_c * sqrt_T;
+    const double d1 = (log_moneyness + (rate + 0.5 * vol_c * vol_c) * T_c) / sigma_sqrt_T;
+    const double d2 = d1 - sigma_sqrt_T;
+
+    // Call: S N(d1) - K e^{-rT} N(d2);  Put: K e^{-rT} N(-d2) - S N(-d1)
+    const double w = is_call ? 1.0 : -1.0;
+    const double bs = w * (spot * FastMath::standardNormalCDF(w * d1)
+                           - strike * discount * FastMath::standardNormalCDF(w * d2));
+    const double intrinsic = positivePart(w * (spot - strike));
+    const double discounted_intrinsic = positivePart(w * (spot - strike * discount));
+
+    double price = vol < MIN_VOLATILITY ? discounted_intrinsic : bs;
+    price = T < MIN_TIME_TO_EXPIRY ? intrinsic : price;
+    return BlackScholesBatch::laneValid(spot, strike, rate, vol, T) ? price : NOT_A_PRICE;
+}
+
+// Corrado-Miller (1996) refinement of Brenner-Subrahmanyam, from the call-equivalent price and
+// discounted strike X. Exact ATM, close for moderate moneyness; clamped into the search range.
+inline double initialVolGuess(double call, double spot, double discounted_strike, double sqrt_T) {
+    const double half_gap = 0.5 * (spot - discounted_strike);
+    const double a = call - half_gap;
+    const double disc = a * a - 4.0 * half_gap * half_gap * INV_PI;
+    const double guess = SQRT_2PI / ((spot + discounted_strike) * sqrt_T) * (a + std::sqrt(positivePart(disc)));
+    const double floored = guess > IV_MIN_GUESS ? guess : IV_MIN_GUESS;  // also catches NaN
+    return floored < IV_MAX_VOLATILITY ? floored : 0.5 * IV_MAX_VOLATILITY;
+}
+
+// Status is a separate pass: mixing byte stores into the double-wide pricing loop costs
+// more in mask packing than re-reading the inputs, and callers may not want it at all.
+std::size_t markChainLanes(const OptionChainView& chain, std::uint8_t* status) {
+    const double* spot = chain.spot_price;
+    const double* strike = chain.strike_price;
+    const double* rate = chain.risk_free_rate;
+    const double* volatility = chain.volatility;
+    const double* expiry = chain.time_to_expiry;
+    std::size_t invalid = 0;
+    if (!status) {
+        for (std::size_t i = 0; i < chain.size; ++i)
+            invalid += BlackScholesBatch::laneValid(spot[i], strike[i], rate[i], volatility[i], expiry[i]) ? 0 : 1;
+        return invalid;
+    }
+    for (std::size_t i = 0; i < chain.size; ++i) {
+        status[i] = laneStatus(spot[i], strike[i], rate[i], volatility[i], expiry[i]);
+        invalid += (status[i] & LANE_ERROR_MASK) ? 1 : 0;
+    }
+    return invalid;
+}
+
+std::size_t markSliceLanes(const ExpirySliceView& slice, std::uint8_t* status) {
+    const double* strike = slice.strike_price;
+    const double* volatility = slice.volatility;
+    const double S = slice.spot_price;
+    const double r = slice.risk_free_rate;
+    const double T = slice.time_to_expiry;
+    std::size_t invalid = 0;
+    if (!status) {
+        for (std::size_t i = 0; i < slice.size; ++i)
+            invalid += BlackScholesBatch::laneValid(S, strike[i], r, volatility[i], T) ? 0 : 1;
+        return invalid;
+    }
+    for (std::size_t i = 0; i < slice.size; ++i) {
+        status[i] = laneStatus(S, strike[i], r, volatility[i], T);
+        invalid += (status[i] & LANE_ERROR_MASK) ? 1 : 0;
+    }
+    return invalid;
+}
+}
+
+std::size_t BlackScholesBatch::price(const OptionChainView& chain, double* prices, std::uint8_t* status) {
+    BS_TIMED_SCOPE(METRIC_PRICE_BATCH);
+    // Local copies of the array pointers so the compiler need not reload them per lane
+    const double* spot = chain.spot_price;
+    const double* strike = chain.strike_price;
+    const double* rate = chain.risk_free_rate;
+    const double* volatility = chain.volatility;
+    const double* expiry = chain.time_to_expiry;
+    const OptionType* type = chain.option_type;
+    const std::size_t n = chain.size;
+
+    for (std::size_t i = 0; i < n; ++i) {
+        const double S = spot[i];
+        const double K = strike[i];
+        const double r = rate[i];
+        const double T = expiry[i];
+        const double T_c = T < MIN_TIME_TO_EXPIRY ? MIN_TIME_TO_EXPIRY : T;
+        prices[i] = priceLane(S, K, r, volatility[i], T, std::sqrt(T_c), FastMath::exp(-r * T_c),
+                              FastMath::log(S) - FastMath::log(K), type[i] == CALL);
+    }
+    return markChainLanes(chain, status);
+}
+
+std::size_t BlackScholesBatch::priceExpirySlice(const ExpirySliceView& slice, double* prices, std::uint8_t* status) {
+    BS_TIMED_SCOPE(METRIC_PRICE_BATCH);
+    const double S = slice.spot_price;
+    const double r = slice.risk_free_rate;
+    const double T = slice.time_to_expiry;
+    const double T_c = T < MIN_TIME_TO_EXPIRY ? MIN_TIME_TO_EXPIRY : T;
+    const double sqrt_T = std::sqrt(T_c);
+    const double discount = std::exp(-r * T_c);
+    const double log_spot = S > 0.0 ? std::log(S) : 0.0;
+
+    const double* strike = slice.strike_price;
+    const double* volatility = slice.volatility;
+    const OptionType* type = slice.option_type;
+    const std::size_t n = slice.size;
+
+    for (std::size_t i = 0; i < n; ++i) {
+        const double K = strike[i];
+        prices[i] = priceLane(S, K, r, volatility[i], T, sqrt_T, discount,
+                              log_spot - FastMath::log(K), type[i] == CALL);
+    }
+    return markSliceLanes(slice, status);
+}
+
+std::size_t BlackScholesBatch::classify(const OptionChainView& chain, std::uint8_t* status) {
+    return markChainLanes(chain, status);
+}
+
+std::size_t BlackScholesBatch::impliedVolatility(const ImpliedVolChainView& chain, double* volatility,
+                                                 std::uint8_t* iterations, std::uint8_t* status) {
+    BS_TIMED_SCOPE(METRIC_IMPLIED_VOL);
+    const double* market = chain.market_price;
+    const double* spot = chain.spot_price;
+    const double* strike = chain.strike_price;
+    const double* rate = chain.risk_free_rate;
+    const double* expiry = chain.time_to_expiry;
+    const OptionType* type = chain.option_type;
+    const std::size_t n = chain.size;
+
+    // Per-block solver state. Everything is double (flags as 0.0 / 1.0) so each pass over the
+    // block is one vectorizable loop; lanes that are done are carried along unchanged.
+    double target[IV_TILE], log_target[IV_TILE], price_noise[IV_TILE], S[IV_TILE], X[IV_TILE];
+    double sqrt_T[IV_TILE], log_fk[IV_TILE], call[IV_TILE], vol[IV_TILE], lo[IV_TILE], hi[IV_TILE];
+    double active[IV_TILE], steps[IV_TILE], code[IV_TILE];
+    std::size_t failed = 0;
+
+    for (std::size_t base = 0; base < n; base += IV_TILE) {
+        const std::size_t m = std::min(IV_TILE, n - base);
+        const double* P_in = market + base;
+        const double* S_in = spot + base;
+        const double* K_in = strike + base;
+        const double* r_in = rate + base;
+        const double* T_in = expiry + base;
+        const OptionType* type_in = type + base;
+
+        // Every lane is solved on its out-of-the-money side (put-call parity), where the price
+        // is pure time value and ln(price) is close to linear in sigma.
+        double remaining = 0.0;
+        for (std::size_t i = 0; i < m; ++i) {
+            const double P = P_in[i];
+            const double s = S_in[i];
+            const double K = K_in[i];
+            const double r = r_in[i];
+            const double T = T_in[i];
+            const bool is_call = type_in[i] == CALL;
+            const bool valid = laneValid(s, K, r, 0.0, T) & (T >= MIN_TIME_TO_EXPIRY) & (P >= 0.0) & (P < INF);
+
+            const double T_c = T < MIN_TIME_TO_EXPIRY ? MIN_TIME_TO_EXPIRY : T;
+            const double root_T = std::sqrt(T_c);
+            const double x = K * FastMath::exp(-r * T_c);
+            const double intrinsic = positivePart(is_call ? s - x : x - s);
+            const double time_value = P - intrinsic;
+            const double upper = is_call ? s : x;
+            const double c = (time_value < DBL_MIN_NORMAL) ? IV_BELOW_INTRINSIC
+                                                             : ((P >= upper) ? IV_ABOVE_MAXIMUM : IV_CONVERGED);
+            const double lane_code = valid ? c : static_cast<double>(IV_INVALID_INPUT);
+            const bool solve_call = s < x;
+
+            target[i] = time_value;
+            log_target[i] = FastMath::log(time_value);
+            price_noise[i] = IV_NOISE_ULPS * DBL_EPS * P;
+            S[i] = s;
+            X[i] = x;
+            sqrt_T[i] = root_T;
+            log_fk[i] = FastMath::log(s) - FastMath::log(K) + r * T_c;  // ln(F / K)
+            call[i] = solve_call ? 1.0 : 0.0;
+            vol[i] = initialVolGuess(solve_call ? time_value : time_value + s - x, s, x, root_T);
+            lo[i] = 0.0;
+            hi[i] = IV_MAX_VOLATILITY;
+            steps[i] = 0.0;
+            code[i] = lane_code;
+            active[i] = lane_code == IV_CONVERGED ? 1.0 : 0.0;
+            remaining += active[i];
+        }
+
+        for (int k = 0; k < IV_MAX_ITERATIONS && remaining > 0.0; ++k) {
+            remaining = 0.0;
+            for (std::size_t i = 0; i < m; ++i) {
+                const double sigma = vol[i];
+                const double total_sd = sigma * sqrt_T[i];
+                const double d1 = log_fk[i] / total_sd + 0.5 * total_sd;
+                const double d2 = d1 - total_sd;
+                double n_d1, n_minus_d1, n_d2, n_minus_d2;
+                FastMath::standardNormalCDFPair(d1, n_d1, n_minus_d1);
+                FastMath::standardNormalCDFPair(d2, n_d2, n_minus_d2);
+                const bool is_call = call[i] > 0.0;
+                const double spot_leg = S[i] * (is_call ? n_d1 : n_minus_d1);
+                const double strike_leg = X[i] * (is_call ? n_d2 : n_minus_d2);
+                const double model = is_call ? spot_leg - strike_leg : strike_leg - spot_leg;
+                const double vega = S[i] * sqrt_T[i] * FastMath::standardNormalPDF(d1);
+                const double diff = model - target[i];
+
+                // Price is increasing in sigma, so the sign of diff shrinks the bracket
+                const bool too_high = diff > 0.0;
+                const double new_lo = too_high ? lo[i] : sigma;
+                const double new_hi = too_high ? sigma : hi[i];
+
+                // Halley step on g = ln(model) - ln(target), using volga = vega d1 d2 / sigma.
+                // Bisect when the step leaves the bracket, which also covers vega ~ 0 and a
+                // model price that underflowed; stop once diff is within rounding noise.
+                const bool model_ok = model > DBL_MIN_NORMAL;
+                const double g = FastMath::log(model_ok ? model : 1.0) - log_target[i];
+                const double newton = g * model / vega;
+                const double halley = newton / (1.0 - 0.5 * g * (model * d1 * d2 / (sigma * vega) - 1.0));
+                const double candidate = sigma - halley;
+                const bool inside = model_ok & (candidate > new_lo) & (candidate < new_hi);
+                const double noise = price_noise[i] + IV_NOISE_ULPS * DBL_EPS * (spot_leg + strike_leg);
+                const bool at_root = std::fabs(diff) <= noise;
+                const double next = at_root ? sigma : (inside ? candidate : 0.5 * (new_lo + new_hi));
+                const bool done = at_root | (std::fabs(next - sigma) < IV_VOL_TOLERANCE);
+
+                const bool lane_active = active[i] > 0.0;
+                vol[i] = lane_active ? next : sigma;
+                lo[i] = new_lo;
+                hi[i] = new_hi;
+                steps[i] += lane_active ? 1.0 : 0.0;
+                active[i] = (lane_active & !done) ? 1.0 : 0.0;
+                remaining += active[i];
+            }
+        }
+
+        for (std::size_t i = 0; i < m; ++i) {
+            double lane_code = code[i];
+            if (lane_code == IV_CONVERGED) {
+                if (active[i] > 0.0) lane_code = IV_NOT_CONVERGED;
+                else if (vol[i] > IV_MAX_VOLATILITY - 1e3 * IV_VOL_TOLERANCE) lane_code = IV_ABOVE_MAXIMUM;
+            }
+            const bool has_vol = (lane_code == IV_CONVERGED) || (lane_code == IV_NOT_CONVERGED);
+            volatility[base + i] = has_vol ? vol[i] : NOT_A_PRICE;
+            if (iterations) iterations[base + i] = static_cast<std::uint8_t>(steps[i]);
+            if (status) status[base + i] = static_cast<std::uint8_t>(lane_code);
+            failed += lane_code == IV_CONVERGED ? 0 : 1;
+        }
+    }
+    return failed;
+}
@@ -67,4 +67,12 @@ OptionGreeks BlackScholesGreeks::calculatePutGreeks(
                  * standardNormalCDF(-d2) / 100.0;
 
     return greeks;
-}
\ No newline at end of file
+}
+
+// Full-mask fused evaluators and the price + delta batch, instantiated here so the batch loop
+// gets -fno-trapping-math
+template OptionValuation BlackScholesGreeks::calculateAll<OUTPUT_ALL>(double, double, double, double, double);
+template std::size_t BlackScholesGreeks::calculateAllBatch<OUTPUT_ALL>(
+    const OptionChainView&, const GreeksBatchOutput&, std::uint8_t*);
+template std::size_t BlackScholesGreeks::calculateAllBatch<OUTPUT_PRICE | OUTPUT_DELTA>(
+    const OptionChainView&, const GreeksBatchOutput&, std::uint8_t*);
@@ -0,0 +1,217 @@
+#include "../include/http_client.h"
+#include "../include/instrumentation.h"
+#include <curl/curl.h>
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+constexpr long REQUEST_TIMEOUT_SECONDS = 30;
+constexpr int IDLE_POLL_MS = 1000;
+
+struct Transfer {
+    CURL* easy{nullptr};
+    std::string url;
+    AsyncHttpClient::Completion on_done;
+    std::string body;
+    char error[CURL_ERROR_SIZE] = {0};
+    std::chrono::steady_clock::time_point started;  // after the rate limiter let it through
+};
+
+size_t appendBody(char* data, size_t size, size_t nmemb, void* transfer) {
+    static_cast<Transfer*>(transfer)->body.append(data, size * nmemb);
+    return size * nmemb;
+}
+}
+
+// ---------------------------------------------------------------------------------------------
+
+RateLimiter::RateLimiter(double requests_per_minute, double burst)
+    : tokens_(std::max(1.0, burst)),
+      capacity_(std::max(1.0, burst)),
+      tokens_per_second_(requests_per_minute / 60.0),
+      last_refill_(Clock::now()) {
+    if (!(requests_per_minute > 0.0)) {
+        throw std::invalid_argument("RateLimiter: requests_per_minute must be positive");
+    }
+}
+
+void RateLimiter::refill(Clock::time_point now) {
+    const double elapsed = std::chrono::duration<double>(now - last_refill_).count();
+    tokens_ = std::min(capacity_, tokens_ + elapsed * tokens_per_second_);
+    last_refill_ = now;
+}
+
+bool RateLimiter::tryAcquire() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    refill(Clock::now());
+    if (tokens_ < 1.0) return false;
+    tokens_ -= 1.0;
+    return true;
+}
+
+RateLimiter::Clock::duration RateLimiter::timeUntilAvailable() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    refill(Clock::now());
+    if (tokens_ >= 1.0) return Clock::duration::zero();
+    return std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>((1.0 - tokens_) / tokens_per_second_));
+}
+
+void RateLimiter::acquire() {
+    while (!tryAcquire()) {
+        std::this_thread::sleep_for(timeUntilAvailable());
+    }
+}
+
+// ---------------------------------------------------------------------------------------------
+
+AsyncHttpClient::AsyncHttpClient(RateLimiter* limiter, long max_host_connections)
+    : limiter_(limiter), max_host_connections_(max_host_connections) {
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+    multi_ = curl_multi_init();
+    share_ = curl_share_init();
+    if (!multi_ || !share_) {
+        if (multi_) curl_multi_cleanup(multi_);
+        if (share_) curl_share_cleanup(share_);
+        throw std::runtime_error("Failed to initialize CURL multi handle");
+    }
+    curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+    curl_multi_setopt(multi_, CURLMOPT_MAX_HOST_CONNECTIONS, max_host_connections_);
+    curl_multi_setopt(multi_, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+    worker_ = std::thread([this] { run(); });
+}
+
+AsyncHttpClient::~AsyncHttpClient() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    curl_multi_wakeup(multi_);
+    worker_.join();
+    curl_multi_cleanup(multi_);
+    curl_share_cleanup(share_);
+}
+
+void AsyncHttpClient::get(const std::string& url, Completion on_done) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_) throw std::runtime_error("AsyncHttpClient is shutting down");
+        queue_.push_back({url, std::move(on_done)});
+    }
+    curl_multi_wakeup(multi_);
+}
+
+std::future<HttpResponse> AsyncHttpClient::get(const std::string& url) {
+    auto promise = std::make_shared<std::promise<HttpResponse>>();
+    std::future<HttpResponse> result = promise->get_future();
+    get(url, [promise](HttpResponse response) {
+        if (!response.error.empty()) {
+            promise->set_exception(std::make_exception_ptr(
+                std::runtime_error("CURL request failed: " + response.error)));
+        } else {
+            promise->set_value(std::move(response));
+        }
+    });
+    return result;
+}
+
+void AsyncHttpClient::run() {
+    // Easy handles are recycled: curl_easy_reset keeps their connection and session caches
+    std::vector<CURL*> idle;
+    std::vector<std::unique_ptr<Transfer>> active;
+
+    auto start = [&](Request request) {
+        CURL* easy = idle.empty() ? curl_easy_init() : idle.back();
+        if (!idle.empty()) idle.pop_back();
+        auto transfer = std::make_unique<Transfer>();
+        transfer->easy = easy;
+        transfer->url = std::move(request.url);
+        transfer->on_done = std::move(request.on_done);
+        if (!easy) {
+            transfer->on_done({0, {}, "Failed to initialize CURL"});
+            return;
+        }
+        curl_easy_setopt(easy, CURLOPT_URL, transfer->url.c_str());
+        curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, appendBody);
+        curl_easy_setopt(easy, CURLOPT_WRITEDATA, transfer.get());
+        curl_easy_setopt(easy, CURLOPT_PRIVATE, transfer.get());
+        curl_easy_setopt(easy, CURLOPT_ERRORBUFFER, transfer->error);
+        curl_easy_setopt(easy, CURLOPT_SHARE, share_);
+        curl_easy_setopt(easy, CURLOPT_NOSIGNAL, 1L);
+        curl_easy_setopt(easy, CURLOPT_TCP_KEEPALIVE, 1L);
+        curl_easy_setopt(easy, CURLOPT_ACCEPT_ENCODING, "");
+        curl_easy_setopt(easy, CURLOPT_TIMEOUT, REQUEST_TIMEOUT_SECONDS);
+        transfer->started = std::chrono::steady_clock::now();
+        curl_multi_add_handle(multi_, easy);
+        active.push_back(std::move(transfer));
+    };
+
+    auto finish = [&](CURL* easy, CURLcode code) {
+        Transfer* raw = nullptr;
+        curl_easy_getinfo(easy, CURLINFO_PRIVATE, &raw);
+        HttpResponse response;
+        curl_easy_getinfo(easy, CURLINFO_RESPONSE_CODE, &response.status);
+        if (code != CURLE_OK) response.error = raw->error[0] ? raw->error : curl_easy_strerror(code);
+        curl_multi_remove_handle(multi_, easy);
+        curl_easy_reset(easy);
+        idle.push_back(easy);
+
+        auto it = std::find_if(active.begin(), active.end(), [raw](const auto& t) { return t.get() == raw; });
+        std::unique_ptr<Transfer> transfer = std::move(*it);
+        active.erase(it);
+        BS_RECORD_LATENCY(METRIC_HTTP_REQUEST, static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - transfer->started)
+                .count()));
+        response.body = std::move(transfer->body);
+        transfer->on_done(std::move(response));
+    };
+
+    for (;;) {
+        std::deque<Request> ready;
+        bool stopping;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping = stopping_;
+            while (!stopping && !queue_.empty() && (!limiter_ || limiter_->tryAcquire())) {
+                ready.push_back(std::move(queue_.front()));
+                queue_.pop_front();
+            }
+        }
+        if (stopping) break;
+        for (Request& request : ready) start(std::move(request));
+
+        int running = 0;
+        curl_multi_perform(multi_, &running);
+        int queued_messages = 0;
+        while (CURLMsg* message = curl_multi_info_read(multi_, &queued_messages)) {
+            if (message->msg == CURLMSG_DONE) finish(message->easy_handle, message->data.result);
+        }
+
+        // Sleep until socket activity, a new request (curl_multi_wakeup) or the next token
+        int timeout_ms = IDLE_POLL_MS;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!queue_.empty() && limiter_) {
+                const auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(limiter_->timeUntilAvailable());
+                timeout_ms = static_cast<int>(std::min<long long>(IDLE_POLL_MS, wait.count() + 1));
+            }
+        }
+        curl_multi_poll(multi_, nullptr, 0, timeout_ms, nullptr);
+    }
+
+    // Shutting down: fail whatever is still queued or in flight
+    for (auto& transfer : active) {
+        curl_multi_remove_handle(multi_, transfer->easy);
+        curl_easy_cleanup(transfer->easy);
+        transfer->on_done({0, {}, "request cancelled: client shut down"});
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (Request& request : queue_) request.on_done({0, {}, "request cancelled: client shut down"});
+        queue_.clear();
+    }
+    for (CURL* easy : idle) curl_easy_cleanup(easy);
+}
@@ -0,0 +1,205 @@
+#include "../include/instrumentation.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <sstream>
+
+namespace {
+constexpr const char* METRIC_NAMES[METRIC_COUNT] = {
+    "price_batch", "greeks_batch", "implied_vol", "mc_chunk",
+    "http_request", "json_parse", "reprice", "portfolio_risk",
+};
+constexpr double PERCENTILES[] = {0.5, 0.9, 0.99, 0.999};
+
+// Written only by the owning thread; read by anyone
+struct MetricCells {
+    std::atomic<std::uint64_t> count{0};
+    std::atomic<std::uint64_t> total_ns{0};
+    std::atomic<std::uint64_t> max_ns{0};
+    std::atomic<std::uint64_t> buckets[Instrumentation::BUCKET_COUNT]{};
+};
+
+struct ThreadBlock {
+    MetricCells metrics[METRIC_COUNT];
+};
+
+void bump(std::atomic<std::uint64_t>& cell, std::uint64_t amount) {
+    cell.store(cell.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+// Blocks are never freed, so totals outlive their threads; an exiting thread returns its block
+// to the free list and the next new thread carries on counting into it, so the block count is
+// bounded by the peak number of live recording threads. The registry itself is leaked so
+// threads recording during static destruction still find it
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadBlock>> blocks;
+    std::vector<ThreadBlock*> free_blocks;
+};
+
+Registry& registry() {
+    static Registry* instance = new Registry();
+    return *instance;
+}
+
+// Owns a block for the life of one thread
+struct BlockLease {
+    ThreadBlock* block;
+
+    BlockLease() {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        if (!r.free_blocks.empty()) {
+            block = r.free_blocks.back();
+            r.free_blocks.pop_back();
+        } else {
+            r.blocks.push_back(std::make_unique<ThreadBlock>());
+            block = r.blocks.back().get();
+        }
+    }
+    ~BlockLease() {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.free_blocks.push_back(block);
+    }
+};
+
+ThreadBlock& threadBlock() {
+    thread_local BlockLease lease;
+    return *lease.block;
+}
+
+struct Merged {
+    std::uint64_t count{0}, total_ns{0}, max_ns{0};
+    std::vector<std::uint64_t> buckets = std::vector<std::uint64_t>(Instrumentation::BUCKET_COUNT, 0);
+};
+
+std::vector<Merged> mergeBlocks() {
+    std::vector<Merged> merged(METRIC_COUNT);
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (const auto& block : r.blocks) {
+        for (int m = 0; m < METRIC_COUNT; ++m) {
+            const MetricCells& cells = block->metrics[m];
+            merged[m].count += cells.count.load(std::memory_order_relaxed);
+            merged[m].total_ns += cells.total_ns.load(std::memory_order_relaxed);
+            merged[m].max_ns = std::max(merged[m].max_ns, cells.max_ns.load(std::memory_order_relaxed));
+            for (std::size_t b = 0; b < Instrumentation::BUCKET_COUNT; ++b) {
+                merged[m].buckets[b] += cells.buckets[b].load(std::memory_order_relaxed);
+            }
+        }
+    }
+    return merged;
+}
+}
+
+void Instrumentation::record(Metric metric, std::uint64_t nanoseconds) noexcept {
+    MetricCells& cells = threadBlock().metrics[metric];
+    bump(cells.count, 1);
+    bump(cells.total_ns, nanoseconds);
+    if (nanoseconds > cells.max_ns.load(std::memory_order_relaxed)) {
+        cells.max_ns.store(nanoseconds, std::memory_order_relaxed);
+    }
+    bump(cells.buckets[bucketIndex(nanoseconds)], 1);
+}
+
+const char* Instrumentation::name(Metric metric) {
+    return metric < METRIC_COUNT ? METRIC_NAMES[metric] : "unknown";
+}
+
+std::size_t Instrumentation::bucketIndex(std::uint64_t nanoseconds) noexcept {
+    constexpr std::uint64_t SUB_BUCKETS = 1u << SUB_BUCKET_BITS;
+    if (nanoseconds < SUB_BUCKETS) return static_cast<std::size_t>(nanoseconds);
+#if defined(__GNUC__) || defined(__clang__)
+    const int exponent = 63 - __builtin_clzll(nanoseconds);
+#else
+    int exponent = 0;
+    while (nanoseconds >> (exponent + 1)) ++exponent;
+#endif
+    if (exponent > MAX_EXPONENT) return BUCKET_COUNT - 1;
+    const std::uint64_t sub = (nanoseconds >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1);
+    return (static_cast<std::size_t>(exponent - SUB_BUCKET_BITS + 1) << SUB_BUCKET_BITS) + sub;
+}
+
+std::uint64_t Instrumentation::bucketUpperBound(std::size_t index) noexcept {
+    constexpr std::uint64_t SUB_BUCKETS = 1u << SUB_BUCKET_BITS;
+    if (index < SUB_BUCKETS) return index;
+    const int shift = static_cast<int>(index >> SUB_BUCKET_BITS) - 1;
+    const std::uint64_t lower = (SUB_BUCKETS + (index & (SUB_BUCKETS - 1))) << shift;
+    return lower + (std::uint64_t{1} << shift) - 1;
+}
+
+std::vector<LatencySummary> Instrumentation::summary() {
+    const std::vector<Merged> merged = mergeBlocks();
+    std::vector<LatencySummary> out(METRIC_COUNT);
+    for (int m = 0; m < METRIC_COUNT; ++m) {
+        LatencySummary& s = out[m];
+        s.metric = static_cast<Metric>(m);
+        s.count = merged[m].count;
+        s.total_ns = merged[m].total_ns;
+        s.max_ns = merged[m].max_ns;
+
+        std::uint64_t* targets[] = {&s.p50_ns, &s.p90_ns, &s.p99_ns, &s.p999_ns};
+        std::uint64_t seen = 0;
+        std::size_t next = 0;
+        for (std::size_t b = 0; b < BUCKET_COUNT && next < 4 && s.count; ++b) {
+            seen += merged[m].buckets[b];
+            while (next < 4 && seen >= PERCENTILES[next] * s.count) {
+                *targets[next++] = std::min(bucketUpperBound(b), s.max_ns);
+            }
+        }
+    }
+    return out;
+}
+
+std::string Instrumentation::toJson() {
+    std::ostringstream out;
+    out << "{\"enabled\": " << (enabled() ? "true" : "false") << ", \"metrics\": {";
+    const std::vector<LatencySummary> all = summary();
+    for (std::size_t i = 0; i < all.size(); ++i) {
+        const LatencySummary& s = all[i];
+        out << (i ? ", " : "") << '"' << name(s.metric) << "\": {\"count\": " << s.count
+            << ", \"total_ns\": " << s.total_ns << ", \"max_ns\": " << s.max_ns << ", \"p50_ns\": " << s.p50_ns
+            << ", \"p90_ns\": " << s.p90_ns << ", \"p99_ns\": " << s.p99_ns << ", \"p999_ns\": " << s.p999_ns
+            << '}';
+    }
+    out << "}}\n";
+    return out.str();
+}
+
+std::string Instrumentation::toPrometheus() {
+    std::ostringstream out;
+    out.precision(9);
+    const std::vector<Merged> merged = mergeBlocks();
+    out << "# HELP bs_latency_seconds Latency of instrumented hot paths.\n"
+        << "# TYPE bs_latency_seconds histogram\n";
+    for (int m = 0; m < METRIC_COUNT; ++m) {
+        const char* label = METRIC_NAMES[m];
+        // Cumulative buckets, only at bounds where the count changes
+        std::uint64_t cumulative = 0;
+        for (std::size_t b = 0; b < BUCKET_COUNT; ++b) {
+            if (!merged[m].buckets[b]) continue;
+            cumulative += merged[m].buckets[b];
+            out << "bs_latency_seconds_bucket{path=\"" << label << "\",le=\"" << bucketUpperBound(b) * 1e-9
+                << "\"} " << cumulative << '\n';
+        }
+        out << "bs_latency_seconds_bucket{path=\"" << label << "\",le=\"+Inf\"} " << merged[m].count << '\n'
+            << "bs_latency_seconds_sum{path=\"" << label << "\"} " << merged[m].total_ns * 1e-9 << '\n'
+            << "bs_latency_seconds_count{path=\"" << label << "\"} " << merged[m].count << '\n';
+    }
+    return out.str();
+}
+
+void Instrumentation::reset() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (const auto& block : r.blocks) {
+        for (MetricCells& cells : block->metrics) {
+            cells.count.store(0, std::memory_order_relaxed);
+            cells.total_ns.store(0, std::memory_order_relaxed);
+            cells.max_ns.store(0, std::memory_order_relaxed);
+            for (auto& bucket : cells.buckets) bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+}
@@ -0,0 +1,213 @@
+#include "../include/leg_table.h"
+#include "../include/black_scholes_greeks.h"
+#include "../include/option_strategy.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+constexpr double SECONDS_PER_YEAR = 365.25 * 24 * 60 * 60;
+constexpr std::size_t LANE_BLOCK = 4096;   // legs x prices lanes per kernel call
+constexpr std::size_t MIXED_EXPIRY_GRID = 256;
+constexpr double SLOPE_EPSILON = 1e-9;
+
+struct LaneScratch {
+    std::vector<double> spot, strike, rate, volatility, time_to_expiry;
+    std::vector<double> call_price, put_price, call_delta, put_delta;
+
+    void resize(std::size_t n, const LegPricingConfig& config) {
+        spot.resize(n);
+        strike.resize(n);
+        rate.assign(n, config.risk_free_rate);
+        volatility.assign(n, config.volatility);
+        time_to_expiry.resize(n);
+        call_price.resize(n);
+        put_price.resize(n);
+        call_delta.resize(n);
+        put_delta.resize(n);
+    }
+};
+
+double yearsUntil(std::time_t expiry, std::time_t at) {
+    return std::max(0.0, std::difftime(expiry, at) / SECONDS_PER_YEAR);
+}
+
+// Lane k of a block is row begin + lane / count at prices[lane % count], lane = start + k
+void evaluateRows(const LegTable& table, std::size_t begin, std::size_t end, const double* prices,
+                  std::size_t count, std::time_t at, const LegPricingConfig& config, double shares,
+                  LaneScratch& scratch, double* values, double* deltas) {
+    for (std::size_t i = 0; i < count; ++i) values[i] = shares * prices[i];
+    if (deltas) std::fill(deltas, deltas + count, shares);
+
+    const std::size_t lanes = (end - begin) * count;
+    for (std::size_t start = 0; start < lanes; start += LANE_BLOCK) {
+        const std::size_t m = std::min(LANE_BLOCK, lanes - start);
+        scratch.resize(m, config);
+        for (std::size_t k = 0; k < m; ++k) {
+            const std::size_t lane = start + k;
+            const std::size_t row = begin + lane / count;
+            scratch.spot[k] = prices[lane % count];
+            scratch.strike[k] = table.strike()[row];
+            scratch.time_to_expiry[k] = yearsUntil(table.expiry()[row], at);
+        }
+        const OptionChainView chain{scratch.spot.data(), scratch.strike.data(), scratch.rate.data(),
+                                    scratch.volatility.data(), scratch.time_to_expiry.data(), nullptr, m};
+        GreeksBatchOutput out;
+        out.call_price = scratch.call_price.data();
+        out.put_price = scratch.put_price.data();
+        out.call_delta = scratch.call_delta.data();
+        out.put_delta = scratch.put_delta.data();
+        BlackScholesGreeks::calculateAllBatch<OUTPUT_PRICE | OUTPUT_DELTA>(chain, out, nullptr);
+
+        for (std::size_t k = 0; k < m; ++k) {
+            const std::size_t lane = start + k;
+            const std::size_t row = begin + lane / count;
+            const std::size_t i = lane % count;
+            const double leg_shares = table.quantity()[row] * table.multiplier()[row];
+            const bool call = table.type()[row] == CALL;
+            values[i] += leg_shares * (call ? scratch.call_price[k] : scratch.put_price[k]);
+            if (deltas) deltas[i] += leg_shares * (call ? scratch.call_delta[k] : scratch.put_delta[k]);
+        }
+    }
+}
+
+StrategyMetrics strategyMetrics(const LegTable& table, std::size_t strategy, const LegPricingConfig& config,
+                                LaneScratch& scratch) {
+    const std::size_t begin = table.rowBegin(strategy);
+    const std::size_t end = table.rowEnd(strategy);
+    const std::time_t at = table.firstExpiry(strategy);
+    const double shares = table.stockShares()[strategy];
+    const double entry_cost = table.entryCost()[strategy];
+
+    // Slope far above every strike: the stock plus every call, long-dated ones at delta ~1
+    double tail_slope = shares;
+    bool mixed_expiries = false;
+    std::vector<double> points;
+    for (std::size_t row = begin; row < end; ++row) {
+        if (table.type()[row] == CALL) tail_slope += table.quantity()[row] * table.multiplier()[row];
+        mixed_expiries |= table.expiry()[row] != at;
+        points.push_back(table.strike()[row]);
+    }
+    if (mixed_expiries && !points.empty()) {
+        const double top = 2.0 * *std::max_element(points.begin(), points.end());
+        for (std::size_t i = 1; i <= MIXED_EXPIRY_GRID; ++i) points.push_back(top * i / MIXED_EXPIRY_GRID);
+    }
+    std::sort(points.begin(), points.end());
+    points.erase(std::unique(points.begin(), points.end()), points.end());
+
+    // S = 0 is outside the kernel's domain: calls are worthless and puts worth their discounted strike
+    double at_zero = 0.0;
+    for (std::size_t row = begin; row < end; ++row) {
+        if (table.type()[row] == PUT) {
+            at_zero += table.quantity()[row] * table.multiplier()[row] * table.strike()[row] *
+                       std::exp(-config.risk_free_rate * yearsUntil(table.expiry()[row], at));
+        }
+    }
+
+    std::vector<double> x(1, 0.0), y(1, at_zero - entry_cost);
+    if (!points.empty()) {
+        std::vector<double> values(points.size());
+        evaluateRows(table, begin, end, points.data(), points.size(), at, config, shares, scratch, values.data(),
+                     nullptr);
+        for (std::size_t i = 0; i < points.size(); ++i) {
+            x.push_back(points[i]);
+            y.push_back(values[i] - entry_cost);
+        }
+    }
+
+    StrategyMetrics metrics;
+    const auto addBreakeven = [&metrics](double price) {
+        if (metrics.breakevens.empty() || metrics.breakevens.back() != price) metrics.breakevens.push_back(price);
+    };
+    for (std::size_t i = 0; i < x.size(); ++i) {
+        if (y[i] == 0.0) addBreakeven(x[i]);
+        else if (i + 1 < x.size() && (y[i] < 0.0) != (y[i + 1] < 0.0) && y[i + 1] != 0.0)
+            addBreakeven(x[i] - y[i] * (x[i + 1] - x[i]) / (y[i + 1] - y[i]));
+    }
+    if (std::fabs(tail_slope) > SLOPE_EPSILON && y.back() != 0.0 && (y.back() < 0.0) == (tail_slope > 0.0)) {
+        addBreakeven(x.back() - y.back() / tail_slope);
+    }
+
+    const auto extremes = std::minmax_element(y.begin(), y.end());
+    metrics.max_profit = tail_slope > SLOPE_EPSILON ? StrategyMetrics::UNLIMITED : *extremes.second;
+    metrics.max_loss = tail_slope < -SLOPE_EPSILON ? StrategyMetrics::UNLIMITED : -*extremes.first;
+    return metrics;
+}
+}
+
+std::size_t LegTable::addStrategy(double stock_shares, double entry_cost) {
+    row_begin_.push_back(static_cast<std::uint32_t>(size()));
+    stock_shares_.push_back(stock_shares);
+    entry_cost_.push_back(entry_cost);
+    return strategyCount() - 1;
+}
+
+void LegTable::addLeg(OptionType type, double strike, std::time_t expiry, double quantity, double multiplier) {
+    if (strategyCount() == 0) throw std::logic_error("LegTable: addStrategy before addLeg");
+    type_.push_back(type);
+    strike_.push_back(strike);
+    expiry_.push_back(expiry);
+    quantity_.push_back(quantity);
+    multiplier_.push_back(multiplier);
+}
+
+std::size_t LegTable::addStrategy(const OptionStrategy& strategy) {
+    const std::size_t id = addStrategy(strategy.getStockPosition(), strategy.getEntryPrice());
+    const std::vector<Option>& options = strategy.getOptions();
+    const std::vector<int>& quantities = strategy.getOptionQuantities();
+    for (std::size_t i = 0; i < options.size(); ++i) {
+        addLeg(options[i].getType(), options[i].getStrikePrice(), options[i].getExpirationDate(),
+               i < quantities.size() ? quantities[i] : 1, OptionStrategy::CONTRACT_MULTIPLIER);
+    }
+    return id;
+}
+
+LegTable LegTable::fromStrategy(const OptionStrategy& strategy) {
+    LegTable table;
+    table.addStrategy(strategy);
+    return table;
+}
+
+std::time_t LegTable::firstExpiry(std::size_t strategy) const {
+    const std::size_t begin = rowBegin(strategy);
+    const std::size_t end = rowEnd(strategy);
+    if (begin == end) return 0;
+    return *std::min_element(expiry_.begin() + begin, expiry_.begin() + end);
+}
+
+void LegTable::value(std::size_t strategy, const double* prices, std::size_t count, std::time_t at,
+                     const LegPricingConfig& config, double* values, double* deltas) const {
+    LaneScratch scratch;
+    evaluateRows(*this, rowBegin(strategy), rowEnd(strategy), prices, count, at, config, stock_shares_[strategy],
+                 scratch, values, deltas);
+}
+
+void LegTable::profitLoss(std::size_t strategy, const double* prices, std::size_t count, std::time_t at,
+                          const LegPricingConfig& config, double* profit_loss) const {
+    value(strategy, prices, count, at, config, profit_loss);
+    for (std::size_t i = 0; i < count; ++i) profit_loss[i] -= entry_cost_[strategy];
+}
+
+void LegTable::profitLossAll(const double* prices, std::size_t count, std::time_t at, const LegPricingConfig& config,
+                             double* profit_loss) const {
+    LaneScratch scratch;
+    for (std::size_t s = 0; s < strategyCount(); ++s) {
+        double* out = profit_loss + s * count;
+        evaluateRows(*this, rowBegin(s), rowEnd(s), prices, count, at, config, stock_shares_[s], scratch, out,
+                     nullptr);
+        for (std::size_t i = 0; i < count; ++i) out[i] -= entry_cost_[s];
+    }
+}
+
+StrategyMetrics LegTable::metrics(std::size_t strategy, const LegPricingConfig& config) const {
+    LaneScratch scratch;
+    return strategyMetrics(*this, strategy, config, scratch);
+}
+
+std::vector<StrategyMetrics> LegTable::metricsAll(const LegPricingConfig& config) const {
+    LaneScratch scratch;
+    std::vector<StrategyMetrics> all;
+    all.reserve(strategyCount());
+    for (std::size_t s = 0; s < strategyCount(); ++s) all.push_back(strategyMetrics(*this, s, config, scratch));
+    return all;
+}
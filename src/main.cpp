@@ -2,8 +2,13 @@
 #include "../include/black_scholes.h"
 #include "../include/black_scholes_greeks.h"
 #include "../include/market_data.h"
+#include "../include/alpha_vantage_feed.h"
 #include "../include/paper_trading.h"
+#include "../include/instrumentation.h"
+#include "../include/batch_pricing_job.h"
 #include <iostream>
+#include <algorithm>
+#include <memory>
 #include <ctime>
 #include <iomanip>
 #include <vector>
@@ -12,6 +17,7 @@
 #include <fstream>
 #include <sstream>
 #include <cstdlib>
+#include <cstring>
 
 // Function to find the next available Friday
 std::time_t getNextFriday(int weeks_ahead) {
@@ -62,23 +68,14 @@ void printOptionDetailsWithGreeks(
     double volatility,
     int dte
 ) {
-    // Calculate option prices
-    double call_price = BlackScholes::calculateCallPrice(
-        current_price, strike_price, risk_free_rate, volatility, time_to_expiry
-    );
-    
-    double put_price = BlackScholes::calculatePutPrice(
-        current_price, strike_price, risk_free_rate, volatility, time_to_expiry
-    );
-    
-    // Calculate Greeks
-    OptionGreeks call_greeks = BlackScholesGreeks::calculateCallGreeks(
-        current_price, strike_price, risk_free_rate, volatility, time_to_expiry
-    );
-    
-    OptionGreeks put_greeks = BlackScholesGreeks::calculatePutGreeks(
+    // Prices and Greeks for both sides from a single evaluation
+    const OptionValuation valuation = BlackScholesGreeks::calculateAll(
         current_price, strike_price, risk_free_rate, volatility, time_to_expiry
     );
+    const double call_price = valuation.call_price;
+    const double put_price = valuation.put_price;
+    const OptionGreeks& call_greeks = valuation.call_greeks;
+    const OptionGreeks& put_greeks = valuation.put_greeks;
     
     // Print basic option information
     std::cout << std::fixed << std::setprecision(2)
@@ -110,7 +107,95 @@ void printOptionDetailsWithGreeks(
     std::cout << "--------------------------------------------------------------------------------\n";
 }
 
-int main() {
+enum MetricsFormat { METRICS_NONE, METRICS_JSON, METRICS_PROMETHEUS };
+
+// Writes the latency histograms when main returns, to path or (if empty) console
+struct MetricsDump {
+    MetricsFormat format{METRICS_NONE};
+    std::string path;
+    std::ostream* console{&std::cout};
+
+    ~MetricsDump() {
+        if (format == METRICS_NONE) return;
+        const std::string text = format == METRICS_JSON ? Instrumentation::toJson() : Instrumentation::toPrometheus();
+        if (path.empty()) {
+            *console << "\n--- Latency metrics ---\n" << text;
+            if (!Instrumentation::enabled()) *console << "(built with BS_ENABLE_INSTRUMENTATION=OFF)\n";
+            return;
+        }
+        std::ofstream out(path);
+        out << text;
+        if (!out) std::cerr << "Could not write metrics to " << path << std::endl;
+    }
+};
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [--metrics[=json|prometheus]] [--metrics-out=FILE]\n"
+              << "       " << program << " --batch=FILE [--batch-out=FILE] [--batch-format=csv|binary]"
+              << " [--batch-iv] [--batch-block=N]\n"
+              << "  --metrics       dump hot-path latency histograms on exit (default format: json)\n"
+              << "  --metrics-out   write them to FILE instead of stdout\n"
+              << "  --batch         price every contract of a CSV or binary contract file, no demo\n"
+              << "                  (see batch_pricing_job.h for the formats)\n"
+              << "  --batch-out     write the results to FILE instead of stdout\n"
+              << "  --batch-format  result encoding (default: csv)\n"
+              << "  --batch-iv      solve implied vol from the market_price column first\n"
+              << "  --batch-block   contracts per parallel block\n";
+}
+
+// Headless batch mode: results to the output, a one-line summary to stderr
+int runBatch(const std::string& input_path, const std::string& output_path, const BatchPricingConfig& config) {
+    try {
+        const BatchPricingStats stats = BatchPricingJob::run(input_path, output_path, config);
+        std::cerr << "Priced " << stats.contracts << " contracts in " << std::fixed << std::setprecision(3)
+                  << stats.seconds << " s (" << std::setprecision(2)
+                  << (stats.seconds > 0 ? stats.contracts / stats.seconds * 1e-6 : 0.0) << " M/s), "
+                  << stats.invalid << " invalid";
+        if (config.implied_volatility) std::cerr << ", " << stats.iv_unsolved << " IV not converged";
+        std::cerr << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    MetricsDump metrics;
+    std::string batch_input, batch_output;
+    BatchPricingConfig batch_config;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const auto value = [&](const char* prefix) { return arg.substr(std::strlen(prefix)); };
+        if (arg == "--metrics" || arg == "--metrics=json") {
+            metrics.format = METRICS_JSON;
+        } else if (arg == "--metrics=prometheus") {
+            metrics.format = METRICS_PROMETHEUS;
+        } else if (arg.rfind("--metrics-out=", 0) == 0) {
+            metrics.path = value("--metrics-out=");
+            if (metrics.format == METRICS_NONE) metrics.format = METRICS_JSON;
+        } else if (arg.rfind("--batch=", 0) == 0) {
+            batch_input = value("--batch=");
+        } else if (arg.rfind("--batch-out=", 0) == 0) {
+            batch_output = value("--batch-out=");
+        } else if (arg == "--batch-format=csv" || arg == "--batch-format=binary") {
+            batch_config.output_format = arg == "--batch-format=csv" ? BATCH_CSV : BATCH_BINARY;
+        } else if (arg == "--batch-iv") {
+            batch_config.implied_volatility = true;
+        } else if (arg.rfind("--batch-block=", 0) == 0 &&
+                   std::strtoull(value("--batch-block=").c_str(), nullptr, 10) > 0) {
+            batch_config.block_size = std::strtoull(value("--batch-block=").c_str(), nullptr, 10);
+        } else {
+            printUsage(argv[0]);
+            return 2;
+        }
+    }
+    if (!batch_input.empty()) {
+        // Metrics go to stderr here unless --metrics-out is given, so stdout stays pure results
+        metrics.console = &std::cerr;
+        return runBatch(batch_input, batch_output, batch_config);
+    }
+
     std::cout << "\n========== Black-Scholes Options Pricing and Paper Trading System ==========\n";
 
     // --- Demo 1: Single Black-Scholes price calculation (no API) ---
@@ -147,20 +232,36 @@ int main() {
         bool bought = paper.buyOption(call_option, 1);
         if (bought) {
             paper.printPortfolio();
+            paper.printRisk(paper.calculateRisk(0.02, 0.3));
         }
         std::cout << "\n";
     }
 
     std::string alpha_vantage_api_key = loadEnvValue("ALPHA_VANTAGE_API_KEY", ".env");
 
+    // Requests per minute allowed by the API key's plan (free plan: 5)
+    double requests_per_minute = AlphaVantageClient::DEFAULT_REQUESTS_PER_MINUTE;
+    const std::string plan_rate = loadEnvValue("ALPHA_VANTAGE_REQUESTS_PER_MINUTE", ".env");
+    if (!plan_rate.empty()) {
+        try {
+            requests_per_minute = std::stod(plan_rate);
+        } catch (const std::exception&) {
+            std::cerr << "Ignoring invalid ALPHA_VANTAGE_REQUESTS_PER_MINUTE: " << plan_rate << std::endl;
+        }
+    }
+
+    // Daily history is cached here between runs (see PriceStore)
+    std::string price_cache_directory = loadEnvValue("PRICE_CACHE_DIR", ".env");
+    if (price_cache_directory.empty()) price_cache_directory = "price_cache";
+
     // Constants for retry logic
     const int MAX_RETRIES = 3;
     const int RETRY_DELAY_SECONDS = 3; // Increased delay between retries
-    const int API_CALL_DELAY_SECONDS = 1; // Delay between API calls for different symbols
 
     try {
-        // Create market data provider
-        MarketDataProvider market_data(alpha_vantage_api_key);
+        // Create market data provider; quote requests are paced by the client's rate limiter
+        MarketDataProvider market_data(std::make_unique<AlphaVantageFeed>(
+            alpha_vantage_api_key, requests_per_minute, price_cache_directory));
         
         // List of stock symbols
         std::vector<std::string> stock_symbols = {"TSLA", "NVDA", "AMZN", "AAPL", "GOOG"};
@@ -175,23 +276,25 @@ int main() {
         // Get expiration dates (next 3 Fridays)
         std::vector<std::time_t> expirations = {getNextFriday(0), getNextFriday(1), getNextFriday(4)};
         
-        for (const auto& symbol : stock_symbols) {
-            bool success = false;
-            
-            // Try up to MAX_RETRIES times
-            for (int retry = 0; retry < MAX_RETRIES && !success; retry++) {
-                if (retry > 0) {
-                    std::cout << "Retrying " << symbol << " (attempt " << retry+1 << "/" 
-                              << MAX_RETRIES << "). Waiting " << RETRY_DELAY_SECONDS 
-                              << " seconds..." << std::endl;
-                    
-                    std::this_thread::sleep_for(std::chrono::seconds(RETRY_DELAY_SECONDS));
-                }
+        // Fetch all quotes concurrently; retry only the symbols that failed
+        std::vector<std::string> pending = stock_symbols;
+        for (int retry = 0; retry < MAX_RETRIES && !pending.empty(); retry++) {
+            if (retry > 0) {
+                std::cout << "Retrying " << pending.size() << " symbol(s) (attempt " << retry+1 << "/" 
+                          << MAX_RETRIES << "). Waiting " << RETRY_DELAY_SECONDS 
+                          << " seconds..." << std::endl;
                 
-                success = market_data.updateCurrentPrice(symbol);
+                std::this_thread::sleep_for(std::chrono::seconds(RETRY_DELAY_SECONDS));
             }
             
-            if (!success) {
+            const std::vector<std::string> updated = market_data.updateCurrentPrices(pending);
+            pending.erase(std::remove_if(pending.begin(), pending.end(), [&](const std::string& symbol) {
+                return std::find(updated.begin(), updated.end(), symbol) != updated.end();
+            }), pending.end());
+        }
+        
+        for (const auto& symbol : stock_symbols) {
+            if (std::find(pending.begin(), pending.end(), symbol) != pending.end()) {
                 std::cerr << "Failed to fetch current price for " << symbol 
                           << " after " << MAX_RETRIES << " attempts" << std::endl;
                 continue;
@@ -230,13 +333,6 @@ int main() {
                 }
             }
             std::cout << "================================================================================\n";
-            
-            // Add delay between processing different symbols to respect API rate limits
-            if (&symbol != &stock_symbols.back()) {
-                std::cout << "Waiting " << API_CALL_DELAY_SECONDS 
-                          << " seconds before processing next symbol..." << std::endl;
-                std::this_thread::sleep_for(std::chrono::seconds(API_CALL_DELAY_SECONDS));
-            }
         }
     }
     catch (const std::exception& e) {
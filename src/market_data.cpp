@@ -3,31 +3,156 @@
 #include "paper_feed.h"
 #include <algorithm>
 
-MarketDataProvider::MarketDataProvider(std::unique_ptr<DataFeedInterface> feed)
-    : feed_(std::move(feed)) {}
+namespace {
+// A failed or pending refresh is not retried for a symbol more often than this
+constexpr std::chrono::seconds REFRESH_RETRY_INTERVAL{5};
+}
+
+MarketDataProvider::MarketDataProvider(std::unique_ptr<DataFeedInterface> feed, std::chrono::milliseconds quote_ttl)
+    : feed_(std::move(feed)), quotes_(std::make_unique<QuoteStore>(quote_ttl)) {}
 
 MarketDataProvider::MarketDataProvider(const std::string& alpha_vantage_api_key)
-    : feed_(std::make_unique<AlphaVantageFeed>(alpha_vantage_api_key)) {}
+    : MarketDataProvider(std::make_unique<AlphaVantageFeed>(alpha_vantage_api_key)) {}
+
+MarketDataProvider::~MarketDataProvider() {
+    {
+        std::lock_guard<std::mutex> lock(refresh_mutex_);
+        stopping_ = true;
+    }
+    refresh_wake_.notify_all();
+    if (refresher_.joinable()) refresher_.join();
+}
+
+void MarketDataProvider::storeFetched(const std::vector<std::string>& symbols, const std::vector<OptionalDouble>& prices,
+                                      std::vector<std::string>* updated) const {
+    for (std::size_t i = 0; i < symbols.size() && i < prices.size(); ++i) {
+        if (!prices[i]) continue;
+        storeQuote(quotes_->intern(symbols[i]), *prices[i], SOURCE_FEED);
+        if (updated) updated->push_back(symbols[i]);
+    }
+}
+
+void MarketDataProvider::storeQuote(SymbolId id, double price, QuoteSource source) const {
+    Quote previous;
+    const bool changed = !quotes_->read(id, previous) || previous.price != price;
+    quotes_->write(id, price, source);
+    if (!changed) return;
+    std::lock_guard<std::mutex> lock(listeners_mutex_);
+    for (const auto& entry : listeners_) entry.second(id, price);
+}
+
+std::size_t MarketDataProvider::subscribe(QuoteListener listener) {
+    std::lock_guard<std::mutex> lock(listeners_mutex_);
+    const std::size_t token = next_listener_token_++;
+    listeners_.emplace_back(token, std::move(listener));
+    return token;
+}
+
+void MarketDataProvider::unsubscribe(std::size_t token) {
+    std::lock_guard<std::mutex> lock(listeners_mutex_);
+    listeners_.erase(std::remove_if(listeners_.begin(), listeners_.end(),
+                                    [token](const auto& entry) { return entry.first == token; }),
+                     listeners_.end());
+}
 
 bool MarketDataProvider::updateCurrentPrice(const std::string& symbol) {
-    OptionalDouble price = feed_->getCurrentPrice(symbol);
+    OptionalDouble price;
+    {
+        std::lock_guard<std::mutex> lock(feed_mutex_);
+        price = feed_->getCurrentPrice(symbol);
+    }
     if (price) {
-        current_prices_cache_[symbol] = *price;
+        storeQuote(quotes_->intern(symbol), *price, SOURCE_FEED);
         return true;
     }
     return false;
 }
 
+std::vector<std::string> MarketDataProvider::updateCurrentPrices(const std::vector<std::string>& symbols) {
+    std::vector<std::string> updated;
+    std::vector<OptionalDouble> prices;
+    {
+        std::lock_guard<std::mutex> lock(feed_mutex_);
+        prices = feed_->getCurrentPrices(symbols);
+    }
+    storeFetched(symbols, prices, &updated);
+    return updated;
+}
+
 void MarketDataProvider::setCurrentPrice(const std::string& symbol, double price) {
-    current_prices_cache_[symbol] = price;
+    storeQuote(quotes_->intern(symbol), price, SOURCE_MANUAL);
+    std::lock_guard<std::mutex> lock(feed_mutex_);
     feed_->setCurrentPrice(symbol, price);
 }
 
 OptionalDouble MarketDataProvider::getCurrentPrice(const std::string& symbol) const {
-    auto it = current_prices_cache_.find(symbol);
-    if (it != current_prices_cache_.end())
-        return OptionalDouble(it->second);
-    return feed_->getCurrentPrice(symbol);
+    return getCurrentPrice(quotes_->intern(symbol));
+}
+
+OptionalDouble MarketDataProvider::getCurrentPrice(SymbolId id) const {
+    Quote quote;
+    const bool cached = quotes_->read(id, quote);
+    refreshIfStale(id, cached ? &quote : nullptr);
+    return cached ? OptionalDouble(quote.price) : OptionalDouble();
+}
+
+bool MarketDataProvider::isStaleQuote(const std::string& symbol, int max_age_seconds) const {
+    SymbolId id;
+    if (!quotes_->find(symbol, id)) return true;
+    return max_age_seconds < 0 ? quotes_->isStale(id) : quotes_->isStale(id, std::chrono::seconds(max_age_seconds));
+}
+
+void MarketDataProvider::requestRefresh(const std::string& symbol) const {
+    const SymbolId id = quotes_->intern(symbol);
+    if (quotes_->claimRefresh(id, REFRESH_RETRY_INTERVAL)) enqueueRefresh(id);
+}
+
+void MarketDataProvider::refreshIfStale(SymbolId id, const Quote* quote) const {
+    if (quote && quote->source == SOURCE_MANUAL) return;
+    if (quote && !quotes_->isStale(id)) return;
+    if (quotes_->claimRefresh(id, REFRESH_RETRY_INTERVAL)) enqueueRefresh(id);
+}
+
+void MarketDataProvider::enqueueRefresh(SymbolId id) const {
+    {
+        std::lock_guard<std::mutex> lock(refresh_mutex_);
+        if (stopping_) return;
+        refresh_queue_.push_back(id);
+        if (!refresher_.joinable()) refresher_ = std::thread([this] { refreshLoop(); });
+    }
+    refresh_wake_.notify_one();
+}
+
+void MarketDataProvider::refreshLoop() const {
+    for (;;) {
+        std::vector<SymbolId> batch;
+        {
+            std::unique_lock<std::mutex> lock(refresh_mutex_);
+            refresh_wake_.wait(lock, [this] { return stopping_ || !refresh_queue_.empty(); });
+            if (stopping_) return;
+            batch.swap(refresh_queue_);
+        }
+        std::sort(batch.begin(), batch.end());
+        batch.erase(std::unique(batch.begin(), batch.end()), batch.end());
+        std::vector<std::string> symbols;
+        symbols.reserve(batch.size());
+        for (SymbolId id : batch) symbols.push_back(quotes_->symbol(id));
+
+        // One feed call for everything queued; feeds like AlphaVantageFeed overlap the requests
+        std::vector<OptionalDouble> prices;
+        try {
+            std::lock_guard<std::mutex> lock(feed_mutex_);
+            prices = feed_->getCurrentPrices(symbols);
+        } catch (const std::exception&) {
+            continue;  // retried on a later read once REFRESH_RETRY_INTERVAL has passed
+        }
+        // A manual price set while the fetch was in flight wins
+        for (std::size_t i = 0; i < batch.size() && i < prices.size(); ++i) {
+            Quote current;
+            if (quotes_->read(batch[i], current) && current.source == SOURCE_MANUAL) prices[i] = OptionalDouble();
+        }
+        storeFetched(symbols, prices, nullptr);
+    }
 }
 
 bool MarketDataProvider::fetchHistoricalPrices(
@@ -35,13 +160,16 @@ bool MarketDataProvider::fetchHistoricalPrices(
     const std::string& start_date,
     const std::string& end_date
 ) {
+    std::lock_guard<std::mutex> lock(feed_mutex_);
     return feed_->fetchHistoricalPrices(symbol, start_date, end_date);
 }
 
-std::vector<StockPrice> MarketDataProvider::getHistoricalPrices(const std::string& symbol) const {
+PriceSeriesView MarketDataProvider::getHistoricalPrices(const std::string& symbol) const {
+    std::lock_guard<std::mutex> lock(feed_mutex_);
     return feed_->getHistoricalPrices(symbol);
 }
 
 std::string MarketDataProvider::lastError() const {
+    std::lock_guard<std::mutex> lock(feed_mutex_);
     return feed_ ? feed_->lastError() : std::string();
 }
@@ -1,56 +1,438 @@
 #include "monte_carlo.h"
+#include "thread_pool.h"
+#include "black_scholes.h"
+#include "random_streams.h"
+#include "fast_math.h"
+#include "instrumentation.h"
+#include <memory>
 #include <random>
-#include <future>
 #include <algorithm>
-#include <thread>
+#include <array>
+#include <mutex>
 
 namespace {
 
-constexpr int MIN_CHUNK = 500;
+// Fixed so the chunk -> seed mapping (and hence the result) doesn't depend on the thread count
+constexpr int CHUNK_SIMULATIONS = MonteCarloOptionPricer::CHUNK_SIMULATIONS;
+constexpr int PATHS_PER_BLOCK = 64;
 constexpr double TRADING_DAYS_PER_YEAR = 252.0;
+constexpr std::uint64_t SOBOL_SCRAMBLE_STREAM = 0x50B01ull;  // chunkSeed index of the Sobol' scramble
 
-double runCallChunk(double spot, double strike, double r, double vol, double T,
-                   int sim_begin, int sim_end, unsigned seed) noexcept {
-    const double dt = T / TRADING_DAYS_PER_YEAR;
-    const double sqrt_dt = std::sqrt(dt);
-    const int steps = static_cast<int>(TRADING_DAYS_PER_YEAR * T);
-    std::mt19937 gen(seed);
-    std::normal_distribution<> dist(0.0, 1.0);
-    double sum = 0.0;
-    for (int i = sim_begin; i < sim_end; ++i) {
-        (void)i;
-        double S = spot;
-        for (int t = 0; t < steps; ++t) {
-            double z = dist(gen);
-            S *= std::exp((r - 0.5 * vol * vol) * dt + vol * sqrt_dt * z);
+std::mt19937 makeGenerator(std::uint64_t seed) {
+    std::seed_seq seq{static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32)};
+    return std::mt19937(seq);
+}
+
+std::uint64_t randomSeed() {
+    std::random_device rd;
+    return (static_cast<std::uint64_t>(rd()) << 32) ^ rd();
+}
+
+struct EuropeanContract {
+    double spot;
+    double strike;
+    double rate;
+    double vol;
+    double T;
+    OptionType type;
+};
+
+double europeanPayoff(OptionType type, double strike, double S_T) noexcept {
+    return type == CALL ? std::max(S_T - strike, 0.0) : std::max(strike - S_T, 0.0);
+}
+
+// Running moments of (payoff Y, control C), mergeable across chunks (Chan et al.), so the
+// variance and covariance never come from a difference of large sums.
+struct PathStats {
+    double count{0.0};
+    double mean_y{0.0};
+    double mean_c{0.0};
+    double m2_y{0.0};
+    double m2_c{0.0};
+    double co_yc{0.0};
+
+    void add(double y, double c) noexcept {
+        count += 1.0;
+        const double dy = y - mean_y;
+        const double dc = c - mean_c;
+        mean_y += dy / count;
+        mean_c += dc / count;
+        m2_y += dy * (y - mean_y);
+        m2_c += dc * (c - mean_c);
+        co_yc += dy * (c - mean_c);
+    }
+
+    void merge(const PathStats& other) noexcept {
+        if (other.count == 0.0) return;
+        if (count == 0.0) {
+            *this = other;
+            return;
         }
-        sum += std::max(S - strike, 0.0);
+        const double n = count + other.count;
+        const double dy = other.mean_y - mean_y;
+        const double dc = other.mean_c - mean_c;
+        const double w = count * other.count / n;
+        m2_y += other.m2_y + dy * dy * w;
+        m2_c += other.m2_c + dc * dc * w;
+        co_yc += other.co_yc + dy * dc * w;
+        mean_y += dy * other.count / n;
+        mean_c += dc * other.count / n;
+        count = n;
     }
-    return sum;
-}
-
-double runPutChunk(double spot, double strike, double r, double vol, double T,
-                  int sim_begin, int sim_end, unsigned seed) noexcept {
-    const double dt = T / TRADING_DAYS_PER_YEAR;
-    const double sqrt_dt = std::sqrt(dt);
-    const int steps = static_cast<int>(TRADING_DAYS_PER_YEAR * T);
-    std::mt19937 gen(seed);
-    std::normal_distribution<> dist(0.0, 1.0);
-    double sum = 0.0;
-    for (int i = sim_begin; i < sim_end; ++i) {
-        (void)i;
-        double S = spot;
-        for (int t = 0; t < steps; ++t) {
-            double z = dist(gen);
-            S *= std::exp((r - 0.5 * vol * vol) * dt + vol * sqrt_dt * z);
+};
+
+// Rescale z[0..n) to sample mean 0 (unless already symmetric) and unit second moment
+void matchMoments(double* z, int n, bool recentre) noexcept {
+    if (n < 2) return;
+    double mean = 0.0;
+    if (recentre) {
+        for (int i = 0; i < n; ++i) mean += z[i];
+        mean /= n;
+    }
+    double m2 = 0.0;
+    for (int i = 0; i < n; ++i) m2 += (z[i] - mean) * (z[i] - mean);
+    const double scale = m2 > 0.0 ? 1.0 / std::sqrt(m2 / n) : 1.0;
+    for (int i = 0; i < n; ++i) z[i] = (z[i] - mean) * scale;
+}
+
+// Normal draws for a run, shared read-only by every chunk. fill() writes `draws` rows of
+// `steps` normals, row-major (z[i * steps + t]), for rows first_draw .. first_draw + draws - 1.
+// Philox and Sobol' derive row n from n alone, so a row is the same whichever chunk or thread
+// asks for it; the mt19937 source reproduces the original per-chunk streams.
+class NormalSource {
+public:
+    NormalSource(const MonteCarloConfig& config, int steps)
+        : generator_(config.generator), seed_(config.seed), steps_(steps) {
+        if (generator_ == RNG_SOBOL) {
+            sobol_ = std::make_unique<SobolSequence>(
+                static_cast<unsigned>(steps),
+                MonteCarloOptionPricer::chunkSeed(config.seed, SOBOL_SCRAMBLE_STREAM));
+            if (config.brownian_bridge && steps > 1) bridge_ = std::make_unique<BrownianBridge>(steps);
+        }
+    }
+
+    void fill(std::uint64_t first_draw, std::uint64_t chunk_seed, int draws, double* z) const {
+        const size_t steps = static_cast<size_t>(steps_);
+        if (generator_ == RNG_MT19937) {
+            // Step-major like the original simulation, so mt19937 runs keep their results
+            std::mt19937 gen = makeGenerator(chunk_seed);
+            std::normal_distribution<> dist(0.0, 1.0);
+            for (size_t t = 0; t < steps; ++t) {
+                for (int i = 0; i < draws; ++i) z[static_cast<size_t>(i) * steps + t] = dist(gen);
+            }
+            return;
+        }
+        if (generator_ == RNG_PHILOX) {
+            Philox4x32::fillStreams(seed_, first_draw, static_cast<size_t>(draws), steps, z);
+            InverseNormal::transform(z, static_cast<size_t>(draws) * steps);
+            return;
+        }
+        sobol_->fill(first_draw, static_cast<size_t>(draws), z);
+        InverseNormal::transform(z, static_cast<size_t>(draws) * steps);
+        if (bridge_) {
+            std::vector<double> point(steps);
+            for (int i = 0; i < draws; ++i) {
+                double* row = z + static_cast<size_t>(i) * steps;
+                std::copy(row, row + steps, point.begin());
+                bridge_->transform(point.data(), row);
+            }
+        }
+    }
+
+private:
+    MonteCarloGenerator generator_;
+    std::uint64_t seed_;
+    int steps_;
+    std::unique_ptr<SobolSequence> sobol_;
+    std::unique_ptr<BrownianBridge> bridge_;
+};
+
+int stepCount(const EuropeanContract& c, const MonteCarloConfig& config) {
+    return config.sampling == SAMPLING_STEPPED ? MonteCarloOptionPricer::steppedStepCount(c.T) : 1;
+}
+
+// The normals of one chunk, step by step: z[0..num_paths) holds step t's draws after
+// drawStep(t), with antithetic mirroring and moment matching applied across the chunk.
+class ChunkNormals {
+public:
+    ChunkNormals(const NormalSource& normals, long long first_path, int num_paths, int steps, std::uint64_t seed,
+                 const MonteCarloConfig& config)
+        : antithetic_((config.variance_reduction & VR_ANTITHETIC) != 0),
+          moment_matching_((config.variance_reduction & VR_MOMENT_MATCHING) != 0),
+          num_paths_(num_paths),
+          steps_(steps),
+          draws_(antithetic_ ? num_paths / 2 : num_paths),  // num_paths is even when antithetic
+          rows_(static_cast<size_t>(draws_) * static_cast<size_t>(steps)),
+          z_(static_cast<size_t>(num_paths)) {
+        normals.fill(static_cast<std::uint64_t>(antithetic_ ? first_path / 2 : first_path), seed, draws_, rows_.data());
+    }
+
+    const double* drawStep(int t) {
+        for (int i = 0; i < draws_; ++i) {
+            z_[static_cast<size_t>(i)] = rows_[static_cast<size_t>(i) * steps_ + static_cast<size_t>(t)];
+        }
+        if (antithetic_) {
+            for (int i = 0; i < draws_; ++i) z_[static_cast<size_t>(draws_ + i)] = -z_[static_cast<size_t>(i)];
+        }
+        if (moment_matching_) matchMoments(z_.data(), num_paths_, !antithetic_);
+        return z_.data();
+    }
+
+    bool antithetic() const { return antithetic_; }
+    int draws() const { return draws_; }
+
+private:
+    bool antithetic_;
+    bool moment_matching_;
+    int num_paths_;
+    int steps_;
+    int draws_;
+    std::vector<double> rows_;
+    std::vector<double> z_;
+};
+
+// One chunk of paths first_path .. first_path + num_paths - 1. The normals for every path are
+// drawn up front, then the paths advance step-major so antithetic pairing and moment matching
+// act across paths. Terminal sampling is the one-step case, S_T = S exp((r - sigma^2/2) T +
+// sigma sqrt(T) z), exact for GBM; the stepped mode takes daily steps for path-dependent
+// payoffs. Log-returns are accumulated, so either way there is one exp per path.
+//
+// Statistics go to stats[c.type]; with both_types the other payoff is scored on the same
+// terminal prices as well.
+void runChunk(const EuropeanContract& c, long long first_path, int num_paths, std::uint64_t seed,
+              const NormalSource& normals, const MonteCarloConfig& config, bool both_types,
+              PathStats stats[2]) {
+    BS_TIMED_SCOPE(METRIC_MC_CHUNK);
+    const int steps = stepCount(c, config);
+    const double dt = c.T / steps;
+    const double drift = (c.rate - 0.5 * c.vol * c.vol) * dt;
+    const double diffusion = c.vol * std::sqrt(dt);
+    const bool control = (config.variance_reduction & VR_CONTROL_VARIATE) != 0;
+    ChunkNormals chunk_normals(normals, first_path, num_paths, steps, seed, config);
+    const bool antithetic = chunk_normals.antithetic();
+    const int draws = chunk_normals.draws();
+
+    std::vector<double> log_return(static_cast<size_t>(num_paths), 0.0);
+    for (int t = 0; t < steps; ++t) {
+        const double* z = chunk_normals.drawStep(t);
+        for (int i = 0; i < num_paths; ++i) {
+            log_return[static_cast<size_t>(i)] += drift + diffusion * z[i];
+        }
+    }
+
+    const double discount = std::exp(-c.rate * c.T);
+    std::vector<double> S_T(static_cast<size_t>(num_paths));
+    for (int i = 0; i < num_paths; ++i) {
+        S_T[static_cast<size_t>(i)] = c.spot * std::exp(log_return[static_cast<size_t>(i)]);
+    }
+    auto score = [&](OptionType type, PathStats& out) {
+        auto sample = [&](int i, double& y, double& ctrl) {
+            const double s = S_T[static_cast<size_t>(i)];
+            y = discount * europeanPayoff(type, c.strike, s);
+            ctrl = control ? discount * std::max(s - c.strike, 0.0) : 0.0;
+        };
+        for (int i = 0; i < draws; ++i) {
+            double y, ctrl;
+            sample(i, y, ctrl);
+            if (antithetic) {
+                // A pair is one sample: the two halves are not independent
+                double y2, ctrl2;
+                sample(draws + i, y2, ctrl2);
+                y = 0.5 * (y + y2);
+                ctrl = 0.5 * (ctrl + ctrl2);
+            }
+            out.add(y, ctrl);
+        }
+    };
+    score(c.type, stats[c.type]);
+    if (both_types) {
+        const OptionType other = c.type == CALL ? PUT : CALL;
+        score(other, stats[other]);
+    }
+}
+
+MonteCarloResult finishEstimate(const EuropeanContract& c, const PathStats& stats, const MonteCarloConfig& config) {
+    MonteCarloResult result;
+    const bool antithetic = (config.variance_reduction & VR_ANTITHETIC) != 0;
+    result.num_paths = static_cast<long long>(stats.count) * (antithetic ? 2 : 1);
+    result.price = stats.mean_y;
+    if (stats.count < 2.0) return result;
+
+    double variance = stats.m2_y / (stats.count - 1.0);
+    if ((config.variance_reduction & VR_CONTROL_VARIATE) != 0 && stats.m2_c > 0.0) {
+        const double beta = stats.co_yc / stats.m2_c;
+        const double control_mean = BlackScholes::calculateCallPrice(c.spot, c.strike, c.rate, c.vol, c.T);
+        result.price = stats.mean_y - beta * (stats.mean_c - control_mean);
+        variance = std::max(0.0, (stats.m2_y - beta * stats.co_yc) / (stats.count - 1.0));
+    }
+    result.std_error = std::sqrt(variance / stats.count);
+    return result;
+}
+
+struct PathModel {
+    double spot;
+    double drift;      // (r - sigma^2/2) dt
+    double diffusion;  // sigma sqrt(dt)
+    int steps;
+};
+
+// Paths first .. first + count - 1: step t of path k goes to dest[k * path_stride + t * step_stride].
+// The paths advance together one step at a time, so the inner loop runs across paths and
+// vectorizes whatever the destination layout. Scratch is per thread and reused across blocks.
+void simulatePathBlock(const PathModel& m, const NormalSource& normals, std::uint64_t block_seed,
+                       int first, int count, double* dest, size_t path_stride, size_t step_stride) {
+    thread_local std::vector<double> z_buffer;
+    thread_local std::vector<double> price_buffer;
+    const size_t steps = static_cast<size_t>(m.steps);
+    const size_t n = static_cast<size_t>(count);
+    z_buffer.resize(n * steps);
+    price_buffer.assign(n, m.spot);
+    normals.fill(static_cast<std::uint64_t>(first), block_seed, count, z_buffer.data());
+
+    const double* z = z_buffer.data();
+    double* price = price_buffer.data();
+    const double drift = m.drift;
+    const double diffusion = m.diffusion;
+    for (size_t k = 0; k < n; ++k) dest[k * path_stride] = m.spot;
+    for (size_t t = 1; t <= steps; ++t) {
+        double* slice = dest + t * step_stride;
+        for (size_t k = 0; k < n; ++k) {
+            price[k] *= FastMath::exp(drift + diffusion * z[k * steps + t - 1]);
+        }
+        for (size_t k = 0; k < n; ++k) slice[k * path_stride] = price[k];
+    }
+}
+
+// Splits the paths into fixed blocks of PATHS_PER_BLOCK and runs run_block(block, first, count)
+// on the executor; block b is always paths [b * PATHS_PER_BLOCK, ...), so output is reproducible.
+template <typename BlockFn>
+void forEachPathBlock(int num_paths, const MonteCarloConfig& config, const BlockFn& run_block) {
+    const int num_blocks = (num_paths + PATHS_PER_BLOCK - 1) / PATHS_PER_BLOCK;
+    TaskExecutor& executor = config.executor ? *config.executor : TaskExecutor::shared();
+    executor.parallelFor(static_cast<size_t>(num_blocks), [&](size_t block) {
+        const int first = static_cast<int>(block) * PATHS_PER_BLOCK;
+        run_block(block, first, std::min(PATHS_PER_BLOCK, num_paths - first));
+    });
+}
+
+PathModel makePathModel(double spot, double rate, double vol, double T, int steps) {
+    const double dt = T / steps;
+    return {spot, (rate - 0.5 * vol * vol) * dt, vol * std::sqrt(dt), steps};
+}
+
+// Runs fixed-size chunks on the executor; chunk statistics are merged in chunk order, so the
+// result is bit-for-bit the same for a given seed regardless of which thread ran which chunk.
+// Chunk indices keep counting across target_std_error waves, so waves are reproducible too.
+// Results are indexed by OptionType; with both_types the waves continue until both meet the
+// target. Once config.cancel is set, chunks not yet started are skipped and the estimate from
+// the finished ones is returned.
+std::array<MonteCarloResult, 2> priceOnExecutor(const EuropeanContract& contract, const MonteCarloConfig& config,
+                                                bool both_types) {
+    const bool antithetic = (config.variance_reduction & VR_ANTITHETIC) != 0;
+    auto round_paths = [antithetic](long long n) { return antithetic ? n + (n & 1) : n; };
+    auto cancelled = [&config] { return config.cancel && config.cancel->load(std::memory_order_relaxed); };
+    const long long cap = round_paths(std::max(config.max_simulations, config.num_simulations));
+    long long planned = round_paths(std::max(1, config.num_simulations));
+    long long simulated = 0;
+    std::size_t first_chunk = 0;
+    PathStats total[2];
+    std::mutex progress_mutex;
+    long long done = 0;
+    TaskExecutor& executor = config.executor ? *config.executor : TaskExecutor::shared();
+    const NormalSource normals(config, stepCount(contract, config));
+
+    for (;;) {
+        const long long wave = planned - simulated;
+        const std::size_t num_chunks = static_cast<std::size_t>((wave + CHUNK_SIMULATIONS - 1) / CHUNK_SIMULATIONS);
+        std::vector<std::array<PathStats, 2>> chunk_stats(num_chunks);
+        executor.parallelFor(num_chunks, [&](std::size_t j) {
+            if (cancelled()) return;
+            const long long begin = simulated + static_cast<long long>(j) * CHUNK_SIMULATIONS;
+            const int count = static_cast<int>(std::min<long long>(CHUNK_SIMULATIONS, planned - begin));
+            runChunk(contract, begin, count, MonteCarloOptionPricer::chunkSeed(config.seed, first_chunk + j),
+                     normals, config, both_types, chunk_stats[j].data());
+            if (config.progress_cb) {
+                std::lock_guard<std::mutex> lock(progress_mutex);
+                done += count;
+                config.progress_cb(static_cast<int>(done), static_cast<int>(planned));
+            }
+        });
+        for (const auto& stats : chunk_stats) {
+            total[CALL].merge(stats[CALL]);
+            total[PUT].merge(stats[PUT]);
         }
-        sum += std::max(strike - S, 0.0);
+        simulated = planned;
+        first_chunk += num_chunks;
+
+        std::array<MonteCarloResult, 2> results{finishEstimate(contract, total[CALL], config),
+                                                finishEstimate(contract, total[PUT], config)};
+        const double std_error = both_types ? std::max(results[CALL].std_error, results[PUT].std_error)
+                                            : results[contract.type].std_error;
+        if (cancelled()) {
+            results[CALL].cancelled = results[PUT].cancelled = true;
+            return results;
+        }
+        if (config.target_std_error <= 0.0 || std_error <= config.target_std_error || simulated >= cap) {
+            return results;
+        }
+        // Error falls like 1/sqrt(n): aim 10% past the estimate, at least one more chunk
+        const double ratio = std_error / config.target_std_error;
+        const double needed = 1.1 * static_cast<double>(simulated) * ratio * ratio;
+        const long long next = std::max(simulated + CHUNK_SIMULATIONS,
+                                        static_cast<long long>(std::min(needed, static_cast<double>(cap))));
+        planned = std::min(round_paths(next), cap);
     }
-    return sum;
 }
 
 } // namespace
 
+std::uint64_t MonteCarloOptionPricer::chunkSeed(std::uint64_t seed, std::uint64_t index) noexcept {
+    std::uint64_t z = seed + (index + 1) * 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+int MonteCarloOptionPricer::steppedStepCount(double time_to_expiry) {
+    return std::max(1, static_cast<int>(std::lround(TRADING_DAYS_PER_YEAR * time_to_expiry)));
+}
+
+void MonteCarloOptionPricer::simulatePathChunks(
+    double spot_price, double risk_free_rate, double volatility, double time_to_expiry, int steps,
+    long long first_path, long long num_paths, std::size_t first_chunk, const MonteCarloConfig& config,
+    const MonteCarloChunkCallback& on_chunk
+) {
+    if (num_paths <= 0 || steps <= 0) return;
+    const PathModel model = makePathModel(spot_price, risk_free_rate, volatility, time_to_expiry, steps);
+    const NormalSource normals(config, steps);
+    const std::size_t num_chunks = static_cast<std::size_t>((num_paths + CHUNK_SIMULATIONS - 1) / CHUNK_SIMULATIONS);
+    TaskExecutor& executor = config.executor ? *config.executor : TaskExecutor::shared();
+    executor.parallelFor(num_chunks, [&](std::size_t j) {
+        if (config.cancel && config.cancel->load(std::memory_order_relaxed)) return;
+        BS_TIMED_SCOPE(METRIC_MC_CHUNK);
+        const long long begin = first_path + static_cast<long long>(j) * CHUNK_SIMULATIONS;
+        const int count = static_cast<int>(std::min<long long>(CHUNK_SIMULATIONS, first_path + num_paths - begin));
+        ChunkNormals chunk_normals(normals, begin, count, steps, chunkSeed(config.seed, first_chunk + j), config);
+
+        // Not thread_local: on_chunk may itself run simulations on this thread
+        const size_t n = static_cast<size_t>(count);
+        std::vector<double> prices((static_cast<size_t>(steps) + 1) * n);
+        std::vector<double> draws(static_cast<size_t>(steps) * n);
+        std::vector<double> log_return(n, 0.0);
+        std::fill(prices.begin(), prices.begin() + static_cast<std::ptrdiff_t>(n), model.spot);
+        for (int t = 0; t < steps; ++t) {
+            const double* z = chunk_normals.drawStep(t);
+            std::copy(z, z + n, draws.begin() + static_cast<std::ptrdiff_t>(static_cast<size_t>(t) * n));
+            double* slice = prices.data() + (static_cast<size_t>(t) + 1) * n;
+            for (size_t k = 0; k < n; ++k) {
+                log_return[k] += model.drift + model.diffusion * z[k];
+                slice[k] = model.spot * FastMath::exp(log_return[k]);
+            }
+        }
+        on_chunk(MonteCarloPathChunk{j, begin, count, steps, chunk_normals.antithetic(), prices.data(), draws.data()});
+    });
+}
+
 double MonteCarloOptionPricer::priceCallOption(
     double spot_price, double strike_price, double risk_free_rate,
     double volatility, double time_to_expiry, int num_simulations
@@ -64,27 +446,18 @@ double MonteCarloOptionPricer::priceCallOption(
     double volatility, double time_to_expiry, int num_simulations,
     MonteCarloProgressCallback progress_cb
 ) {
-    int n = std::max(1, num_simulations);
-    unsigned n_workers = static_cast<unsigned>(std::max(1, static_cast<int>(std::thread::hardware_concurrency())));
-    int chunk_size = std::max(MIN_CHUNK, static_cast<int>(n / n_workers));
-    std::vector<std::future<double>> futures;
-    int done = 0;
-    std::random_device rd;
-    for (int start = 0; start < n; ) {
-        int end = std::min(start + chunk_size, n);
-        unsigned seed = rd();
-        futures.push_back(std::async(std::launch::async, runCallChunk,
-                                     spot_price, strike_price, risk_free_rate, volatility, time_to_expiry,
-                                     start, end, seed));
-        start = end;
-    }
-    double sum_payoffs = 0.0;
-    for (size_t i = 0; i < futures.size(); ++i) {
-        sum_payoffs += futures[i].get();
-        done = std::min(static_cast<int>((i + 1) * chunk_size), n);
-        if (progress_cb) progress_cb(done, n);
-    }
-    return std::exp(-risk_free_rate * time_to_expiry) * (sum_payoffs / n);
+    MonteCarloConfig config;
+    config.num_simulations = num_simulations;
+    config.seed = randomSeed();
+    config.progress_cb = std::move(progress_cb);
+    return priceCallOption(spot_price, strike_price, risk_free_rate, volatility, time_to_expiry, config);
+}
+
+double MonteCarloOptionPricer::priceCallOption(
+    double spot_price, double strike_price, double risk_free_rate,
+    double volatility, double time_to_expiry, const MonteCarloConfig& config
+) {
+    return priceOption(spot_price, strike_price, risk_free_rate, volatility, time_to_expiry, CALL, config).price;
 }
 
 double MonteCarloOptionPricer::pricePutOption(
@@ -100,49 +473,95 @@ double MonteCarloOptionPricer::pricePutOption(
     double volatility, double time_to_expiry, int num_simulations,
     MonteCarloProgressCallback progress_cb
 ) {
-    int n = std::max(1, num_simulations);
-    unsigned n_workers = static_cast<unsigned>(std::max(1, static_cast<int>(std::thread::hardware_concurrency())));
-    int chunk_size = std::max(MIN_CHUNK, static_cast<int>(n / n_workers));
-    std::vector<std::future<double>> futures;
-    int done = 0;
-    std::random_device rd;
-    for (int start = 0; start < n; ) {
-        int end = std::min(start + chunk_size, n);
-        unsigned seed = rd();
-        futures.push_back(std::async(std::launch::async, runPutChunk,
-                                     spot_price, strike_price, risk_free_rate, volatility, time_to_expiry,
-                                     start, end, seed));
-        start = end;
-    }
-    double sum_payoffs = 0.0;
-    for (size_t i = 0; i < futures.size(); ++i) {
-        sum_payoffs += futures[i].get();
-        done = std::min(static_cast<int>((i + 1) * chunk_size), n);
-        if (progress_cb) progress_cb(done, n);
-    }
-    return std::exp(-risk_free_rate * time_to_expiry) * (sum_payoffs / n);
+    MonteCarloConfig config;
+    config.num_simulations = num_simulations;
+    config.seed = randomSeed();
+    config.progress_cb = std::move(progress_cb);
+    return pricePutOption(spot_price, strike_price, risk_free_rate, volatility, time_to_expiry, config);
+}
+
+double MonteCarloOptionPricer::pricePutOption(
+    double spot_price, double strike_price, double risk_free_rate,
+    double volatility, double time_to_expiry, const MonteCarloConfig& config
+) {
+    return priceOption(spot_price, strike_price, risk_free_rate, volatility, time_to_expiry, PUT, config).price;
+}
+
+MonteCarloResult MonteCarloOptionPricer::priceOption(
+    double spot_price, double strike_price, double risk_free_rate,
+    double volatility, double time_to_expiry, OptionType option_type, const MonteCarloConfig& config
+) {
+    const EuropeanContract contract{spot_price, strike_price, risk_free_rate, volatility, time_to_expiry, option_type};
+    return priceOnExecutor(contract, config, false)[option_type];
+}
+
+MonteCarloCallPutResult MonteCarloOptionPricer::priceCallAndPut(
+    double spot_price, double strike_price, double risk_free_rate,
+    double volatility, double time_to_expiry, const MonteCarloConfig& config
+) {
+    const EuropeanContract contract{spot_price, strike_price, risk_free_rate, volatility, time_to_expiry, CALL};
+    const std::array<MonteCarloResult, 2> results = priceOnExecutor(contract, config, true);
+    return {results[CALL], results[PUT]};
 }
 
 std::vector<std::vector<double>> MonteCarloOptionPricer::simulatePricePaths(
     double spot_price, double risk_free_rate, double volatility,
     double time_to_expiry, int num_paths, int steps_per_path
 ) {
-    const double dt = time_to_expiry / steps_per_path;
-    const double sqrt_dt = std::sqrt(dt);
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::normal_distribution<> dist(0.0, 1.0);
-    std::vector<std::vector<double>> paths(static_cast<size_t>(num_paths),
-                                           std::vector<double>(static_cast<size_t>(steps_per_path + 1), 0.0));
-    for (int i = 0; i < num_paths; ++i)
-        paths[static_cast<size_t>(i)][0] = spot_price;
-    for (int i = 0; i < num_paths; ++i) {
-        for (int t = 1; t <= steps_per_path; ++t) {
-            double z = dist(gen);
-            paths[static_cast<size_t>(i)][static_cast<size_t>(t)] =
-                paths[static_cast<size_t>(i)][static_cast<size_t>(t - 1)] * std::exp(
-                    (risk_free_rate - 0.5 * volatility * volatility) * dt + volatility * sqrt_dt * z);
+    MonteCarloConfig config;
+    config.seed = randomSeed();
+    return simulatePricePaths(spot_price, risk_free_rate, volatility, time_to_expiry,
+                              num_paths, steps_per_path, config);
+}
+
+std::vector<std::vector<double>> MonteCarloOptionPricer::simulatePricePaths(
+    double spot_price, double risk_free_rate, double volatility,
+    double time_to_expiry, int num_paths, int steps_per_path, const MonteCarloConfig& config
+) {
+    std::vector<std::vector<double>> paths(static_cast<size_t>(std::max(num_paths, 0)));
+    streamPricePaths(spot_price, risk_free_rate, volatility, time_to_expiry, num_paths, steps_per_path, config,
+                     [&paths, steps_per_path](int first_path, int count, const double* prices) {
+        const size_t row = static_cast<size_t>(steps_per_path) + 1;
+        for (int k = 0; k < count; ++k) {
+            const double* path = prices + static_cast<size_t>(k) * row;
+            paths[static_cast<size_t>(first_path + k)].assign(path, path + row);
         }
-    }
+    });
     return paths;
 }
+
+void MonteCarloOptionPricer::simulatePricePaths(
+    double spot_price, double risk_free_rate, double volatility,
+    double time_to_expiry, int num_paths, int steps_per_path, const MonteCarloConfig& config,
+    double* out, PathLayout layout
+) {
+    if (num_paths <= 0 || steps_per_path <= 0) return;
+    const PathModel model = makePathModel(spot_price, risk_free_rate, volatility, time_to_expiry, steps_per_path);
+    const NormalSource normals(config, steps_per_path);
+    const size_t row = static_cast<size_t>(steps_per_path) + 1;
+    const bool path_major = layout == LAYOUT_PATH_MAJOR;
+    const size_t path_stride = path_major ? row : 1;
+    const size_t step_stride = path_major ? 1 : static_cast<size_t>(num_paths);
+    forEachPathBlock(num_paths, config, [&](size_t block, int first, int count) {
+        simulatePathBlock(model, normals, chunkSeed(config.seed, block), first, count,
+                          out + static_cast<size_t>(first) * path_stride, path_stride, step_stride);
+    });
+}
+
+void MonteCarloOptionPricer::streamPricePaths(
+    double spot_price, double risk_free_rate, double volatility,
+    double time_to_expiry, int num_paths, int steps_per_path, const MonteCarloConfig& config,
+    const MonteCarloPathCallback& on_block
+) {
+    if (num_paths <= 0 || steps_per_path <= 0) return;
+    const PathModel model = makePathModel(spot_price, risk_free_rate, volatility, time_to_expiry, steps_per_path);
+    const NormalSource normals(config, steps_per_path);
+    const size_t row = static_cast<size_t>(steps_per_path) + 1;
+    forEachPathBlock(num_paths, config, [&](size_t block, int first, int count) {
+        // Not thread_local: on_block may itself run path simulations on this thread
+        std::vector<double> block_prices(static_cast<size_t>(count) * row);
+        simulatePathBlock(model, normals, chunkSeed(config.seed, block), first, count,
+                          block_prices.data(), row, 1);
+        on_block(first, count, block_prices.data());
+    });
+}
@@ -23,14 +23,20 @@
 #include <QBarCategoryAxis>
 #include <QValueAxis>
 #include <QDateTime>
+#include <QProgressBar>
+#include <QRandomGenerator>
+#include <QThread>
+#include <QElapsedTimer>
 
 #include "../include/option.h"
 #include "../include/black_scholes.h"
 #include "../include/black_scholes_greeks.h"
 #include "../include/market_data.h"
 #include "../include/historical_volatility.h"
+#include "../include/rolling_volatility.h"
 #include "../include/monte_carlo.h"
 #include "../include/option_strategy.h"
+#include "../include/instrumentation.h"
 
 OptionsCalculatorGUI::OptionsCalculatorGUI(QWidget *parent) : QMainWindow(parent) {
         setWindowTitle("Options Calculator");
@@ -48,6 +54,15 @@ OptionsCalculatorGUI::OptionsCalculatorGUI(QWidget *parent) : QMainWindow(parent
         setCentralWidget(tabWidget);
 }
 
+OptionsCalculatorGUI::~OptionsCalculatorGUI() {
+        // The worker's lambdas reference this window: stop it before the members go away
+        if (mcWorker) {
+            mcCancelRequested = true;
+            mcWorker->wait();
+            delete mcWorker;
+        }
+}
+
 void OptionsCalculatorGUI::calculateOptionPrices() {
         QString symbol = symbolInput->text().trimmed();
         if (symbol.isEmpty()) {
@@ -63,23 +78,14 @@ void OptionsCalculatorGUI::calculateOptionPrices() {
         int daysToExpiry = daysToExpiryInput->value();
         double timeToExpiry = daysToExpiry / 365.0;
         
-        // Calculate option prices using Black-Scholes
-        double callPrice = BlackScholes::calculateCallPrice(
-            spotPrice, strikePrice, riskFreeRate, volatility, timeToExpiry
-        );
-        
-        double putPrice = BlackScholes::calculatePutPrice(
-            spotPrice, strikePrice, riskFreeRate, volatility, timeToExpiry
-        );
-        
-        // Calculate Greeks
-        OptionGreeks callGreeks = BlackScholesGreeks::calculateCallGreeks(
-            spotPrice, strikePrice, riskFreeRate, volatility, timeToExpiry
-        );
-        
-        OptionGreeks putGreeks = BlackScholesGreeks::calculatePutGreeks(
+        // Calculate option prices and Greeks using Black-Scholes (one fused evaluation)
+        const OptionValuation valuation = BlackScholesGreeks::calculateAll(
             spotPrice, strikePrice, riskFreeRate, volatility, timeToExpiry
         );
+        double callPrice = valuation.call_price;
+        double putPrice = valuation.put_price;
+        const OptionGreeks& callGreeks = valuation.call_greeks;
+        const OptionGreeks& putGreeks = valuation.put_greeks;
         
         // Update results
         callPriceOutput->setText(QString::number(callPrice, 'f', 2));
@@ -137,8 +143,8 @@ void OptionsCalculatorGUI::analyzeStrategy() {
             double maxLoss = strategy->calculateMaxLoss();
             auto breakevens = strategy->calculateBreakevens();
             
-            strategyMaxProfitOutput->setText(QString::number(maxProfit, 'f', 2));
-            strategyMaxLossOutput->setText(QString::number(maxLoss, 'f', 2));
+            strategyMaxProfitOutput->setText(std::isinf(maxProfit) ? QString("Unlimited") : QString::number(maxProfit, 'f', 2));
+            strategyMaxLossOutput->setText(std::isinf(maxLoss) ? QString("Unlimited") : QString::number(maxLoss, 'f', 2));
             
             QString breakevenStr;
             for (size_t i = 0; i < breakevens.size(); ++i) {
@@ -208,6 +214,8 @@ void OptionsCalculatorGUI::calculateHistoricalVolatility() {
 }
 
 void OptionsCalculatorGUI::runMonteCarloSimulation() {
+        if (mcWorker) return;  // one run at a time
+
         double spotPrice = mcSpotPriceInput->value();
         double strikePrice = mcStrikePriceInput->value();
         double riskFreeRate = mcRiskFreeRateInput->value() / 100.0;
@@ -217,15 +225,6 @@ void OptionsCalculatorGUI::runMonteCarloSimulation() {
         int numSimulations = mcSimCountInput->value();
         
         try {
-            // Price options using Monte Carlo
-            double mcCallPrice = MonteCarloOptionPricer::priceCallOption(
-                spotPrice, strikePrice, riskFreeRate, volatility, timeToExpiry, numSimulations
-            );
-            
-            double mcPutPrice = MonteCarloOptionPricer::pricePutOption(
-                spotPrice, strikePrice, riskFreeRate, volatility, timeToExpiry, numSimulations
-            );
-            
             // Calculate Black-Scholes prices for comparison
             double bsCallPrice = BlackScholes::calculateCallPrice(
                 spotPrice, strikePrice, riskFreeRate, volatility, timeToExpiry
@@ -235,19 +234,96 @@ void OptionsCalculatorGUI::runMonteCarloSimulation() {
                 spotPrice, strikePrice, riskFreeRate, volatility, timeToExpiry
             );
             
-            // Display results
-            mcCallPriceOutput->setText(QString::number(mcCallPrice, 'f', 2));
-            mcPutPriceOutput->setText(QString::number(mcPutPrice, 'f', 2));
-            
             bsCallPriceOutput->setText(QString::number(bsCallPrice, 'f', 2));
             bsPutPriceOutput->setText(QString::number(bsPutPrice, 'f', 2));
-            
-            // Generate and display price paths
-            updateMonteCarloChart(spotPrice, riskFreeRate, volatility, timeToExpiry);
-            
         } catch (const std::exception& e) {
             QMessageBox::warning(this, "Error", QString("Monte Carlo simulation failed: %1").arg(e.what()));
+            return;
         }
+
+        mcCancelRequested = false;
+        mcRunButton->setEnabled(false);
+        mcCancelButton->setEnabled(true);
+        mcProgressBar->setRange(0, numSimulations);
+        mcProgressBar->setValue(0);
+        mcCallPriceOutput->setText("...");
+        mcPutPriceOutput->setText("...");
+        mcStatusLabel->setText("Running...");
+
+        // Call and put come from one pass over the same paths, off the UI thread; progress and
+        // results are posted back to it through queued invocations.
+        MonteCarloConfig config;
+        config.num_simulations = numSimulations;
+        config.seed = QRandomGenerator::global()->generate64();
+        config.cancel = &mcCancelRequested;
+        config.progress_cb = [this](int done, int total) {
+            QMetaObject::invokeMethod(this, [this, done, total] {
+                mcProgressBar->setMaximum(total);
+                mcProgressBar->setValue(done);
+            }, Qt::QueuedConnection);
+        };
+
+        mcWorker = QThread::create([=] {
+            try {
+                QElapsedTimer timer;
+                timer.start();
+                const MonteCarloCallPutResult result = MonteCarloOptionPricer::priceCallAndPut(
+                    spotPrice, strikePrice, riskFreeRate, volatility, timeToExpiry, config
+                );
+                const qint64 elapsedNs = timer.nsecsElapsed();
+                QMetaObject::invokeMethod(this, [=] {
+                    showMonteCarloResults(result, spotPrice, riskFreeRate, volatility, timeToExpiry);
+                    showMonteCarloStatus(result.call.num_paths, elapsedNs);
+                }, Qt::QueuedConnection);
+            } catch (const std::exception& e) {
+                const QString message = e.what();
+                QMetaObject::invokeMethod(this, [this, message] {
+                    QMessageBox::warning(this, "Error", QString("Monte Carlo simulation failed: %1").arg(message));
+                }, Qt::QueuedConnection);
+            }
+        });
+        connect(mcWorker, &QThread::finished, this, [this] {
+            mcWorker->deleteLater();
+            mcWorker = nullptr;
+            mcRunButton->setEnabled(true);
+            mcCancelButton->setEnabled(false);
+        });
+        mcWorker->start();
+}
+
+void OptionsCalculatorGUI::cancelMonteCarloSimulation() {
+        // Chunks already running finish; the rest are skipped
+        mcCancelRequested = true;
+        mcCancelButton->setEnabled(false);
+}
+
+void OptionsCalculatorGUI::showMonteCarloStatus(long long numPaths, qint64 elapsedNs) {
+        QString status = QString("%1 paths in %2 ms").arg(numPaths).arg(elapsedNs / 1e6, 0, 'f', 1);
+        if (elapsedNs > 0) status += QString(" (%1 M paths/s)").arg(numPaths * 1e3 / elapsedNs, 0, 'f', 2);
+        // Chunk latency over every run so far (all zero when instrumentation is compiled out)
+        const LatencySummary chunks = Instrumentation::summary()[METRIC_MC_CHUNK];
+        if (chunks.count) {
+            status += QString(", chunk p50 %1 us / p99 %2 us").arg(chunks.p50_ns / 1e3, 0, 'f', 0)
+                                                            .arg(chunks.p99_ns / 1e3, 0, 'f', 0);
+        }
+        mcStatusLabel->setText(status);
+}
+
+void OptionsCalculatorGUI::showMonteCarloResults(const MonteCarloCallPutResult& result, double spotPrice,
+                                                 double riskFreeRate, double volatility, double timeToExpiry) {
+        if (result.call.num_paths == 0) {
+            mcCallPriceOutput->setText("Cancelled");
+            mcPutPriceOutput->setText("Cancelled");
+            return;
+        }
+        const QString suffix = result.call.cancelled
+            ? QString(" (cancelled, %1 paths)").arg(result.call.num_paths)
+            : QString();
+        mcCallPriceOutput->setText(QString::number(result.call.price, 'f', 2) + suffix);
+        mcPutPriceOutput->setText(QString::number(result.put.price, 'f', 2) + suffix);
+        
+        // Generate and display price paths
+        updateMonteCarloChart(spotPrice, riskFreeRate, volatility, timeToExpiry);
 }
 
 void OptionsCalculatorGUI::createOptionCalculatorTab(QTabWidget *tabWidget) {
@@ -420,6 +496,9 @@ void OptionsCalculatorGUI::createStrategyAnalyzerTab(QTabWidget *tabWidget) {
         strategyTypeCombo->addItem("Bull Call Spread");
         strategyTypeCombo->addItem("Bear Put Spread");
         strategyTypeCombo->addItem("Straddle");
+        strategyTypeCombo->addItem("Strangle");
+        strategyTypeCombo->addItem("Iron Condor");
+        strategyTypeCombo->addItem("Butterfly");
         inputLayout->addWidget(strategyTypeCombo, 5, 1);
         
         QPushButton *analyzeButton = new QPushButton("Analyze Strategy");
@@ -559,14 +638,26 @@ void OptionsCalculatorGUI::createMonteCarloTab(QTabWidget *tabWidget) {
         
         inputLayout->addWidget(new QLabel("Simulation Count:"), 5, 0);
         mcSimCountInput = new QSpinBox();
-        mcSimCountInput->setRange(100, 10000);
+        mcSimCountInput->setRange(100, 10000000);
         mcSimCountInput->setValue(1000);
         mcSimCountInput->setSingleStep(100);
         inputLayout->addWidget(mcSimCountInput, 5, 1);
         
-        QPushButton *runSimButton = new QPushButton("Run Simulation");
-        inputLayout->addWidget(runSimButton, 6, 0, 1, 2);
-        connect(runSimButton, &QPushButton::clicked, this, &OptionsCalculatorGUI::runMonteCarloSimulation);
+        mcRunButton = new QPushButton("Run Simulation");
+        inputLayout->addWidget(mcRunButton, 6, 0);
+        connect(mcRunButton, &QPushButton::clicked, this, &OptionsCalculatorGUI::runMonteCarloSimulation);
+        
+        mcCancelButton = new QPushButton("Cancel");
+        mcCancelButton->setEnabled(false);
+        inputLayout->addWidget(mcCancelButton, 6, 1);
+        connect(mcCancelButton, &QPushButton::clicked, this, &OptionsCalculatorGUI::cancelMonteCarloSimulation);
+        
+        mcProgressBar = new QProgressBar();
+        mcProgressBar->setRange(0, 1);
+        mcProgressBar->setValue(0);
+        inputLayout->addWidget(mcProgressBar, 7, 0, 1, 2);
+        mcStatusLabel = new QLabel("");
+        inputLayout->addWidget(mcStatusLabel, 8, 0, 1, 2);
         
         inputGroup->setLayout(inputLayout);
         topLayout->addWidget(inputGroup);
@@ -613,18 +704,24 @@ void OptionsCalculatorGUI::updateStrategyChart(OptionStrategy* strategy, double
         
         QtCharts::QLineSeries *pnlSeries = new QtCharts::QLineSeries();
         pnlSeries->setName("Profit/Loss at Expiry");
-        
-        // Calculate P/L at expiry for different price points
+        QtCharts::QLineSeries *currentSeries = new QtCharts::QLineSeries();
+        currentSeries->setName("Profit/Loss Today");
+        
+        // P/L at expiry and today over the whole price range, one batched pass each
+        std::vector<double> prices(numPoints), expiryPnl(numPoints), currentPnl(numPoints);
+        for (int i = 0; i < numPoints; ++i) prices[i] = minPrice + i * priceStep;
+        strategy->calculateCurve(prices.data(), prices.size(), 0.0, nullptr, expiryPnl.data(), nullptr);
+        strategy->calculateCurve(prices.data(), prices.size(), daysToExpiry / 365.0, nullptr, currentPnl.data(), nullptr);
         for (int i = 0; i < numPoints; ++i) {
-            double price = minPrice + i * priceStep;
-            double pnl = strategy->calculateProfitLoss(price);
-            pnlSeries->append(price, pnl);
+            pnlSeries->append(prices[i], expiryPnl[i]);
+            currentSeries->append(prices[i], currentPnl[i]);
         }
         
         // Set up chart
         QtCharts::QChart *chart = new QtCharts::QChart();
         chart->addSeries(pnlSeries);
-        chart->setTitle("Strategy Profit/Loss at Expiry");
+        chart->addSeries(currentSeries);
+        chart->setTitle("Strategy Profit/Loss");
         
         QtCharts::QValueAxis *axisX = new QtCharts::QValueAxis();
         axisX->setTitleText("Stock Price");
@@ -638,6 +735,8 @@ void OptionsCalculatorGUI::updateStrategyChart(OptionStrategy* strategy, double
         
         chart->addAxis(axisY, Qt::AlignLeft);
         pnlSeries->attachAxis(axisY);
+        currentSeries->attachAxis(axisX);
+        currentSeries->attachAxis(axisY);
         
         // Add zero line
         QtCharts::QLineSeries *zeroLine = new QtCharts::QLineSeries();
@@ -659,19 +758,28 @@ void OptionsCalculatorGUI::updateVolatilityChart(const std::vector<double>& pric
         QtCharts::QChart *chart = new QtCharts::QChart();
         chart->setTitle("Historical Volatility Analysis");
         
-        // Create multiple series with different window sizes
-        std::vector<int> windows = {10, 20, 30};
+        // Create multiple series with different window sizes, all from one rolling pass
+        RollingVolatilityConfig volConfig;
+        volConfig.windows = {10, 20, 30};
+        const std::vector<int>& windows = volConfig.windows;
         QStringList categories;
         
-        for (int window : windows) {
-            if (prices.size() <= window) continue;
+        std::vector<std::int32_t> days(prices.size());
+        for (size_t i = 0; i < days.size(); ++i) days[i] = static_cast<std::int32_t>(i);
+        PriceSeries priceSeries(std::move(days));
+        priceSeries.setColumn(FIELD_CLOSE, prices);
+        const RollingVolatilitySeries rolling = RollingVolatilityEngine::compute(priceSeries.view(), volConfig);
+        
+        for (size_t w = 0; w < windows.size(); ++w) {
+            const int window = windows[w];
+            if (prices.size() <= static_cast<size_t>(window)) continue;
             
             QtCharts::QLineSeries *series = new QtCharts::QLineSeries();
             series->setName(QString("%1-Day Volatility").arg(window));
+            const double* rollingVol = rolling.series(VOL_CLOSE_TO_CLOSE, w);
             
             for (size_t i = window; i < prices.size(); ++i) {
-                std::vector<double> windowPrices(prices.begin() + (i - window), prices.begin() + i + 1);
-                double vol = HistoricalVolatility::calculateFromPrices(windowPrices) * 100.0;
+                double vol = rollingVol[i] * 100.0;
                 
                 int dayIndex = static_cast<int>(prices.size() - i - 1);
                 series->append(dayIndex, vol);
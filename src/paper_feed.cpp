@@ -1,4 +1,5 @@
 #include "paper_feed.h"
+#include <utility>
 
 OptionalDouble PaperFeed::getCurrentPrice(const std::string& symbol) const {
     auto it = current_prices_.find(symbol);
@@ -12,13 +13,18 @@ void PaperFeed::setCurrentPrice(const std::string& symbol, double price) {
 }
 
 bool PaperFeed::fetchHistoricalPrices(const std::string& symbol, const std::string&, const std::string&) {
-    (void)symbol;
-    return false;
+    // Nothing to download: succeed only for series installed via setHistoricalPrices
+    auto it = historical_prices_.find(symbol);
+    return it != historical_prices_.end() && !it->second.empty();
 }
 
-std::vector<StockPrice> PaperFeed::getHistoricalPrices(const std::string& symbol) const {
+PriceSeriesView PaperFeed::getHistoricalPrices(const std::string& symbol) const {
     auto it = historical_prices_.find(symbol);
     if (it != historical_prices_.end())
-        return it->second;
+        return it->second.view();
     return {};
 }
+
+void PaperFeed::setHistoricalPrices(const std::string& symbol, PriceSeries series) {
+    historical_prices_[symbol] = std::move(series);
+}
@@ -1,11 +1,14 @@
 #include "../include/paper_trading.h"
 #include "../include/black_scholes.h"
+#include "../include/black_scholes_batch.h"
+#include "../include/instrumentation.h"
 #include <iostream>
 #include <algorithm>
 #include <stdexcept>
 #include <iomanip>
 #include <ctime>
 #include <cmath>
+#include <limits>
 
 // Constructor with initial balance and API key
 PaperTradingSystem::PaperTradingSystem(double initial_balance, const std::string& alpha_vantage_api_key)
@@ -13,36 +16,129 @@ PaperTradingSystem::PaperTradingSystem(double initial_balance, const std::string
       initial_balance(initial_balance),
       market_data(alpha_vantage_api_key)
 {
+    quote_subscription = market_data.subscribe([this](SymbolId underlying, double) { markDirty(underlying); });
+}
+
+PaperTradingSystem::PaperTradingSystem(double initial_balance, std::unique_ptr<DataFeedInterface> feed)
+    : cash_balance(initial_balance),
+      initial_balance(initial_balance),
+      market_data(std::move(feed))
+{
+    quote_subscription = market_data.subscribe([this](SymbolId underlying, double) { markDirty(underlying); });
+}
+
+PaperTradingSystem::~PaperTradingSystem() {
+    market_data.unsubscribe(quote_subscription);
+}
+
+void PaperTradingSystem::setClock(Clock new_clock) {
+    clock = std::move(new_clock);
+}
+
+std::time_t PaperTradingSystem::now() const {
+    return clock ? clock() : std::time(nullptr);
+}
+
+void PaperTradingSystem::setConsoleLogging(bool enabled) {
+    console_logging = enabled;
+}
+
+void PaperTradingSystem::markDirty(SymbolId underlying) {
+    std::lock_guard<std::mutex> lock(dirty_mutex);
+    if (underlying >= underlying_dirty.size()) underlying_dirty.resize(underlying + 1, 0);
+    if (underlying_dirty[underlying]) return;
+    underlying_dirty[underlying] = 1;
+    dirty_underlyings.push_back(underlying);
 }
 
 void PaperTradingSystem::updateOptionPricesFromMarket(double risk_free_rate, double volatility) {
-    const std::time_t now = std::time(nullptr);
-    for (auto& position : open_positions) {
-        const std::string underlying = position.option.getSymbol();
+    for (SymbolId underlying : positions.underlyings()) markDirty(underlying);
+    repriceDirtyPositions(risk_free_rate, volatility);
+}
+
+std::size_t PaperTradingSystem::repriceDirtyPositions(double risk_free_rate, double default_volatility) {
+    BS_TIMED_SCOPE(METRIC_REPRICE);
+    std::vector<SymbolId> dirty;
+    {
+        std::lock_guard<std::mutex> lock(dirty_mutex);
+        dirty.swap(dirty_underlyings);
+        for (SymbolId id : dirty) underlying_dirty[id] = 0;
+    }
+
+    const std::time_t now = this->now();
+    std::size_t repriced = 0;
+    for (SymbolId underlying : dirty) {
+        const std::vector<std::uint32_t>& rows = positions.rowsFor(underlying);
+        if (rows.empty()) continue;
         auto spot_opt = market_data.getCurrentPrice(underlying);
         if (!spot_opt || *spot_opt <= 0) continue;
-        double spot = *spot_opt;
-        double time_to_expiry = std::max(0.0, std::difftime(position.option.getExpirationDate(), now) / (365.25 * 24 * 60 * 60));
-        double fair_value;
-        if (position.option.getType() == CALL) {
-            fair_value = BlackScholes::calculateCallPrice(spot, position.option.getStrikePrice(),
-                                                          risk_free_rate, volatility, time_to_expiry);
-        } else {
-            fair_value = BlackScholes::calculatePutPrice(spot, position.option.getStrikePrice(),
-                                                         risk_free_rate, volatility, time_to_expiry);
+
+        // Gather the underlying's rows into one SoA batch (buffers are reused across passes)
+        const std::size_t n = rows.size();
+        batch_strike.resize(n);
+        batch_vol.resize(n);
+        batch_expiry.resize(n);
+        batch_type.resize(n);
+        batch_price.resize(n);
+        batch_spot.assign(n, *spot_opt);
+        batch_rate.assign(n, risk_free_rate);
+        const double* strike = positions.strike();
+        const double* volatility = positions.volatility();
+        const std::time_t* expiry = positions.expiry();
+        const OptionType* type = positions.type();
+        for (std::size_t k = 0; k < n; ++k) {
+            const std::uint32_t row = rows[k];
+            batch_strike[k] = strike[row];
+            batch_expiry[k] = std::max(0.0, std::difftime(expiry[row], now) / (365.25 * 24 * 60 * 60));
+            batch_vol[k] = std::isnan(volatility[row])
+                ? VolSurface::lookup(&vol_surfaces, underlying, strike[row], batch_expiry[k], default_volatility)
+                : volatility[row];
+            batch_type[k] = type[row];
         }
-        position.option.setCurrentPrice(fair_value);
+        const OptionChainView chain{batch_spot.data(), batch_strike.data(), batch_rate.data(), batch_vol.data(),
+                                    batch_expiry.data(), batch_type.data(), n};
+        BlackScholesBatch::price(chain, batch_price.data(), nullptr);
+        double* mark = positions.mark();
+        for (std::size_t k = 0; k < n; ++k) {
+            if (std::isnan(batch_price[k])) continue;  // invalid inputs: keep the last mark
+            mark[rows[k]] = batch_price[k];
+            ++repriced;
+        }
+    }
+    return repriced;
+}
+
+VolSurface& PaperTradingSystem::volSurface(const std::string& symbol) {
+    const SymbolId id = market_data.symbolId(symbol);
+    if (id >= vol_surfaces.size()) vol_surfaces.resize(id + 1);
+    if (!vol_surfaces[id]) vol_surfaces[id] = std::make_shared<VolSurface>();
+    return *vol_surfaces[id];
+}
+
+std::size_t PaperTradingSystem::fitVolSurfaces() {
+    const std::time_t fit_time = now();
+    std::size_t refit = 0;
+    for (SymbolId id = 0; id < vol_surfaces.size(); ++id) {
+        if (!vol_surfaces[id]) continue;
+        const std::size_t n = vol_surfaces[id]->fit(fit_time);
+        if (n) markDirty(id);
+        refit += n;
     }
+    return refit;
 }
 
 MarketDataProvider& PaperTradingSystem::getMarketData() {
     return market_data;
 }
 
-bool PaperTradingSystem::buyOption(const Option& option, int quantity) {
+const PositionBook& PaperTradingSystem::getPositions() const {
+    return positions;
+}
+
+bool PaperTradingSystem::buyOption(const Option& option, int quantity, double volatility) {
     // Validate inputs
     if (quantity <= 0) {
-        std::cerr << "Invalid quantity. Must be positive." << std::endl;
+        if (console_logging) std::cerr << "Invalid quantity. Must be positive." << std::endl;
         return false;
     }
 
@@ -53,18 +149,23 @@ bool PaperTradingSystem::buyOption(const Option& option, int quantity) {
 
     // Check if sufficient cash balance
     if (total_cost + transaction_fee > cash_balance) {
-        std::cerr << "Insufficient funds to buy option " << option.getSymbol() 
-                  << ". Required: $" << total_cost + transaction_fee 
-                  << ", Available: $" << cash_balance << std::endl;
+        if (console_logging) {
+            std::cerr << "Insufficient funds to buy option " << option.getSymbol()
+                      << ". Required: $" << total_cost + transaction_fee
+                      << ", Available: $" << cash_balance << std::endl;
+        }
         return false;
     }
 
-    // Create position
-    OptionPosition position{option, quantity, current_price, std::time(nullptr)};
-    open_positions.push_back(position);
+    // Open the position, or add to an open one on the same contract
+    const SymbolId underlying = market_data.symbolId(option.getSymbol());
+    positions.add(underlying, option.getType(), option.getStrikePrice(), option.getExpirationDate(), quantity,
+                  current_price, now(), volatility, current_price);
+    markDirty(underlying);
 
     // Update cash balance with cost and transaction fee
     cash_balance -= (total_cost + transaction_fee);
+    if (!console_logging) return true;
 
     std::cout << "Bought " << quantity << " " 
               << (option.getType() == CALL ? "Call" : "Put") 
@@ -75,18 +176,13 @@ bool PaperTradingSystem::buyOption(const Option& option, int quantity) {
 }
 
 bool PaperTradingSystem::sellOption(const Option& option, int quantity) {
-    // Find matching positions
-    auto pos_it = std::find_if(open_positions.begin(), open_positions.end(), 
-        [&option, quantity](const OptionPosition& pos) {
-            return pos.option.getSymbol() == option.getSymbol() && 
-                   pos.option.getType() == option.getType() && 
-                   pos.option.getStrikePrice() == option.getStrikePrice() &&
-                   pos.quantity >= quantity;
-        });
+    // Find the position on this contract
+    const std::size_t row = positions.find(PositionBook::makeKey(market_data.symbolId(option.getSymbol()), option.getType(),
+                                                                 option.getStrikePrice(), option.getExpirationDate()));
 
     // Check if position exists
-    if (pos_it == open_positions.end()) {
-        std::cerr << "No sufficient position to sell option " << option.getSymbol() << std::endl;
+    if (quantity <= 0 || row == PositionBook::NPOS || positions.quantity()[row] < quantity) {
+        if (console_logging) std::cerr << "No sufficient position to sell option " << option.getSymbol() << std::endl;
         return false;
     }
 
@@ -96,13 +192,11 @@ bool PaperTradingSystem::sellOption(const Option& option, int quantity) {
     double transaction_fee = 1.0 * quantity;  // Simple transaction fee model
 
     // Update position
-    pos_it->quantity -= quantity;
-    if (pos_it->quantity == 0) {
-        open_positions.erase(pos_it);
-    }
+    positions.reduce(row, quantity);
 
     // Update cash balance
     cash_balance += (total_revenue - transaction_fee);
+    if (!console_logging) return true;
 
     std::cout << "Sold " << quantity << " " 
               << (option.getType() == CALL ? "Call" : "Put") 
@@ -115,37 +209,87 @@ bool PaperTradingSystem::sellOption(const Option& option, int quantity) {
 double PaperTradingSystem::calculatePortfolioValue() const {
     double total_value = cash_balance;
 
-    for (const auto& position : open_positions) {
-        // Use current market price to value the position
-        total_value += position.option.getCurrentPrice() * position.quantity;
-    }
+    // Use current market price to value the positions
+    const double* mark = positions.mark();
+    const int* quantity = positions.quantity();
+    for (std::size_t row = 0; row < positions.size(); ++row) total_value += mark[row] * quantity[row];
 
     return total_value;
 }
 
-void PaperTradingSystem::closeExpiredPositions() {
-    std::time_t current_time = std::time(nullptr);
-
-    // Remove expired positions
-    auto it = open_positions.begin();
-    while (it != open_positions.end()) {
-        if (it->option.getExpirationDate() <= current_time) {
-            // Automatically cash out expired options
-            double current_price = it->option.getCurrentPrice();
-            cash_balance += current_price * it->quantity;
-            
-            std::cout << "Expired Position Closed: " 
-                      << it->quantity << " " 
-                      << (it->option.getType() == CALL ? "Call" : "Put") 
-                      << " options of " << it->option.getSymbol() 
-                      << " at $" << current_price << std::endl;
-            
-            // Remove the position
-            it = open_positions.erase(it);
-        } else {
-            ++it;
+const std::vector<double>& PaperTradingSystem::currentSpots() {
+    // Cached quotes only: spots that are missing stay NaN
+    std::fill(risk_spots.begin(), risk_spots.end(), std::numeric_limits<double>::quiet_NaN());
+    for (SymbolId underlying : positions.underlyings()) {
+        if (underlying >= risk_spots.size()) risk_spots.resize(underlying + 1, std::numeric_limits<double>::quiet_NaN());
+        auto spot = market_data.getCurrentPrice(underlying);
+        if (spot) risk_spots[underlying] = *spot;
+    }
+    return risk_spots;
+}
+
+PortfolioRisk PaperTradingSystem::calculateRisk(double risk_free_rate, double default_volatility) {
+    PortfolioRiskConfig config;
+    config.risk_free_rate = risk_free_rate;
+    config.default_volatility = default_volatility;
+    config.vol_surfaces = &vol_surfaces;
+    config.now = now();
+    return risk_engine.compute(positions, currentSpots(), config);
+}
+
+ScenarioCube PaperTradingSystem::runScenarios(const ScenarioGrid& grid, double risk_free_rate,
+                                              double default_volatility) {
+    ScenarioConfig config;
+    config.risk_free_rate = risk_free_rate;
+    config.default_volatility = default_volatility;
+    config.vol_surfaces = &vol_surfaces;
+    config.now = now();
+    const ScenarioPortfolio portfolio = ScenarioPortfolio::fromBook(positions, currentSpots(), config);
+    return ScenarioEngine::run(portfolio, grid, config);
+}
+
+void PaperTradingSystem::printRisk(const PortfolioRisk& risk) const {
+    const auto print_line = [](const std::string& label, const RiskTotals& totals) {
+        std::cout << "  " << std::left << std::setw(10) << label << std::right
+                  << " Value: $" << totals.value
+                  << " Delta: " << totals.delta
+                  << " Gamma: " << totals.gamma
+                  << " Theta: " << totals.theta
+                  << " Vega: " << totals.vega
+                  << " Rho: " << totals.rho << std::endl;
+    };
+    std::cout << "===== Portfolio Risk =====" << std::endl;
+    std::cout << std::fixed << std::setprecision(4);
+    print_line("Total", risk.total);
+    for (const UnderlyingRisk& group : risk.by_underlying) {
+        print_line(market_data.symbolName(group.underlying), group.total);
+        for (int b = 0; b < EXPIRY_BUCKET_COUNT; ++b) {
+            if (group.by_expiry[b].positions == 0) continue;
+            print_line("  " + std::string(PortfolioRiskEngine::bucketName(static_cast<ExpiryBucket>(b))),
+                       group.by_expiry[b]);
         }
     }
+    if (risk.unpriced) std::cout << "  (" << risk.unpriced << " positions without a usable quote)" << std::endl;
+    std::cout << "==========================" << std::endl;
+}
+
+void PaperTradingSystem::closeExpiredPositions() {
+    std::time_t current_time = now();
+
+    // Only positions due by now are visited (expiry-ordered heap)
+    positions.removeExpired(current_time, [this](std::size_t row) {
+        // Automatically cash out expired options
+        const double current_price = positions.mark()[row];
+        const int quantity = positions.quantity()[row];
+        cash_balance += current_price * quantity;
+        if (!console_logging) return;
+
+        std::cout << "Expired Position Closed: "
+                  << quantity << " "
+                  << (positions.type()[row] == CALL ? "Call" : "Put")
+                  << " options of " << market_data.symbolName(positions.underlying()[row])
+                  << " at $" << current_price << std::endl;
+    });
 }
 
 void PaperTradingSystem::printPortfolio() const {
@@ -167,16 +311,16 @@ void PaperTradingSystem::printPortfolio() const {
     
     // Open Positions Details
     std::cout << "\nOpen Positions:" << std::endl;
-    if (open_positions.empty()) {
+    if (positions.empty()) {
         std::cout << "No open positions." << std::endl;
     } else {
-        for (const auto& position : open_positions) {
-            std::cout << "- " << position.option.getSymbol() 
-                      << " " << (position.option.getType() == CALL ? "Call" : "Put")
-                      << " Strike: $" << position.option.getStrikePrice()
-                      << " Quantity: " << position.quantity
-                      << " Entry Price: $" << position.entry_price 
-                      << " Current Price: $" << position.option.getCurrentPrice()
+        for (std::size_t row = 0; row < positions.size(); ++row) {
+            std::cout << "- " << market_data.symbolName(positions.underlying()[row])
+                      << " " << (positions.type()[row] == CALL ? "Call" : "Put")
+                      << " Strike: $" << positions.strike()[row]
+                      << " Quantity: " << positions.quantity()[row]
+                      << " Entry Price: $" << positions.entryPrice()[row]
+                      << " Current Price: $" << positions.mark()[row]
                       << std::endl;
         }
     }
@@ -0,0 +1,142 @@
+#include "../include/portfolio_risk.h"
+#include "../include/black_scholes_greeks.h"
+#include "../include/instrumentation.h"
+#include "../include/thread_pool.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+constexpr std::size_t ROWS_PER_TASK = 4096;
+constexpr std::size_t TILE = 256;
+constexpr double SECONDS_PER_YEAR = 365.25 * 24 * 60 * 60;
+constexpr double BUCKET_LIMIT_DAYS[EXPIRY_BUCKET_COUNT - 1] = {7, 30, 90, 180, 365};
+const double NaN = std::numeric_limits<double>::quiet_NaN();
+}
+
+void RiskTotals::add(const RiskTotals& other) {
+    value += other.value;
+    delta += other.delta;
+    gamma += other.gamma;
+    theta += other.theta;
+    vega += other.vega;
+    rho += other.rho;
+    positions += other.positions;
+}
+
+ExpiryBucket PortfolioRiskEngine::bucketFor(double time_to_expiry_years) {
+    const double days = time_to_expiry_years * 365.25;
+    int bucket = 0;
+    while (bucket < EXPIRY_BUCKET_COUNT - 1 && days > BUCKET_LIMIT_DAYS[bucket]) ++bucket;
+    return static_cast<ExpiryBucket>(bucket);
+}
+
+const char* PortfolioRiskEngine::bucketName(ExpiryBucket bucket) {
+    switch (bucket) {
+        case EXPIRY_WEEK: return "<=1W";
+        case EXPIRY_MONTH: return "<=1M";
+        case EXPIRY_QUARTER: return "<=3M";
+        case EXPIRY_HALF_YEAR: return "<=6M";
+        case EXPIRY_YEAR: return "<=1Y";
+        case EXPIRY_LONG: return ">1Y";
+        default: return "?";
+    }
+}
+
+PortfolioRisk PortfolioRiskEngine::compute(const PositionBook& book, const std::vector<double>& spot_by_symbol,
+                                           const PortfolioRiskConfig& config) {
+    BS_TIMED_SCOPE(METRIC_PORTFOLIO_RISK);
+    const std::size_t n = book.size();
+    value_.resize(n);
+    delta_.resize(n);
+    gamma_.resize(n);
+    theta_.resize(n);
+    vega_.resize(n);
+    rho_.resize(n);
+    bucket_.resize(n);
+
+    TaskExecutor& executor = config.executor ? *config.executor : TaskExecutor::shared();
+    const std::time_t now = config.now ? config.now : std::time(nullptr);
+    const SymbolId* underlying = book.underlying();
+    const OptionType* type = book.type();
+    const double* strike = book.strike();
+    const std::time_t* expiry = book.expiry();
+    const int* quantity = book.quantity();
+    const double* volatility = book.volatility();
+
+    // Map: weighted Greeks per row, one contiguous row range per task
+    const std::size_t tasks = (n + ROWS_PER_TASK - 1) / ROWS_PER_TASK;
+    executor.parallelFor(tasks, [&](std::size_t task) {
+        const std::size_t end = std::min(n, (task + 1) * ROWS_PER_TASK);
+        double spot[TILE], rate[TILE], vol[TILE], years[TILE];
+        double call_price[TILE], put_price[TILE], call_delta[TILE], put_delta[TILE], gamma[TILE];
+        double call_theta[TILE], put_theta[TILE], vega[TILE], call_rho[TILE], put_rho[TILE];
+        const GreeksBatchOutput out{call_price, put_price, call_delta, put_delta, gamma,
+                                    call_theta, put_theta, vega, call_rho, put_rho};
+
+        for (std::size_t base = task * ROWS_PER_TASK; base < end; base += TILE) {
+            const std::size_t m = std::min(TILE, end - base);
+            for (std::size_t i = 0; i < m; ++i) {
+                const std::size_t row = base + i;
+                const SymbolId id = underlying[row];
+                spot[i] = id < spot_by_symbol.size() ? spot_by_symbol[id] : NaN;
+                rate[i] = config.risk_free_rate;
+                years[i] = std::max(0.0, std::difftime(expiry[row], now) / SECONDS_PER_YEAR);
+                vol[i] = std::isnan(volatility[row])
+                    ? VolSurface::lookup(config.vol_surfaces, id, strike[row], years[i], config.default_volatility)
+                    : volatility[row];
+            }
+            const OptionChainView chain{spot, strike + base, rate, vol, years, type + base, m};
+            BlackScholesGreeks::calculateAllBatch<OUTPUT_ALL>(chain, out, nullptr);
+
+            for (std::size_t i = 0; i < m; ++i) {
+                const std::size_t row = base + i;
+                const bool call = type[row] == CALL;
+                const double q = quantity[row];
+                value_[row] = q * (call ? call_price[i] : put_price[i]);
+                delta_[row] = q * (call ? call_delta[i] : put_delta[i]);
+                gamma_[row] = q * gamma[i];
+                theta_[row] = q * (call ? call_theta[i] : put_theta[i]);
+                vega_[row] = q * vega[i];
+                rho_[row] = q * (call ? call_rho[i] : put_rho[i]);
+                bucket_[row] = bucketFor(years[i]);
+            }
+        }
+    });
+
+    // Reduce: one underlying per index, rows summed in book order
+    std::vector<SymbolId> underlyings = book.underlyings();
+    std::sort(underlyings.begin(), underlyings.end());
+    std::vector<UnderlyingRisk> groups(underlyings.size());
+    std::vector<std::size_t> unpriced(underlyings.size(), 0);
+    executor.parallelFor(underlyings.size(), [&](std::size_t g) {
+        UnderlyingRisk& group = groups[g];
+        group.underlying = underlyings[g];
+        for (std::uint32_t row : book.rowsFor(group.underlying)) {
+            if (std::isnan(value_[row])) {
+                ++unpriced[g];
+                continue;
+            }
+            RiskTotals& bucket = group.by_expiry[bucket_[row]];
+            bucket.value += value_[row];
+            bucket.delta += delta_[row];
+            bucket.gamma += gamma_[row];
+            bucket.theta += theta_[row];
+            bucket.vega += vega_[row];
+            bucket.rho += rho_[row];
+            ++bucket.positions;
+        }
+        for (const RiskTotals& bucket : group.by_expiry) group.total.add(bucket);
+    });
+
+    PortfolioRisk risk;
+    risk.by_underlying.reserve(groups.size());
+    for (std::size_t g = 0; g < groups.size(); ++g) {
+        risk.unpriced += unpriced[g];
+        if (groups[g].total.positions == 0) continue;
+        risk.total.add(groups[g].total);
+        for (int b = 0; b < EXPIRY_BUCKET_COUNT; ++b) risk.by_expiry[b].add(groups[g].by_expiry[b]);
+        risk.by_underlying.push_back(groups[g]);
+    }
+    return risk;
+}
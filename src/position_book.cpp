@@ -0,0 +1,124 @@
+#include "../include/position_book.h"
+#include <stdexcept>
+#include <utility>
+
+std::size_t PositionBook::add(SymbolId underlying, OptionType type, double strike, std::time_t expiry, int quantity,
+                              double entry_price, std::time_t entry_time, double volatility, double mark) {
+    if (quantity <= 0) throw std::invalid_argument("PositionBook: quantity must be positive");
+    const PositionKey key = makeKey(underlying, type, strike, expiry);
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        const std::size_t row = it->second;
+        const double total = static_cast<double>(quantity_[row]) + quantity;
+        entry_price_[row] = (entry_price_[row] * quantity_[row] + entry_price * quantity) / total;
+        quantity_[row] += quantity;
+        mark_[row] = mark;
+        if (!std::isnan(volatility)) volatility_[row] = volatility;
+        return row;
+    }
+
+    const std::uint32_t row = static_cast<std::uint32_t>(size());
+    underlying_.push_back(underlying);
+    type_.push_back(type);
+    strike_.push_back(strike);
+    expiry_.push_back(expiry);
+    quantity_.push_back(quantity);
+    entry_price_.push_back(entry_price);
+    entry_time_.push_back(entry_time);
+    volatility_.push_back(volatility);
+    mark_.push_back(mark);
+    std::vector<std::uint32_t>& group = rows_by_underlying_[underlying];
+    group_slot_.push_back(static_cast<std::uint32_t>(group.size()));
+    group.push_back(row);
+    index_.emplace(key, row);
+    expiries_.push({expiry, key});
+    return row;
+}
+
+std::size_t PositionBook::find(const PositionKey& key) const {
+    auto it = index_.find(key);
+    return it != index_.end() ? it->second : NPOS;
+}
+
+void PositionBook::reduce(std::size_t row, int quantity) {
+    if (row >= size()) throw std::out_of_range("PositionBook: row");
+    if (quantity <= 0 || quantity > quantity_[row]) throw std::invalid_argument("PositionBook: invalid quantity to reduce");
+    quantity_[row] -= quantity;
+    if (quantity_[row] == 0) remove(row);
+}
+
+void PositionBook::remove(std::size_t row) {
+    if (row >= size()) throw std::out_of_range("PositionBook: row");
+
+    // Drop row from its underlying group (swap with the group's last entry)
+    auto group_it = rows_by_underlying_.find(underlying_[row]);
+    std::vector<std::uint32_t>& group = group_it->second;
+    const std::uint32_t slot = group_slot_[row];
+    group[slot] = group.back();
+    group_slot_[group[slot]] = slot;
+    group.pop_back();
+    if (group.empty()) rows_by_underlying_.erase(group_it);
+    index_.erase(key(row));
+
+    // Move the last row into the hole
+    const std::size_t last = size() - 1;
+    if (row != last) {
+        underlying_[row] = underlying_[last];
+        type_[row] = type_[last];
+        strike_[row] = strike_[last];
+        expiry_[row] = expiry_[last];
+        quantity_[row] = quantity_[last];
+        entry_price_[row] = entry_price_[last];
+        entry_time_[row] = entry_time_[last];
+        volatility_[row] = volatility_[last];
+        mark_[row] = mark_[last];
+        group_slot_[row] = group_slot_[last];
+        rows_by_underlying_[underlying_[row]][group_slot_[row]] = static_cast<std::uint32_t>(row);
+        index_[key(row)] = static_cast<std::uint32_t>(row);
+    }
+    underlying_.pop_back();
+    type_.pop_back();
+    strike_.pop_back();
+    expiry_.pop_back();
+    quantity_.pop_back();
+    entry_price_.pop_back();
+    entry_time_.pop_back();
+    volatility_.pop_back();
+    mark_.pop_back();
+    group_slot_.pop_back();
+    if (expiries_.size() > 2 * size()) compactExpiries();
+}
+
+void PositionBook::compactExpiries() {
+    std::vector<ExpiryEntry> entries;
+    entries.reserve(size());
+    for (std::size_t row = 0; row < size(); ++row) entries.push_back({expiry_[row], key(row)});
+    expiries_ = decltype(expiries_)(std::greater<ExpiryEntry>(), std::move(entries));
+}
+
+std::size_t PositionBook::removeExpired(std::time_t now, const std::function<void(std::size_t)>& on_expired) {
+    std::size_t removed = 0;
+    while (!expiries_.empty() && expiries_.top().expiry <= now) {
+        const PositionKey key = expiries_.top().key;
+        expiries_.pop();
+        const std::size_t row = find(key);
+        if (row == NPOS) continue;  // closed earlier
+        if (on_expired) on_expired(row);
+        remove(row);
+        ++removed;
+    }
+    return removed;
+}
+
+const std::vector<std::uint32_t>& PositionBook::rowsFor(SymbolId underlying) const {
+    static const std::vector<std::uint32_t> none;
+    auto it = rows_by_underlying_.find(underlying);
+    return it != rows_by_underlying_.end() ? it->second : none;
+}
+
+std::vector<SymbolId> PositionBook::underlyings() const {
+    std::vector<SymbolId> out;
+    out.reserve(rows_by_underlying_.size());
+    for (const auto& group : rows_by_underlying_) out.push_back(group.first);
+    return out;
+}
@@ -0,0 +1,32 @@
+#include "../include/price_series.h"
+#include <stdexcept>
+#include <utility>
+
+PriceSeries::PriceSeries(std::vector<std::int32_t> days) : days_(std::move(days)) {
+    for (std::size_t i = 1; i < days_.size(); ++i) {
+        if (days_[i] <= days_[i - 1]) {
+            throw std::invalid_argument("PriceSeries: days must be strictly ascending");
+        }
+    }
+}
+
+void PriceSeries::setColumn(PriceField field, std::vector<double> values) {
+    if (field >= PRICE_FIELD_COUNT) {
+        throw std::invalid_argument("PriceSeries: unknown field");
+    }
+    if (values.size() != days_.size()) {
+        throw std::invalid_argument("PriceSeries: column length does not match the day column");
+    }
+    columns_[field] = std::move(values);
+    present_[field] = true;
+}
+
+PriceSeriesView PriceSeries::view() const {
+    PriceSeriesView out;
+    out.days = days_.data();
+    out.size = days_.size();
+    for (unsigned f = 0; f < PRICE_FIELD_COUNT; ++f) {
+        out.fields[f] = present_[f] ? columns_[f].data() : nullptr;
+    }
+    return out;
+}
@@ -0,0 +1,210 @@
+#include "../include/price_store.h"
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define BS_PRICE_STORE_MMAP 1
+#endif
+
+namespace {
+constexpr char FILE_MAGIC[4] = {'B', 'S', 'P', 'S'};
+constexpr std::uint32_t FILE_VERSION = 1;
+constexpr const char* FILE_EXTENSION = ".bsp";
+
+struct FileHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint64_t count;
+    std::int32_t refreshed_day;
+    std::int32_t reserved0;
+    std::uint64_t reserved1;
+};
+static_assert(sizeof(FileHeader) == 32, "price store header must stay 32 bytes");
+
+// Byte offset of the adjusted-close column: the day column is padded so doubles stay aligned
+std::size_t closeOffset(std::size_t count) {
+    return sizeof(FileHeader) + (count * sizeof(std::int32_t) + 7) / 8 * 8;
+}
+
+std::size_t fileBytes(std::size_t count) {
+    return closeOffset(count) + count * sizeof(double);
+}
+
+// Write image to a new uniquely named file next to path and return its name, so concurrent
+// writers (threads or processes) never share a temp file before their renames
+std::string writeTempFile(const std::string& path, const std::vector<unsigned char>& image) {
+#ifdef BS_PRICE_STORE_MMAP
+    std::string temp_path = path + ".tmp.XXXXXX";
+    const int fd = ::mkstemp(&temp_path[0]);
+    if (fd < 0) throw std::runtime_error("PriceStore: cannot create a temp file for " + path);
+    ::fchmod(fd, 0644);  // mkstemp creates 0600
+    std::size_t written = 0;
+    while (written < image.size()) {
+        const ssize_t n = ::write(fd, image.data() + written, image.size() - written);
+        if (n <= 0) break;
+        written += static_cast<std::size_t>(n);
+    }
+    const bool closed = ::close(fd) == 0;
+    if (written != image.size() || !closed) {
+        ::unlink(temp_path.c_str());
+        throw std::runtime_error("PriceStore: failed to write " + temp_path);
+    }
+#else
+    static std::atomic<std::uint64_t> sequence{0};
+    const std::size_t thread = std::hash<std::thread::id>()(std::this_thread::get_id());
+    const std::string temp_path = path + ".tmp." + std::to_string(thread) + "." + std::to_string(sequence++);
+    {
+        std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+        if (!file.write(reinterpret_cast<const char*>(image.data()), static_cast<std::streamsize>(image.size()))) {
+            throw std::runtime_error("PriceStore: failed to write " + temp_path);
+        }
+    }
+#endif
+    return temp_path;
+}
+}
+
+// ---------------------------------------------------------------------------------------------
+
+MappedPriceSeries::~MappedPriceSeries() {
+    release();
+}
+
+MappedPriceSeries::MappedPriceSeries(MappedPriceSeries&& other) noexcept {
+    *this = std::move(other);
+}
+
+MappedPriceSeries& MappedPriceSeries::operator=(MappedPriceSeries&& other) noexcept {
+    if (this != &other) {
+        release();
+        mapping_ = std::exchange(other.mapping_, nullptr);
+        mapped_bytes_ = std::exchange(other.mapped_bytes_, 0);
+        buffer_ = std::move(other.buffer_);
+        size_ = std::exchange(other.size_, 0);
+        days_ = std::exchange(other.days_, nullptr);
+        adjusted_close_ = std::exchange(other.adjusted_close_, nullptr);
+        refreshed_day_ = std::exchange(other.refreshed_day_, 0);
+        other.buffer_.clear();
+    }
+    return *this;
+}
+
+void MappedPriceSeries::release() {
+#ifdef BS_PRICE_STORE_MMAP
+    if (mapping_) munmap(mapping_, mapped_bytes_);
+#endif
+    mapping_ = nullptr;
+    mapped_bytes_ = 0;
+    buffer_.clear();
+    size_ = 0;
+    days_ = nullptr;
+    adjusted_close_ = nullptr;
+    refreshed_day_ = 0;
+}
+
+// ---------------------------------------------------------------------------------------------
+
+PriceStore::PriceStore(std::string directory) : directory_(std::move(directory)) {}
+
+std::string PriceStore::pathFor(const std::string& symbol) const {
+    // Keep file names portable: anything unusual in a ticker becomes '_'
+    std::string name = symbol;
+    for (char& c : name) {
+        const bool keep = (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') ||
+                          c == '.' || c == '-';
+        if (!keep) c = '_';
+    }
+    return (std::filesystem::path(directory_) / (name + FILE_EXTENSION)).string();
+}
+
+bool PriceStore::load(const std::string& symbol, MappedPriceSeries& out) const {
+    out.release();
+    const std::string path = pathFor(symbol);
+    const unsigned char* data = nullptr;
+    std::size_t bytes = 0;
+
+#ifdef BS_PRICE_STORE_MMAP
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || static_cast<std::size_t>(info.st_size) < sizeof(FileHeader)) {
+        ::close(fd);
+        return false;
+    }
+    bytes = static_cast<std::size_t>(info.st_size);
+    void* mapping = ::mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);  // the mapping keeps the file alive
+    if (mapping == MAP_FAILED) return false;
+    out.mapping_ = mapping;
+    out.mapped_bytes_ = bytes;
+    data = static_cast<const unsigned char*>(mapping);
+#else
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) return false;
+    bytes = static_cast<std::size_t>(file.tellg());
+    if (bytes < sizeof(FileHeader)) return false;
+    out.buffer_.resize(bytes);
+    file.seekg(0);
+    if (!file.read(reinterpret_cast<char*>(out.buffer_.data()), static_cast<std::streamsize>(bytes))) {
+        out.release();
+        return false;
+    }
+    data = out.buffer_.data();
+#endif
+
+    FileHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0 || header.version != FILE_VERSION ||
+        bytes != fileBytes(static_cast<std::size_t>(header.count))) {
+        out.release();
+        return false;
+    }
+    out.size_ = static_cast<std::size_t>(header.count);
+    out.refreshed_day_ = header.refreshed_day;
+    out.days_ = reinterpret_cast<const std::int32_t*>(data + sizeof(FileHeader));
+    out.adjusted_close_ = reinterpret_cast<const double*>(data + closeOffset(out.size_));
+    return true;
+}
+
+void PriceStore::write(const std::string& symbol, const std::int32_t* days, const double* adjusted_close,
+                       std::size_t count, std::int32_t refreshed_day) const {
+    for (std::size_t i = 1; i < count; ++i) {
+        if (days[i] <= days[i - 1]) {
+            throw std::runtime_error("PriceStore: days must be strictly ascending for " + symbol);
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(directory_, ec);
+    if (ec) throw std::runtime_error("PriceStore: cannot create " + directory_ + ": " + ec.message());
+
+    std::vector<unsigned char> image(fileBytes(count), 0);
+    FileHeader header{};
+    std::memcpy(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC));
+    header.version = FILE_VERSION;
+    header.count = count;
+    header.refreshed_day = refreshed_day;
+    std::memcpy(image.data(), &header, sizeof(header));
+    if (count > 0) {
+        std::memcpy(image.data() + sizeof(FileHeader), days, count * sizeof(std::int32_t));
+        std::memcpy(image.data() + closeOffset(count), adjusted_close, count * sizeof(double));
+    }
+
+    const std::string path = pathFor(symbol);
+    const std::string temp_path = writeTempFile(path, image);
+    std::filesystem::rename(temp_path, path, ec);
+    if (ec) {
+        std::filesystem::remove(temp_path, ec);
+        throw std::runtime_error("PriceStore: failed to replace " + path);
+    }
+}
@@ -0,0 +1,278 @@
+#include "../include/pricing_grid.h"
+#include "../include/thread_pool.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+constexpr std::size_t MIN_AXIS_POINTS = 4;  // one cubic stencil
+constexpr double VOL_HEADROOM = 1.25;       // a widened vol axis gets room before the next rebuild
+
+struct Stencil {
+    std::size_t first;  // first of the 4 stencil nodes
+    std::size_t cell;   // cell holding the point
+    double weight[4];
+};
+
+// Cubic Lagrange weights for the point at fraction t of cell on a uniform axis; the stencil
+// is centred on the cell where it fits
+Stencil stencilAt(std::size_t cell, double t, std::size_t points) {
+    Stencil s;
+    s.cell = cell;
+    s.first = std::min(cell > 0 ? cell - 1 : 0, points - MIN_AXIS_POINTS);
+    const double u = static_cast<double>(cell - s.first) + t;
+    s.weight[0] = -(u - 1.0) * (u - 2.0) * (u - 3.0) * (1.0 / 6.0);
+    s.weight[1] = u * (u - 2.0) * (u - 3.0) * 0.5;
+    s.weight[2] = -u * (u - 1.0) * (u - 3.0) * 0.5;
+    s.weight[3] = u * (u - 1.0) * (u - 2.0) * (1.0 / 6.0);
+    return s;
+}
+
+Stencil stencil(double value, double min, double inverse_step, std::size_t points) {
+    const double u = (value - min) * inverse_step;
+    const std::size_t cell = std::min(static_cast<std::size_t>(u), points - 2);
+    return stencilAt(cell, u - static_cast<double>(cell), points);
+}
+
+double normalCDF(double x) { return 0.5 * std::erfc(-x / std::sqrt(2.0)); }
+
+// Undiscounted call per unit strike and N(d1) at forward log-moneyness y, total vol s
+void exactNode(double y, double s, double& call, double& n_d1, double& pdf_d1) {
+    const double d1 = y / s + 0.5 * s;
+    n_d1 = normalCDF(d1);
+    call = std::exp(y) * n_d1 - normalCDF(d1 - s);
+    pdf_d1 = std::exp(-0.5 * d1 * d1) / std::sqrt(2.0 * M_PI);
+}
+
+// Points for an axis of the given length at the same spacing as the configured one
+std::size_t pointsFor(double length, double base_length, std::size_t base_points) {
+    return static_cast<std::size_t>(std::ceil(length / base_length * (base_points - 1))) + 1;
+}
+}
+
+PricingGrid::PricingGrid(const PricingGridConfig& config) : config_(config) {
+    if (!(config.max_log_moneyness > 0.0) || !(config.min_total_volatility > 0.0) ||
+        !(config.max_total_volatility > config.min_total_volatility) ||
+        config.moneyness_points < MIN_AXIS_POINTS || config.volatility_points < MIN_AXIS_POINTS) {
+        throw std::invalid_argument("PricingGrid: axes need positive, increasing ranges and at least 4 points");
+    }
+    step_y_ = 2.0 * config.max_log_moneyness / (config.moneyness_points - 1);
+    step_s_ = (config.max_total_volatility - config.min_total_volatility) / (config.volatility_points - 1);
+    inverse_step_y_ = 1.0 / step_y_;
+    inverse_step_s_ = 1.0 / step_s_;
+    nodes_.resize(config.moneyness_points * config.volatility_points);
+    fallback_.resize((config.moneyness_points - 1) * (config.volatility_points - 1));
+}
+
+std::shared_ptr<const PricingGrid> PricingGrid::build(const PricingGridConfig& config) {
+    std::shared_ptr<PricingGrid> grid(new PricingGrid(config));
+    TaskExecutor& executor = config.executor ? *config.executor : TaskExecutor::shared();
+    executor.parallelFor(config.volatility_points, [&](std::size_t s) { grid->buildRow(s); });
+    executor.parallelFor(config.volatility_points - 1, [&](std::size_t s) { grid->checkRow(s); });
+    grid->fallback_count_ = static_cast<std::size_t>(std::count(grid->fallback_.begin(), grid->fallback_.end(), 1));
+    return grid;
+}
+
+void PricingGrid::buildRow(std::size_t volatility_index) {
+    const double s = config_.min_total_volatility + volatility_index * step_s_;
+    for (std::size_t y = 0; y < config_.moneyness_points; ++y) {
+        Node& node = nodes_[nodeIndex(y, volatility_index)];
+        exactNode(-config_.max_log_moneyness + y * step_y_, s, node.call, node.n_d1, node.pdf_d1);
+    }
+}
+
+void PricingGrid::checkRow(std::size_t volatility_index) {
+    // The error peaks off centre in the edge cells, whose stencils are shifted, so every cell is
+    // sampled on a 5x5 lattice of its corners, edge midpoints and quarter points. phi(d1) is
+    // checked as phi(d1) / sigma sqrt(T), i.e. gamma x spot, the unit its Greeks come out in
+    constexpr int SAMPLES = 5;
+    const double s_low = config_.min_total_volatility + volatility_index * step_s_;
+    for (std::size_t y = 0; y + 1 < config_.moneyness_points; ++y) {
+        const double y_low = -config_.max_log_moneyness + y * step_y_;
+        bool fails = false;
+        for (int j = 0; j < SAMPLES && !fails; ++j) {
+            const double fraction_s = j / (SAMPLES - 1.0);
+            const double s = s_low + fraction_s * step_s_;
+            const Stencil ss = stencilAt(volatility_index, fraction_s, config_.volatility_points);
+            for (int i = 0; i < SAMPLES && !fails; ++i) {
+                const double fraction_y = i / (SAMPLES - 1.0);
+                double call, n_d1, pdf_d1;
+                exactNode(y_low + fraction_y * step_y_, s, call, n_d1, pdf_d1);
+                const Stencil sy = stencilAt(y, fraction_y, config_.moneyness_points);
+                const Node node = interpolateStencils(sy.first, sy.weight, ss.first, ss.weight);
+                fails = std::fabs(node.call - call) > config_.max_error ||
+                        std::fabs(node.n_d1 - n_d1) > config_.max_error ||
+                        std::fabs(node.pdf_d1 - pdf_d1) > config_.max_error * s;
+            }
+        }
+        fallback_[cellIndex(y, volatility_index)] = fails ? 1 : 0;
+    }
+}
+
+bool PricingGrid::interpolateNode(double log_moneyness, double total_volatility, Node& node,
+                                  std::size_t& cell) const {
+    // Written so NaN fails the range test
+    if (!(std::fabs(log_moneyness) <= config_.max_log_moneyness &&
+          total_volatility >= config_.min_total_volatility && total_volatility <= config_.max_total_volatility)) {
+        return false;
+    }
+    const Stencil sy = stencil(log_moneyness, -config_.max_log_moneyness, inverse_step_y_, config_.moneyness_points);
+    const Stencil ss = stencil(total_volatility, config_.min_total_volatility, inverse_step_s_,
+                               config_.volatility_points);
+    cell = cellIndex(sy.cell, ss.cell);
+    node = interpolateStencils(sy.first, sy.weight, ss.first, ss.weight);
+    return true;
+}
+
+PricingGrid::Node PricingGrid::interpolateStencils(std::size_t first_y, const double* weight_y, std::size_t first_s,
+                                                   const double* weight_s) const {
+    // Local sums: the result could alias nodes_ as far as the compiler knows
+    double call = 0.0, n_d1 = 0.0, pdf_d1 = 0.0;
+    for (int b = 0; b < 4; ++b) {
+        const Node* row = &nodes_[nodeIndex(first_y, first_s + b)];
+        double row_call = 0.0, row_n_d1 = 0.0, row_pdf_d1 = 0.0;
+        for (int a = 0; a < 4; ++a) {
+            row_call += weight_y[a] * row[a].call;
+            row_n_d1 += weight_y[a] * row[a].n_d1;
+            row_pdf_d1 += weight_y[a] * row[a].pdf_d1;
+        }
+        call += weight_s[b] * row_call;
+        n_d1 += weight_s[b] * row_n_d1;
+        pdf_d1 += weight_s[b] * row_pdf_d1;
+    }
+    return {call, n_d1, pdf_d1};
+}
+
+bool PricingGrid::interpolate(double spot_price, double strike_price, double risk_free_rate, double volatility,
+                              double time_to_expiry, OptionValuation& out) const {
+    if (!(spot_price > 0.0 && strike_price > 0.0 && time_to_expiry > 0.0 && volatility > 0.0)) return false;
+    const double S = spot_price;
+    const double r = risk_free_rate;
+    const double T = time_to_expiry;
+    const double sqrt_T = std::sqrt(T);
+    Node node;
+    std::size_t cell;
+    if (!interpolateNode(FastMath::log(S / strike_price) + r * T, volatility * sqrt_T, node, cell) || fallback_[cell]) {
+        return false;
+    }
+
+    // Reciprocals and constant scales as multiplies: divides are most of the cost left per quote
+    const double discounted_strike = strike_price * FastMath::exp(-r * T);
+    const double call = discounted_strike * node.call;
+    const double strike_n_d2 = S * node.n_d1 - call;  // K e^(-rT) N(d2)
+    const double strike_n_minus_d2 = discounted_strike - strike_n_d2;
+    const double inverse_sqrt_T = 1.0 / sqrt_T;
+    const double decay = -0.5 * S * node.pdf_d1 * volatility * inverse_sqrt_T;
+    out.call_price = std::max(0.0, call);
+    out.put_price = std::max(0.0, call - S + discounted_strike);
+    out.call_greeks.delta = node.n_d1;
+    out.put_greeks.delta = node.n_d1 - 1.0;
+    out.call_greeks.gamma = out.put_greeks.gamma = node.pdf_d1 * inverse_sqrt_T / (S * volatility);
+    out.call_greeks.vega = out.put_greeks.vega = S * sqrt_T * node.pdf_d1 * 0.01;
+    out.call_greeks.theta = (decay - r * strike_n_d2) * (1.0 / 365.0);
+    out.put_greeks.theta = (decay + r * strike_n_minus_d2) * (1.0 / 365.0);
+    out.call_greeks.rho = T * strike_n_d2 * 0.01;
+    out.put_greeks.rho = -T * strike_n_minus_d2 * 0.01;
+    return true;
+}
+
+OptionValuation PricingGrid::quote(double spot_price, double strike_price, double risk_free_rate, double volatility,
+                                   double time_to_expiry) const {
+    OptionValuation valuation;
+    if (interpolate(spot_price, strike_price, risk_free_rate, volatility, time_to_expiry, valuation)) return valuation;
+    return BlackScholesGreeks::calculateAll(spot_price, strike_price, risk_free_rate, volatility, time_to_expiry);
+}
+
+double PricingGridSnapshot::riskFreeRate(SymbolId underlying) const {
+    auto it = rates_.find(underlying);
+    if (it == rates_.end()) throw std::out_of_range("PricingGridCache: no update() for this underlying");
+    return it->second;
+}
+
+OptionValuation PricingGridSnapshot::quote(SymbolId underlying, double spot_price, double strike_price,
+                                           double volatility, double time_to_expiry) const {
+    const double rate = riskFreeRate(underlying);
+    if (grid_) return grid_->quote(spot_price, strike_price, rate, volatility, time_to_expiry);
+    return BlackScholesGreeks::calculateAll(spot_price, strike_price, rate, volatility, time_to_expiry);
+}
+
+PricingGridCache::PricingGridCache(const PricingGridConfig& config)
+    : base_(config), config_(config), snapshot_(std::make_shared<const PricingGridSnapshot>()) {}
+
+PricingGridCache::~PricingGridCache() { waitForBuilds(); }
+
+void PricingGridCache::update(SymbolId underlying, double risk_free_rate, double max_volatility,
+                              double max_time_to_expiry) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto rate = rates_.find(underlying);
+    if (rate == rates_.end() || rate->second != risk_free_rate) {
+        rates_[underlying] = risk_free_rate;
+        publish();
+    }
+    const double log_moneyness = base_.max_log_moneyness + std::fabs(risk_free_rate) * max_time_to_expiry;
+    const double total_volatility = max_volatility * std::sqrt(max_time_to_expiry);
+    const bool covered = log_moneyness <= config_.max_log_moneyness &&
+                         total_volatility <= config_.max_total_volatility;
+    if (generation_ != 0 && covered) return;
+
+    if (log_moneyness > config_.max_log_moneyness) {
+        config_.max_log_moneyness = log_moneyness;
+        config_.moneyness_points = pointsFor(log_moneyness, base_.max_log_moneyness, base_.moneyness_points);
+    }
+    if (total_volatility > config_.max_total_volatility) {
+        config_.max_total_volatility = total_volatility * VOL_HEADROOM;
+        config_.volatility_points = pointsFor(config_.max_total_volatility - base_.min_total_volatility,
+                                              base_.max_total_volatility - base_.min_total_volatility,
+                                              base_.volatility_points);
+    }
+    const PricingGridConfig config = config_;
+    const std::uint64_t generation = ++generation_;
+    ++builds_in_flight_;
+    lock.unlock();
+
+    TaskExecutor& executor = config.executor ? *config.executor : TaskExecutor::shared();
+    executor.submit([this, config, generation] {
+        std::shared_ptr<const PricingGrid> grid;
+        try {
+            grid = PricingGrid::build(config);
+        } catch (...) {
+            // Bad axes: quotes stay on the previous grid or the analytic kernel
+        }
+        std::lock_guard<std::mutex> guard(mutex_);
+        if (grid && generation > installed_) {
+            grid_ = grid;
+            installed_ = generation;
+            publish();
+        }
+        if (--builds_in_flight_ == 0) idle_.notify_all();
+    });
+}
+
+void PricingGridCache::publish() {
+    auto next = std::make_shared<PricingGridSnapshot>();
+    next->grid_ = grid_;
+    next->rates_ = rates_;
+    std::atomic_store(&snapshot_, std::shared_ptr<const PricingGridSnapshot>(std::move(next)));
+}
+
+std::shared_ptr<const PricingGridSnapshot> PricingGridCache::snapshot() const {
+    return std::atomic_load(&snapshot_);
+}
+
+std::shared_ptr<const PricingGrid> PricingGridCache::grid() const {
+    return snapshot()->grid();
+}
+
+double PricingGridCache::riskFreeRate(SymbolId underlying) const {
+    return snapshot()->riskFreeRate(underlying);
+}
+
+OptionValuation PricingGridCache::quote(SymbolId underlying, double spot_price, double strike_price,
+                                        double volatility, double time_to_expiry) const {
+    return snapshot()->quote(underlying, spot_price, strike_price, volatility, time_to_expiry);
+}
+
+void PricingGridCache::waitForBuilds() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_.wait(lock, [this] { return builds_in_flight_ == 0; });
+}
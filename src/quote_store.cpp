@@ -0,0 +1,122 @@
+#include "../include/quote_store.h"
+#include <functional>
+#include <stdexcept>
+
+QuoteStore::QuoteStore(std::chrono::milliseconds ttl) : ttl_(ttl) {
+    for (auto& chunk : chunks_) chunk.store(nullptr, std::memory_order_relaxed);
+}
+
+QuoteStore::~QuoteStore() {
+    for (auto& chunk : chunks_) delete[] chunk.load(std::memory_order_relaxed);
+}
+
+std::int64_t QuoteStore::nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+QuoteStore::Shard& QuoteStore::shardFor(const std::string& symbol) const {
+    return shards_[std::hash<std::string>{}(symbol) % NUM_SHARDS];
+}
+
+QuoteStore::Slot& QuoteStore::slot(SymbolId id) const {
+    return chunks_[id / SLOTS_PER_CHUNK].load(std::memory_order_acquire)[id % SLOTS_PER_CHUNK];
+}
+
+SymbolId QuoteStore::intern(const std::string& symbol) {
+    Shard& shard = shardFor(symbol);
+    {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.ids.find(symbol);
+        if (it != shard.ids.end()) return it->second;
+    }
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.ids.find(symbol);
+    if (it != shard.ids.end()) return it->second;
+
+    SymbolId id;
+    {
+        std::lock_guard<std::mutex> grow(grow_mutex_);
+        const std::size_t next = size_.load(std::memory_order_relaxed);
+        if (next >= MAX_SYMBOLS) throw std::length_error("QuoteStore: too many symbols");
+        id = static_cast<SymbolId>(next);
+        auto& chunk = chunks_[id / SLOTS_PER_CHUNK];
+        if (!chunk.load(std::memory_order_relaxed)) chunk.store(new Slot[SLOTS_PER_CHUNK], std::memory_order_release);
+        {
+            std::lock_guard<std::mutex> names(names_mutex_);
+            names_.emplace(id, symbol);
+        }
+        size_.store(next + 1, std::memory_order_release);
+    }
+    shard.ids.emplace(symbol, id);
+    return id;
+}
+
+bool QuoteStore::find(const std::string& symbol, SymbolId& id) const {
+    Shard& shard = shardFor(symbol);
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.ids.find(symbol);
+    if (it == shard.ids.end()) return false;
+    id = it->second;
+    return true;
+}
+
+std::string QuoteStore::symbol(SymbolId id) const {
+    std::lock_guard<std::mutex> lock(names_mutex_);
+    auto it = names_.find(id);
+    return it != names_.end() ? it->second : std::string();
+}
+
+void QuoteStore::write(SymbolId id, double price, QuoteSource source, std::int64_t timestamp_ns) {
+    if (id >= size()) throw std::out_of_range("QuoteStore: unknown symbol id");
+    Slot& s = slot(id);
+
+    // Take the slot: move the sequence from even to odd
+    std::uint32_t sequence = s.sequence.load(std::memory_order_relaxed);
+    for (;;) {
+        if ((sequence & 1u) == 0 &&
+            s.sequence.compare_exchange_weak(sequence, sequence + 1, std::memory_order_acquire,
+                                             std::memory_order_relaxed)) {
+            break;
+        }
+        sequence = s.sequence.load(std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    s.price.store(price, std::memory_order_relaxed);
+    s.timestamp_ns.store(timestamp_ns, std::memory_order_relaxed);
+    s.source.store(source, std::memory_order_relaxed);
+    s.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+bool QuoteStore::read(SymbolId id, Quote& out) const {
+    if (id >= size()) return false;
+    const Slot& s = slot(id);
+    for (;;) {
+        const std::uint32_t before = s.sequence.load(std::memory_order_acquire);
+        if (before & 1u) continue;  // write in progress
+        out.price = s.price.load(std::memory_order_relaxed);
+        out.timestamp_ns = s.timestamp_ns.load(std::memory_order_relaxed);
+        out.source = static_cast<QuoteSource>(s.source.load(std::memory_order_relaxed));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (s.sequence.load(std::memory_order_relaxed) == before) break;
+    }
+    return out.source != SOURCE_NONE;
+}
+
+bool QuoteStore::isStale(SymbolId id, std::chrono::milliseconds max_age) const {
+    Quote quote;
+    if (!read(id, quote)) return true;
+    const std::int64_t age_ns = nowNs() - quote.timestamp_ns;
+    return age_ns > std::chrono::duration_cast<std::chrono::nanoseconds>(max_age).count();
+}
+
+bool QuoteStore::claimRefresh(SymbolId id, std::chrono::milliseconds min_interval) {
+    if (id >= size()) return false;
+    Slot& s = slot(id);
+    const std::int64_t now = nowNs();
+    const std::int64_t interval = std::chrono::duration_cast<std::chrono::nanoseconds>(min_interval).count();
+    std::int64_t claimed = s.refresh_claimed_ns.load(std::memory_order_relaxed);
+    while (claimed == 0 || now - claimed >= interval) {
+        if (s.refresh_claimed_ns.compare_exchange_weak(claimed, now, std::memory_order_relaxed)) return true;
+    }
+    return false;
+}
@@ -0,0 +1,394 @@
+#include "../include/random_streams.h"
+#include "../include/fast_math.h"
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+constexpr std::uint32_t PHILOX_M0 = 0xD2511F53u;
+constexpr std::uint32_t PHILOX_M1 = 0xCD9E8D57u;
+constexpr std::uint32_t PHILOX_W0 = 0x9E3779B9u;
+constexpr std::uint32_t PHILOX_W1 = 0xBB67AE85u;
+constexpr double TWO_POW_MINUS_53 = 1.0 / 9007199254740992.0;
+constexpr double TWO_POW_MINUS_32 = 1.0 / 4294967296.0;
+constexpr unsigned MAX_SOBOL_DIMENSIONS = 21201;
+constexpr std::size_t PHILOX_LANES = 8;
+constexpr double AS241_CENTRAL = 0.425;
+
+// PHILOX_LANES independent Philox4x32-10 evaluations, structure-of-arrays so the rounds vectorize
+struct PhiloxLanes {
+    std::uint32_t c0[PHILOX_LANES], c1[PHILOX_LANES], c2[PHILOX_LANES], c3[PHILOX_LANES];
+
+    void setCounter(std::size_t j, std::uint64_t position, std::uint32_t word2, std::uint32_t word3) noexcept {
+        c0[j] = static_cast<std::uint32_t>(position);
+        c1[j] = static_cast<std::uint32_t>(position >> 32);
+        c2[j] = word2;
+        c3[j] = word3;
+    }
+
+    void rounds(const std::array<std::uint32_t, 2>& key) noexcept {
+        std::uint32_t k0 = key[0], k1 = key[1];
+        for (int round = 0; round < 10; ++round) {
+            for (std::size_t j = 0; j < PHILOX_LANES; ++j) {
+                const std::uint64_t p0 = static_cast<std::uint64_t>(PHILOX_M0) * c0[j];
+                const std::uint64_t p1 = static_cast<std::uint64_t>(PHILOX_M1) * c2[j];
+                const std::uint32_t next0 = static_cast<std::uint32_t>(p1 >> 32) ^ c1[j] ^ k0;
+                const std::uint32_t next2 = static_cast<std::uint32_t>(p0 >> 32) ^ c3[j] ^ k1;
+                c1[j] = static_cast<std::uint32_t>(p1);
+                c3[j] = static_cast<std::uint32_t>(p0);
+                c0[j] = next0;
+                c2[j] = next2;
+            }
+            k0 += PHILOX_W0;
+            k1 += PHILOX_W1;
+        }
+    }
+
+    // Two uniforms per block, 53 bits each, strictly inside (0, 1)
+    double first(std::size_t j) const noexcept { return toUniform(c0[j], c1[j]); }
+    double second(std::size_t j) const noexcept { return toUniform(c2[j], c3[j]); }
+
+    static double toUniform(std::uint32_t hi, std::uint32_t lo) noexcept {
+        const std::uint64_t bits = (static_cast<std::uint64_t>(hi) << 21) ^ (lo >> 11);
+        return (static_cast<double>(bits) + 0.5) * TWO_POW_MINUS_53;
+    }
+};
+
+inline void mulhilo(std::uint32_t a, std::uint32_t b, std::uint32_t& hi, std::uint32_t& lo) noexcept {
+    const std::uint64_t product = static_cast<std::uint64_t>(a) * b;
+    hi = static_cast<std::uint32_t>(product >> 32);
+    lo = static_cast<std::uint32_t>(product);
+}
+
+std::uint64_t splitMix64(std::uint64_t& state) noexcept {
+    std::uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// Polynomials over GF(2) as bit masks (bit i = coefficient of x^i)
+std::uint64_t mulMod(std::uint64_t a, std::uint64_t b, std::uint64_t poly, int degree) noexcept {
+    std::uint64_t result = 0;
+    while (b) {
+        if (b & 1u) result ^= a;
+        b >>= 1;
+        a <<= 1;
+        if (a & (1ull << degree)) a ^= poly;
+    }
+    return result;
+}
+
+std::uint64_t powMod(std::uint64_t exponent, std::uint64_t poly, int degree) noexcept {
+    std::uint64_t result = 1;
+    std::uint64_t base = (degree == 1) ? (2u ^ poly) & 1u : 2u;  // x mod poly
+    while (exponent) {
+        if (exponent & 1u) result = mulMod(result, base, poly, degree);
+        base = mulMod(base, base, poly, degree);
+        exponent >>= 1;
+    }
+    return result;
+}
+
+// Primitive iff x has multiplicative order exactly 2^degree - 1 modulo poly
+bool isPrimitive(std::uint64_t poly, int degree, const std::vector<std::uint64_t>& order_factors) {
+    const std::uint64_t order = (1ull << degree) - 1;
+    if (powMod(order, poly, degree) != 1) return false;
+    for (std::uint64_t q : order_factors) {
+        if (powMod(order / q, poly, degree) == 1) return false;
+    }
+    return true;
+}
+
+std::vector<std::uint64_t> primeFactors(std::uint64_t n) {
+    std::vector<std::uint64_t> factors;
+    for (std::uint64_t q = 2; q * q <= n; ++q) {
+        if (n % q) continue;
+        factors.push_back(q);
+        while (n % q == 0) n /= q;
+    }
+    if (n > 1) factors.push_back(n);
+    return factors;
+}
+
+// The first `count` primitive polynomials in order of degree, then value
+std::vector<std::pair<std::uint64_t, int>> primitivePolynomials(unsigned count) {
+    std::vector<std::pair<std::uint64_t, int>> polys;
+    for (int degree = 1; polys.size() < count; ++degree) {
+        const std::vector<std::uint64_t> factors = primeFactors((1ull << degree) - 1);
+        for (std::uint64_t inner = 0; inner < (1ull << (degree - 1)) && polys.size() < count; ++inner) {
+            const std::uint64_t poly = (1ull << degree) | (inner << 1) | 1u;
+            if (isPrimitive(poly, degree, factors)) polys.emplace_back(poly, degree);
+        }
+    }
+    return polys;
+}
+
+// AS241 central region |p - 0.5| <= 0.425: one rational function, no branches or libm calls
+inline double central(double q) noexcept {
+    const double r = 0.180625 - q * q;
+    return q * (((((((r * 2509.0809287301226727 + 33430.575583588128105) * r
+                    + 67265.770927008700853) * r + 45921.953931549871457) * r
+                  + 13731.693765509461125) * r + 1971.5909503065514427) * r
+                + 133.14166789178437745) * r + 3.387132872796366608)
+           / (((((((r * 5226.495278852545925 + 28729.085735721942674) * r
+                   + 39307.89580009271061) * r + 21213.794301586595867) * r
+                 + 5394.1960214247511077) * r + 687.1870074920579083) * r
+               + 42.313330701600911252) * r + 1.0);
+}
+
+// AS241 tails with r = sqrt(-log(min(p, 1 - p))) <= 5, i.e. min(p, 1 - p) >= ~1.4e-11
+inline double nearTail(double r) noexcept {
+    r -= 1.6;
+    return (((((((r * 7.7454501427834140764e-4 + 0.0227238449892691845833) * r
+                  + 0.24178072517745061177) * r + 1.27045825245236838258) * r
+                + 3.64784832476320460504) * r + 5.7694972214606914055) * r
+              + 4.6303378461565452959) * r + 1.42343711074968357734)
+            / (((((((r * 1.05075007164441684324e-9 + 5.475938084995344946e-4) * r
+                    + 0.0151986665636164571966) * r + 0.14810397642748007459) * r
+                  + 0.68976733498510000455) * r + 1.6763848301838038494) * r
+                + 2.05319162663775882187) * r + 1.0);
+}
+
+// AS241 extreme tails, r > 5
+inline double farTail(double r) noexcept {
+    r -= 5.0;
+    return (((((((r * 2.01033439929228813265e-7 + 2.71155556874348757815e-5) * r
+                  + 0.0012426609473880784386) * r + 0.026532189526576123093) * r
+                + 0.29656057182850489123) * r + 1.7848265399172913358) * r
+              + 5.4637849111641143699) * r + 6.6579046435011037772)
+            / (((((((r * 2.04426310338993978564e-15 + 1.4215117583164458887e-7) * r
+                    + 1.8463183175100546818e-5) * r + 7.868691311456132591e-4) * r
+                  + 0.0148753612908506148525) * r + 0.13692988092273580531) * r
+                + 0.59983220655588793769) * r + 1.0);
+}
+
+inline int parity(std::uint32_t v) noexcept {
+    v ^= v >> 16;
+    v ^= v >> 8;
+    v ^= v >> 4;
+    v ^= v >> 2;
+    v ^= v >> 1;
+    return static_cast<int>(v & 1u);
+}
+
+inline int trailingZeros(std::uint64_t v) noexcept {
+    int n = 0;
+    while ((v & 1u) == 0) {
+        v >>= 1;
+        ++n;
+    }
+    return n;
+}
+}
+
+// ---------------------------------------------------------------------------------------------
+
+Philox4x32::Philox4x32(std::uint64_t seed, std::uint64_t stream) noexcept
+    : key_{static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32)},
+      counter_{0u, 0u, static_cast<std::uint32_t>(stream), static_cast<std::uint32_t>(stream >> 32)} {}
+
+Philox4x32::Block Philox4x32::round10(Block ctr, Key key) noexcept {
+    for (int round = 0; round < 10; ++round) {
+        std::uint32_t hi0, lo0, hi1, lo1;
+        mulhilo(PHILOX_M0, ctr[0], hi0, lo0);
+        mulhilo(PHILOX_M1, ctr[2], hi1, lo1);
+        ctr = {hi1 ^ ctr[1] ^ key[0], lo1, hi0 ^ ctr[3] ^ key[1], lo0};
+        key[0] += PHILOX_W0;
+        key[1] += PHILOX_W1;
+    }
+    return ctr;
+}
+
+void Philox4x32::seek(std::uint64_t position) noexcept {
+    counter_[0] = static_cast<std::uint32_t>(position);
+    counter_[1] = static_cast<std::uint32_t>(position >> 32);
+}
+
+void Philox4x32::fillUniform(double* out, std::size_t n) noexcept {
+    // PHILOX_LANES consecutive blocks of this stream go through the rounds side by side
+    PhiloxLanes lanes;
+    for (std::size_t done = 0; done < n; done += 2 * PHILOX_LANES) {
+        const std::uint64_t position = (static_cast<std::uint64_t>(counter_[1]) << 32) | counter_[0];
+        for (std::size_t j = 0; j < PHILOX_LANES; ++j) {
+            lanes.setCounter(j, position + j, counter_[2], counter_[3]);
+        }
+        lanes.rounds(key_);
+        const std::size_t blocks = std::min<std::size_t>(PHILOX_LANES, (n - done + 1) / 2);
+        for (std::size_t j = 0; j < blocks; ++j) {
+            out[done + 2 * j] = lanes.first(j);
+            if (done + 2 * j + 1 < n) out[done + 2 * j + 1] = lanes.second(j);
+        }
+        seek(position + blocks);
+    }
+}
+
+void Philox4x32::fillStreams(std::uint64_t seed, std::uint64_t first_stream, std::size_t count,
+                             std::size_t per_stream, double* out) noexcept {
+    if (per_stream >= 2 * PHILOX_LANES) {
+        // Long streams fill the lanes on their own and keep the stores contiguous
+        for (std::size_t k = 0; k < count; ++k) {
+            Philox4x32 gen(seed, first_stream + k);
+            gen.fillUniform(out + k * per_stream, per_stream);
+        }
+        return;
+    }
+    // Short streams (e.g. one uniform per path): lanes run across streams instead
+    const Key key{static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32)};
+    PhiloxLanes lanes;
+    for (std::size_t s0 = 0; s0 < count; s0 += PHILOX_LANES) {
+        const std::size_t width = std::min(PHILOX_LANES, count - s0);
+        for (std::size_t done = 0; done < per_stream; done += 2) {
+            for (std::size_t j = 0; j < PHILOX_LANES; ++j) {
+                const std::uint64_t stream = first_stream + s0 + j;
+                lanes.setCounter(j, done / 2, static_cast<std::uint32_t>(stream), static_cast<std::uint32_t>(stream >> 32));
+            }
+            lanes.rounds(key);
+            for (std::size_t j = 0; j < width; ++j) {
+                double* row = out + (s0 + j) * per_stream;
+                row[done] = lanes.first(j);
+                if (done + 1 < per_stream) row[done + 1] = lanes.second(j);
+            }
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------------------------
+
+double InverseNormal::quantile(double p) noexcept {
+    const double q = p - 0.5;
+    if (std::fabs(q) <= AS241_CENTRAL) return central(q);
+    const double r = std::sqrt(-std::log(q < 0.0 ? p : 1.0 - p));
+    const double value = r <= 5.0 ? nearTail(r) : farTail(r);
+    return q < 0.0 ? -value : value;
+}
+
+void InverseNormal::transform(double* values, std::size_t n) noexcept {
+    // All three regions evaluated and selected, with FastMath::log, so the loop vectorizes
+    for (std::size_t i = 0; i < n; ++i) {
+        const double p = values[i];
+        const double q = p - 0.5;
+        const double r = std::sqrt(-FastMath::log(q < 0.0 ? p : 1.0 - p));
+        const double tail = r <= 5.0 ? nearTail(r) : farTail(r);
+        const double signed_tail = q < 0.0 ? -tail : tail;
+        values[i] = std::fabs(q) <= AS241_CENTRAL ? central(q) : signed_tail;
+    }
+}
+
+// ---------------------------------------------------------------------------------------------
+
+SobolSequence::SobolSequence(unsigned dimensions, std::uint64_t scramble_seed)
+    : dimensions_(dimensions),
+      directions_(static_cast<std::size_t>(dimensions) * BITS),
+      shift_(dimensions, 0u) {
+    if (dimensions == 0 || dimensions > MAX_SOBOL_DIMENSIONS) {
+        throw std::invalid_argument("SobolSequence: unsupported dimension count");
+    }
+    // Dimension 0 is van der Corput; dimension d >= 1 uses the d-th primitive polynomial
+    for (int k = 0; k < BITS; ++k) {
+        directions_[static_cast<std::size_t>(k)] = 1u << (BITS - 1 - k);
+    }
+    const auto polys = primitivePolynomials(dimensions - 1);
+    std::uint64_t init_state = 0x50B01D1CE5EEDull;  // fixed: direction numbers never change
+    for (unsigned d = 1; d < dimensions; ++d) {
+        const std::uint64_t poly = polys[d - 1].first;
+        const int degree = polys[d - 1].second;
+        std::uint64_t m[BITS + 1] = {0};
+        for (int k = 1; k <= degree && k <= BITS; ++k) {
+            // m_k odd and < 2^k
+            m[k] = (splitMix64(init_state) & ((1ull << k) - 1)) | 1u;
+        }
+        for (int k = degree + 1; k <= BITS; ++k) {
+            std::uint64_t value = m[k - degree] ^ (m[k - degree] << degree);
+            for (int j = 1; j < degree; ++j) {
+                if ((poly >> (degree - j)) & 1u) value ^= m[k - j] << j;
+            }
+            m[k] = value;
+        }
+        for (int k = 1; k <= BITS; ++k) {
+            directions_[static_cast<std::size_t>(d) * BITS + (k - 1)] = static_cast<std::uint32_t>(m[k] << (BITS - k));
+        }
+    }
+
+    if (scramble_seed == 0) return;
+    std::uint64_t state = scramble_seed;
+    for (unsigned d = 0; d < dimensions; ++d) {
+        // Random unit lower-triangular matrix L over the bits (most significant first)
+        std::uint32_t rows[BITS];
+        for (int b = 0; b < BITS; ++b) {
+            const std::uint32_t above = b == 0 ? 0u : ~0u << (BITS - b);
+            rows[b] = (static_cast<std::uint32_t>(splitMix64(state)) & above) | (1u << (BITS - 1 - b));
+        }
+        for (int k = 0; k < BITS; ++k) {
+            std::uint32_t& v = directions_[static_cast<std::size_t>(d) * BITS + k];
+            std::uint32_t scrambled = 0;
+            for (int b = 0; b < BITS; ++b) {
+                scrambled |= static_cast<std::uint32_t>(parity(v & rows[b])) << (BITS - 1 - b);
+            }
+            v = scrambled;
+        }
+        shift_[d] = static_cast<std::uint32_t>(splitMix64(state));
+    }
+}
+
+void SobolSequence::fill(std::uint64_t first, std::size_t count, double* out) const {
+    std::vector<std::uint32_t> x(dimensions_, 0u);
+    const std::uint64_t gray = first ^ (first >> 1);
+    for (int k = 0; k < BITS; ++k) {
+        if (!((gray >> k) & 1u)) continue;
+        for (unsigned d = 0; d < dimensions_; ++d) x[d] ^= directions_[static_cast<std::size_t>(d) * BITS + k];
+    }
+    for (std::size_t point = 0; point < count; ++point) {
+        double* row = out + point * dimensions_;
+        for (unsigned d = 0; d < dimensions_; ++d) {
+            row[d] = (static_cast<double>(x[d] ^ shift_[d]) + 0.5) * TWO_POW_MINUS_32;
+        }
+        const int k = trailingZeros(first + point + 1);
+        if (k >= BITS) break;  // sequence exhausted at 2^32 points
+        for (unsigned d = 0; d < dimensions_; ++d) x[d] ^= directions_[static_cast<std::size_t>(d) * BITS + k];
+    }
+}
+
+// ---------------------------------------------------------------------------------------------
+
+BrownianBridge::BrownianBridge(int steps) : steps_(steps) {
+    if (steps < 1) throw std::invalid_argument("BrownianBridge: steps must be positive");
+    point_.reserve(static_cast<std::size_t>(steps));
+    // Unit time steps; W(0) = 0 is index 0, W(T) is index steps
+    point_.push_back(steps);
+    left_.push_back(0);
+    right_.push_back(0);
+    left_weight_.push_back(0.0);
+    right_weight_.push_back(0.0);
+    std_dev_.push_back(std::sqrt(static_cast<double>(steps)));
+
+    std::deque<std::pair<int, int>> intervals{{0, steps}};
+    while (!intervals.empty()) {
+        const auto [l, r] = intervals.front();
+        intervals.pop_front();
+        if (r - l < 2) continue;
+        const int mid = l + (r - l) / 2;
+        point_.push_back(mid);
+        left_.push_back(l);
+        right_.push_back(r);
+        left_weight_.push_back(static_cast<double>(r - mid) / (r - l));
+        right_weight_.push_back(static_cast<double>(mid - l) / (r - l));
+        std_dev_.push_back(std::sqrt(static_cast<double>(mid - l) * (r - mid) / (r - l)));
+        intervals.emplace_back(l, mid);
+        intervals.emplace_back(mid, r);
+    }
+}
+
+void BrownianBridge::transform(const double* z, double* out) const {
+    // out[i - 1] holds W(i) while the bridge is built; W(0) = 0
+    auto W = [out](int index) { return index == 0 ? 0.0 : out[index - 1]; };
+    out[steps_ - 1] = std_dev_[0] * z[0];
+    for (int k = 1; k < steps_; ++k) {
+        out[point_[k] - 1] = left_weight_[k] * W(left_[k]) + right_weight_[k] * W(right_[k]) + std_dev_[k] * z[k];
+    }
+    for (int i = steps_ - 1; i >= 1; --i) {
+        out[i] -= out[i - 1];
+    }
+}
@@ -0,0 +1,193 @@
+#include "../include/rolling_volatility.h"
+#include "../include/thread_pool.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+const double NaN = std::numeric_limits<double>::quiet_NaN();
+const double LN2 = std::log(2.0);
+constexpr double YANG_ZHANG_ALPHA = 1.34;  // k = 0.34 / (alpha + (n + 1) / (n - 1))
+}
+
+void RollingVolatilityEngine::Moments::add(double x) {
+    n += 1.0;
+    const double delta = x - mean;
+    mean += delta / n;
+    m2 += delta * (x - mean);
+}
+
+void RollingVolatilityEngine::Moments::remove(double x) {
+    if (n <= 1.0) {
+        *this = Moments();
+        return;
+    }
+    n -= 1.0;
+    const double delta = x - mean;
+    mean -= delta / n;
+    m2 = std::max(0.0, m2 - delta * (x - mean));
+}
+
+RollingVolatilityEngine::RollingVolatilityEngine(const RollingVolatilityConfig& config)
+    : windows_(config.windows),
+      lambda_(config.ewma_lambda),
+      periods_per_year_(config.periods_per_year),
+      capacity_(0) {
+    for (int window : windows_) {
+        if (window < 2) {
+            throw std::invalid_argument("RollingVolatilityEngine: windows need at least two returns");
+        }
+        capacity_ = std::max(capacity_, static_cast<std::size_t>(window));
+    }
+    if (!(lambda_ > 0.0 && lambda_ < 1.0)) {
+        throw std::invalid_argument("RollingVolatilityEngine: ewma_lambda must be in (0, 1)");
+    }
+    reset();
+}
+
+void RollingVolatilityEngine::reset() {
+    for (int t = 0; t < TERM_COUNT; ++t) {
+        ring_[t].assign(capacity_, 0.0);
+        moments_[t].assign(windows_.size(), Moments());
+    }
+    ring_ohlc_.assign(capacity_, 0);
+    ohlc_in_window_.assign(windows_.size(), 0);
+    bars_ = 0;
+    terms_ = 0;
+    previous_close_ = 0.0;
+    ewma_variance_ = 0.0;
+}
+
+void RollingVolatilityEngine::push(const double* terms, bool ohlc) {
+    const std::size_t slot = capacity_ ? terms_ % capacity_ : 0;
+    for (std::size_t w = 0; w < windows_.size(); ++w) {
+        const std::size_t window = static_cast<std::size_t>(windows_[w]);
+        if (terms_ >= window) {
+            // Term that leaves this window: `window` pushes ago
+            const std::size_t old = (terms_ - window) % capacity_;
+            for (int t = 0; t < TERM_COUNT; ++t) moments_[t][w].remove(ring_[t][old]);
+            ohlc_in_window_[w] -= ring_ohlc_[old];
+        }
+        for (int t = 0; t < TERM_COUNT; ++t) moments_[t][w].add(terms[t]);
+        ohlc_in_window_[w] += ohlc ? 1 : 0;
+    }
+    if (capacity_) {
+        for (int t = 0; t < TERM_COUNT; ++t) ring_[t][slot] = terms[t];
+        ring_ohlc_[slot] = ohlc ? 1 : 0;
+    }
+    ++terms_;
+
+    // RiskMetrics: seeded with the first squared return
+    const double r2 = terms[TERM_RETURN] * terms[TERM_RETURN];
+    ewma_variance_ = terms_ == 1 ? r2 : lambda_ * ewma_variance_ + (1.0 - lambda_) * r2;
+}
+
+void RollingVolatilityEngine::addClose(double close) {
+    if (!(close > 0.0)) throw std::invalid_argument("Prices must be positive for log return calculation");
+    if (bars_++ > 0) {
+        double terms[TERM_COUNT] = {};
+        terms[TERM_RETURN] = std::log(close / previous_close_);
+        push(terms, false);
+    }
+    previous_close_ = close;
+}
+
+void RollingVolatilityEngine::addBar(double open, double high, double low, double close) {
+    if (!(open > 0.0 && high > 0.0 && low > 0.0 && close > 0.0)) {
+        throw std::invalid_argument("Prices must be positive for log return calculation");
+    }
+    if (bars_++ > 0) {
+        const double hl = std::log(high / low);
+        const double co = std::log(close / open);
+        const double hc = std::log(high / close), ho = std::log(high / open);
+        const double lc = std::log(low / close), lo = std::log(low / open);
+        double terms[TERM_COUNT];
+        terms[TERM_RETURN] = std::log(close / previous_close_);
+        terms[TERM_PARKINSON] = hl * hl / (4.0 * LN2);
+        terms[TERM_GARMAN_KLASS] = 0.5 * hl * hl - (2.0 * LN2 - 1.0) * co * co;
+        terms[TERM_OVERNIGHT] = std::log(open / previous_close_);
+        terms[TERM_OPEN_CLOSE] = co;
+        terms[TERM_ROGERS_SATCHELL] = hc * ho + lc * lo;
+        push(terms, true);
+    }
+    previous_close_ = close;
+}
+
+double RollingVolatilityEngine::volatility(std::size_t w, VolatilityEstimator estimator) const {
+    if (w >= windows_.size()) throw std::out_of_range("RollingVolatilityEngine: window index");
+    const std::size_t window = static_cast<std::size_t>(windows_[w]);
+    if (terms_ < window) return NaN;
+    if (estimator != VOL_CLOSE_TO_CLOSE && ohlc_in_window_[w] != window) return NaN;
+
+    double variance = 0.0;
+    switch (estimator) {
+        case VOL_CLOSE_TO_CLOSE:
+            variance = moments_[TERM_RETURN][w].variance();
+            break;
+        case VOL_PARKINSON:
+            variance = moments_[TERM_PARKINSON][w].mean;
+            break;
+        case VOL_GARMAN_KLASS:
+            variance = moments_[TERM_GARMAN_KLASS][w].mean;
+            break;
+        case VOL_YANG_ZHANG: {
+            const double n = static_cast<double>(window);
+            const double k = 0.34 / (YANG_ZHANG_ALPHA + (n + 1.0) / (n - 1.0));
+            variance = moments_[TERM_OVERNIGHT][w].variance() + k * moments_[TERM_OPEN_CLOSE][w].variance() +
+                       (1.0 - k) * moments_[TERM_ROGERS_SATCHELL][w].mean;
+            break;
+        }
+        default:
+            return NaN;
+    }
+    return std::sqrt(std::max(0.0, variance) * periods_per_year_);
+}
+
+double RollingVolatilityEngine::ewmaVolatility() const {
+    return terms_ == 0 ? NaN : std::sqrt(ewma_variance_ * periods_per_year_);
+}
+
+RollingVolatilitySeries RollingVolatilityEngine::compute(const PriceSeriesView& series,
+                                                         const RollingVolatilityConfig& config) {
+    RollingVolatilityEngine engine(config);
+    RollingVolatilitySeries out;
+    out.bars = series.size;
+    out.windows = config.windows;
+    out.ewma.assign(series.size, NaN);
+
+    const bool ohlc = series.has(FIELD_OPEN) && series.has(FIELD_HIGH) && series.has(FIELD_LOW) && series.has(FIELD_CLOSE);
+    const double* closes = series.prices();
+    if (!closes) throw std::invalid_argument("Price series has no close column");
+    const int estimators = ohlc ? VOL_ESTIMATOR_COUNT : VOL_CLOSE_TO_CLOSE + 1;
+    for (int e = 0; e < estimators; ++e) out.values[e].assign(config.windows.size() * series.size, NaN);
+
+    for (std::size_t i = 0; i < series.size; ++i) {
+        if (ohlc) {
+            // Put the raw bar on the adjusted scale (factor adjusted / raw close), so returns and
+            // the overnight gap don't jump on split and dividend days and close-to-close matches
+            // the close-only mode; the range terms are ratios within a bar and don't change
+            const double raw_close = series.fields[FIELD_CLOSE][i];
+            const double factor = raw_close > 0.0 ? closes[i] / raw_close : 1.0;
+            engine.addBar(series.fields[FIELD_OPEN][i] * factor, series.fields[FIELD_HIGH][i] * factor,
+                          series.fields[FIELD_LOW][i] * factor, closes[i]);
+        } else {
+            engine.addClose(closes[i]);
+        }
+        out.ewma[i] = engine.ewmaVolatility();
+        for (std::size_t w = 0; w < config.windows.size(); ++w) {
+            for (int e = 0; e < estimators; ++e) {
+                out.values[e][w * series.size + i] = engine.volatility(w, static_cast<VolatilityEstimator>(e));
+            }
+        }
+    }
+    return out;
+}
+
+std::vector<RollingVolatilitySeries> RollingVolatilityEngine::computeAll(const std::vector<PriceSeriesView>& series,
+                                                                         const RollingVolatilityConfig& config) {
+    std::vector<RollingVolatilitySeries> out(series.size());
+    TaskExecutor& executor = config.executor ? *config.executor : TaskExecutor::shared();
+    executor.parallelFor(series.size(), [&](std::size_t i) { out[i] = compute(series[i], config); });
+    return out;
+}
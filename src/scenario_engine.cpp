@@ -0,0 +1,187 @@
+#include "../include/scenario_engine.h"
+#include "../include/black_scholes_batch.h"
+#include "../include/black_scholes_kernels.h"
+#include "../include/option_strategy.h"
+#include "../include/thread_pool.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+constexpr double SECONDS_PER_YEAR = 365.25 * 24 * 60 * 60;
+constexpr double DAYS_PER_YEAR = 365.25;
+}
+
+std::vector<double> ScenarioGrid::symmetric(double range, std::size_t points) {
+    if (points < 2) return {0.0};
+    std::vector<double> out(points);
+    for (std::size_t i = 0; i < points; ++i) out[i] = -range + 2.0 * range * i / (points - 1);
+    if (points % 2 == 1) out[points / 2] = 0.0;  // exact centre despite rounding
+    return out;
+}
+
+std::vector<double> ScenarioGrid::steps(double last, std::size_t points) {
+    if (points < 2) return {0.0};
+    std::vector<double> out(points);
+    for (std::size_t i = 0; i < points; ++i) out[i] = last * i / (points - 1);
+    return out;
+}
+
+ScenarioPortfolio::ScenarioPortfolio(std::time_t now) : now_(now ? now : std::time(nullptr)) {}
+
+ScenarioPortfolio ScenarioPortfolio::fromBook(const PositionBook& book, const std::vector<double>& spot_by_symbol,
+                                              const ScenarioConfig& config) {
+    ScenarioPortfolio portfolio(config.now);
+    std::vector<SymbolId> underlyings = book.underlyings();
+    std::sort(underlyings.begin(), underlyings.end());
+    for (SymbolId id : underlyings) {
+        const std::vector<std::uint32_t>& rows = book.rowsFor(id);
+        const double spot = id < spot_by_symbol.size() ? spot_by_symbol[id] : 0.0;
+        if (!(spot > 0.0)) {
+            portfolio.skipped_ += rows.size();
+            continue;
+        }
+        const std::size_t u = portfolio.addUnderlying(spot);
+        for (std::uint32_t row : rows) {
+            double vol = book.volatility()[row];
+            if (std::isnan(vol)) {
+                const double years =
+                    std::max(0.0, std::difftime(book.expiry()[row], portfolio.now_) / SECONDS_PER_YEAR);
+                vol = VolSurface::lookup(config.vol_surfaces, id, book.strike()[row], years,
+                                         config.default_volatility);
+            }
+            portfolio.addLeg(u, book.type()[row], book.strike()[row], book.expiry()[row], book.quantity()[row], vol);
+        }
+    }
+    return portfolio;
+}
+
+ScenarioPortfolio ScenarioPortfolio::fromStrategy(const OptionStrategy& strategy, double spot, double volatility,
+                                                  const ScenarioConfig& config) {
+    ScenarioPortfolio portfolio(config.now);
+    const std::size_t u = portfolio.addUnderlying(spot, strategy.getStockPosition());
+    const std::vector<Option>& options = strategy.getOptions();
+    const std::vector<int>& quantities = strategy.getOptionQuantities();
+    for (std::size_t i = 0; i < options.size(); ++i) {
+        const double contracts = i < quantities.size() ? quantities[i] : 1;
+        portfolio.addLeg(u, options[i].getType(), options[i].getStrikePrice(), options[i].getExpirationDate(),
+                         contracts * OptionStrategy::CONTRACT_MULTIPLIER, volatility);
+    }
+    return portfolio;
+}
+
+std::size_t ScenarioPortfolio::addUnderlying(double spot, double shares) {
+    spots_.push_back(spot);
+    shares_.push_back(shares);
+    return spots_.size() - 1;
+}
+
+void ScenarioPortfolio::addLeg(std::size_t underlying, OptionType type, double strike, std::time_t expiry,
+                               double quantity, double volatility) {
+    if (underlying >= spots_.size()) throw std::out_of_range("ScenarioPortfolio: unknown underlying");
+    auto it = slice_index_.find({underlying, expiry});
+    if (it == slice_index_.end()) {
+        Slice slice;
+        slice.underlying = underlying;
+        slice.expiry = expiry;
+        slice.time_to_expiry = std::max(0.0, std::difftime(expiry, now_) / SECONDS_PER_YEAR);
+        slices_.push_back(std::move(slice));
+        it = slice_index_.emplace(std::make_pair(underlying, expiry), slices_.size() - 1).first;
+    }
+    Slice& slice = slices_[it->second];
+    slice.strike.push_back(strike);
+    slice.volatility.push_back(volatility);
+    slice.quantity.push_back(quantity);
+    slice.type.push_back(type);
+}
+
+std::size_t ScenarioPortfolio::legCount() const {
+    std::size_t legs = 0;
+    for (const Slice& slice : slices_) legs += slice.strike.size();
+    return legs;
+}
+
+void ScenarioEngine::evaluate(const ScenarioPortfolio& portfolio, const std::vector<double>& spot_shifts,
+                              double vol_shift, double days_forward, double risk_free_rate, double* values) {
+    const std::size_t spots = spot_shifts.size();
+    std::fill(values, values + spots, 0.0);
+    for (std::size_t u = 0; u < portfolio.spots_.size(); ++u) {
+        const double shares = portfolio.shares_[u];
+        if (shares == 0.0) continue;
+        for (std::size_t s = 0; s < spots; ++s) values[s] += shares * portfolio.spots_[u] * (1.0 + spot_shifts[s]);
+    }
+
+    std::vector<double> vol, prices, strike, quantity;
+    for (const ScenarioPortfolio::Slice& slice : portfolio.slices_) {
+        const std::size_t n = slice.strike.size();
+        const double T = std::max(0.0, slice.time_to_expiry - days_forward / DAYS_PER_YEAR);
+        const double spot = portfolio.spots_[slice.underlying];
+        vol.resize(n);
+        prices.resize(n);
+
+        // Calls first, then puts, so each half runs the type-specialised unchecked kernel against
+        // one ExpiryContext; slices with any leg outside its domain (T or vol shocked to ~0, a bad
+        // strike) go through the batch pricer's edge handling instead
+        const std::size_t calls = static_cast<std::size_t>(std::count(slice.type.begin(), slice.type.end(), CALL));
+        strike.resize(n);
+        quantity.resize(n);
+        bool in_domain = true;
+        for (std::size_t i = 0, c = 0, p = calls; i < n; ++i) {
+            const std::size_t j = slice.type[i] == CALL ? c++ : p++;
+            strike[j] = slice.strike[i];
+            vol[j] = std::max(0.0, slice.volatility[i] + vol_shift);
+            quantity[j] = slice.quantity[i];
+            in_domain = in_domain && BlackScholesKernel::inDomain(spot, strike[j], vol[j], T);
+        }
+        if (in_domain) {
+            ExpiryContext expiry(spot, risk_free_rate, T);
+            for (std::size_t s = 0; s < spots; ++s) {
+                const double shocked = spot * (1.0 + spot_shifts[s]);
+                if (!(shocked > 0.0) || !std::isfinite(shocked)) continue;  // no valid leg, contributes nothing
+                expiry.setSpot(shocked);
+                BlackScholesKernel::priceSlice<CALL>(expiry, strike.data(), vol.data(), prices.data(), calls);
+                BlackScholesKernel::priceSlice<PUT>(expiry, strike.data() + calls, vol.data() + calls,
+                                                    prices.data() + calls, n - calls);
+                double total = 0.0;
+                for (std::size_t i = 0; i < n; ++i) total += quantity[i] * prices[i];
+                values[s] += total;
+            }
+            continue;
+        }
+
+        for (std::size_t i = 0; i < n; ++i) vol[i] = std::max(0.0, slice.volatility[i] + vol_shift);
+        ExpirySliceView view{0.0, risk_free_rate, T, slice.strike.data(), vol.data(), slice.type.data(), n};
+        const double* leg_quantity = slice.quantity.data();
+        for (std::size_t s = 0; s < spots; ++s) {
+            view.spot_price = spot * (1.0 + spot_shifts[s]);
+            BlackScholesBatch::priceExpirySlice(view, prices.data(), nullptr);
+            double total = 0.0;
+            for (std::size_t i = 0; i < n; ++i) total += std::isnan(prices[i]) ? 0.0 : leg_quantity[i] * prices[i];
+            values[s] += total;
+        }
+    }
+}
+
+ScenarioCube ScenarioEngine::run(const ScenarioPortfolio& portfolio, const ScenarioGrid& grid,
+                                 const ScenarioConfig& config) {
+    if (grid.spot_shifts.empty() || grid.vol_shifts.empty() || grid.time_steps.empty()) {
+        throw std::invalid_argument("ScenarioEngine: every grid axis needs at least one point");
+    }
+    ScenarioCube cube;
+    cube.spot_count = grid.spot_shifts.size();
+    cube.vol_count = grid.vol_shifts.size();
+    cube.time_count = grid.time_steps.size();
+    cube.value.resize(cube.spot_count * cube.vol_count * cube.time_count);
+
+    const std::vector<double> unshocked{0.0};
+    evaluate(portfolio, unshocked, 0.0, 0.0, config.risk_free_rate, &cube.base_value);
+
+    TaskExecutor& executor = config.executor ? *config.executor : TaskExecutor::shared();
+    executor.parallelFor(cube.vol_count * cube.time_count, [&](std::size_t task) {
+        const std::size_t time = task / cube.vol_count;
+        const std::size_t vol = task % cube.vol_count;
+        evaluate(portfolio, grid.spot_shifts, grid.vol_shifts[vol], grid.time_steps[time], config.risk_free_rate,
+                 &cube.value[cube.index(0, vol, time)]);
+    });
+    return cube;
+}
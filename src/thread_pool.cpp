@@ -0,0 +1,164 @@
+#include "../include/thread_pool.h"
+#include <algorithm>
+#include <exception>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+// Which pool (if any) the current thread is a worker of, and its index there
+thread_local const TaskExecutor* tl_owner = nullptr;
+thread_local unsigned tl_index = 0;
+
+void pinCurrentThread(unsigned index) {
+#ifdef __linux__
+    const unsigned cpus = std::max(1u, std::thread::hardware_concurrency());
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(index % cpus, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);  // best effort
+#else
+    (void)index;
+#endif
+}
+}
+
+TaskExecutor::TaskExecutor(unsigned num_threads, bool pin_threads) {
+    unsigned n = num_threads ? num_threads : std::thread::hardware_concurrency();
+    n = std::max(1u, n);
+    queues_.reserve(n);
+    for (unsigned i = 0; i < n; ++i) {
+        queues_.push_back(std::make_unique<WorkQueue>());
+    }
+    workers_.reserve(n);
+    for (unsigned i = 0; i < n; ++i) {
+        workers_.emplace_back([this, i, pin_threads] {
+            if (pin_threads) pinCurrentThread(i);
+            workerLoop(i);
+        });
+    }
+}
+
+TaskExecutor::~TaskExecutor() {
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+TaskExecutor& TaskExecutor::shared() {
+    static TaskExecutor instance;
+    return instance;
+}
+
+void TaskExecutor::submit(std::function<void()> task) {
+    const unsigned n = threadCount();
+    const unsigned target = (tl_owner == this) ? tl_index : next_queue_.fetch_add(1, std::memory_order_relaxed) % n;
+    {
+        std::lock_guard<std::mutex> lock(queues_[target]->mutex);
+        queues_[target]->tasks.push_back(std::move(task));
+    }
+    pending_.fetch_add(1, std::memory_order_release);
+    {
+        // Taking the lock orders this against a worker that just found nothing and is about to sleep
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+    }
+    wake_.notify_one();
+}
+
+bool TaskExecutor::popLocal(unsigned index, std::function<void()>& task) {
+    WorkQueue& queue = *queues_[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) return false;
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    return true;
+}
+
+bool TaskExecutor::steal(unsigned thief, std::function<void()>& task) {
+    const unsigned n = threadCount();
+    for (unsigned k = 1; k <= n; ++k) {
+        WorkQueue& queue = *queues_[(thief + k) % n];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) continue;
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        return true;
+    }
+    return false;
+}
+
+bool TaskExecutor::tryRunOne(unsigned preferred) {
+    std::function<void()> task;
+    if (!popLocal(preferred, task) && !steal(preferred, task)) return false;
+    pending_.fetch_sub(1, std::memory_order_acq_rel);
+    task();
+    return true;
+}
+
+void TaskExecutor::workerLoop(unsigned index) {
+    tl_owner = this;
+    tl_index = index;
+    for (;;) {
+        if (tryRunOne(index)) continue;
+        std::unique_lock<std::mutex> lock(sleep_mutex_);
+        wake_.wait(lock, [this] { return stopping_ || pending_.load(std::memory_order_acquire) > 0; });
+        if (stopping_ && pending_.load(std::memory_order_acquire) == 0) return;
+    }
+}
+
+void TaskExecutor::parallelFor(std::size_t count, const std::function<void(std::size_t)>& body) {
+    if (count == 0) return;
+    if (count == 1) {
+        body(0);
+        return;
+    }
+
+    struct LoopState {
+        std::atomic<std::size_t> next{0};
+        std::atomic<std::size_t> finished{0};
+        std::atomic<bool> failed{false};
+        std::exception_ptr error;
+        std::mutex mutex;
+        std::condition_variable done;
+    };
+    auto state = std::make_shared<LoopState>();
+
+    // Helpers that start after every index is claimed exit without touching body, so the
+    // reference to it never outlives this call.
+    auto run = [state, &body, count] {
+        for (;;) {
+            const std::size_t i = state->next.fetch_add(1, std::memory_order_relaxed);
+            if (i >= count) return;
+            if (!state->failed.load(std::memory_order_relaxed)) {
+                try {
+                    body(i);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(state->mutex);
+                    if (!state->error) state->error = std::current_exception();
+                    state->failed.store(true, std::memory_order_relaxed);
+                }
+            }
+            if (state->finished.fetch_add(1, std::memory_order_acq_rel) + 1 == count) {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->done.notify_all();
+            }
+        }
+    };
+
+    const std::size_t helpers = std::min<std::size_t>(count - 1, threadCount());
+    for (std::size_t h = 0; h < helpers; ++h) {
+        submit(run);
+    }
+    run();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->done.wait(lock, [&] { return state->finished.load(std::memory_order_acquire) == count; });
+    if (state->error) std::rethrow_exception(state->error);
+}
@@ -0,0 +1,312 @@
+#include "../include/vol_surface.h"
+#include "../include/black_scholes_batch.h"
+#include "../include/thread_pool.h"
+#include <stdexcept>
+
+namespace {
+constexpr double SECONDS_PER_YEAR = 365.25 * 24 * 60 * 60;
+constexpr std::size_t MIN_SVI_QUOTES = 5;  // SVI has 5 parameters
+constexpr int MAX_SIMPLEX_ITERATIONS = 200;
+constexpr double SIMPLEX_TOLERANCE = 1e-14;
+constexpr double MIN_SIGMA = 1e-4;
+constexpr double MAX_SIGMA = 10.0;
+constexpr std::size_t MAX_EXPIRY_BUCKETS = 4096;
+
+double yearsUntil(std::time_t expiry, std::time_t now) {
+    return std::difftime(expiry, now) / SECONDS_PER_YEAR;
+}
+
+// Solved quotes of one expiry: log-moneyness ln(K / F) and total variance
+struct SmileData {
+    std::vector<double> k, w;
+};
+
+// Best a, b, rho for fixed m and sigma, within SVI's no-arbitrage bounds; returns the squared error.
+// In y = (k - m) / sigma the smile is w = a + d y + c sqrt(y^2 + 1) with c = b sigma, d = rho c.
+double fitLinear(const SmileData& data, double m, double sigma, SviParameters& out) {
+    const std::size_t n = data.k.size();
+    double s_y = 0.0, s_z = 0.0, s_yy = 0.0, s_yz = 0.0, s_zz = 0.0, s_w = 0.0, s_yw = 0.0, s_zw = 0.0;
+    for (std::size_t i = 0; i < n; ++i) {
+        const double y = (data.k[i] - m) / sigma;
+        const double z = std::sqrt(y * y + 1.0);
+        s_y += y;
+        s_z += z;
+        s_yy += y * y;
+        s_yz += y * z;
+        s_zz += z * z;
+        s_w += data.w[i];
+        s_yw += y * data.w[i];
+        s_zw += z * data.w[i];
+    }
+
+    // Normal equations [n s_y s_z; s_y s_yy s_yz; s_z s_yz s_zz] (a, d, c) = (s_w, s_yw, s_zw), by Cramer
+    const double det = n * (s_yy * s_zz - s_yz * s_yz) - s_y * (s_y * s_zz - s_yz * s_z) +
+                       s_z * (s_y * s_yz - s_yy * s_z);
+    double a = s_w / n, d = 0.0, c = 0.0;
+    if (std::fabs(det) > 1e-12 * n * s_yy * s_zz) {
+        a = (s_w * (s_yy * s_zz - s_yz * s_yz) - s_y * (s_yw * s_zz - s_yz * s_zw) +
+             s_z * (s_yw * s_yz - s_yy * s_zw)) / det;
+        d = (n * (s_yw * s_zz - s_yz * s_zw) - s_w * (s_y * s_zz - s_yz * s_z) +
+             s_z * (s_y * s_zw - s_yw * s_z)) / det;
+        c = (n * (s_yy * s_zw - s_yz * s_yw) - s_y * (s_y * s_zw - s_yw * s_z) +
+             s_w * (s_y * s_yz - s_yy * s_z)) / det;
+    }
+
+    // b >= 0 and |rho| < 1; refit the level if either bound bites, then keep w >= 0 everywhere
+    const double bounded_c = std::max(c, 0.0);
+    const double bounded_d = std::min(std::max(d, -0.999 * bounded_c), 0.999 * bounded_c);
+    if (bounded_c != c || bounded_d != d) {
+        c = bounded_c;
+        d = bounded_d;
+        a = (s_w - d * s_y - c * s_z) / n;
+    }
+    const double rho = c > 0.0 ? d / c : 0.0;
+    a = std::max(a, -c * std::sqrt(1.0 - rho * rho));
+
+    out = {a, c / sigma, rho, m, sigma};
+    double error = 0.0;
+    for (std::size_t i = 0; i < n; ++i) {
+        const double e = out.totalVariance(data.k[i]) - data.w[i];
+        error += e * e;
+    }
+    return error;
+}
+
+// Nelder-Mead over (m, ln sigma) from start, with fitLinear solving the rest at every vertex
+SviParameters fitSvi(const SmileData& data, const SviParameters& start) {
+    struct Vertex {
+        double m, log_sigma, error;
+        SviParameters parameters;
+    };
+    const auto evaluate = [&data](double m, double log_sigma) {
+        Vertex v{m, log_sigma, 0.0, {}};
+        v.log_sigma = std::min(std::max(log_sigma, std::log(MIN_SIGMA)), std::log(MAX_SIGMA));
+        v.error = fitLinear(data, m, std::exp(v.log_sigma), v.parameters);
+        return v;
+    };
+    const double log_sigma = std::log(std::min(std::max(start.sigma, MIN_SIGMA), MAX_SIGMA));
+    Vertex simplex[3] = {evaluate(start.m, log_sigma), evaluate(start.m + 0.1, log_sigma),
+                         evaluate(start.m, log_sigma + 0.5)};
+
+    for (int iteration = 0; iteration < MAX_SIMPLEX_ITERATIONS; ++iteration) {
+        std::sort(std::begin(simplex), std::end(simplex),
+                  [](const Vertex& x, const Vertex& y) { return x.error < y.error; });
+        if (simplex[2].error - simplex[0].error <= SIMPLEX_TOLERANCE * (1.0 + simplex[0].error)) break;
+
+        const double centre_m = 0.5 * (simplex[0].m + simplex[1].m);
+        const double centre_s = 0.5 * (simplex[0].log_sigma + simplex[1].log_sigma);
+        const auto along = [&](double t) {
+            return evaluate(centre_m + t * (simplex[2].m - centre_m),
+                            centre_s + t * (simplex[2].log_sigma - centre_s));
+        };
+        const Vertex reflected = along(-1.0);
+        if (reflected.error < simplex[0].error) {
+            const Vertex expanded = along(-2.0);
+            simplex[2] = expanded.error < reflected.error ? expanded : reflected;
+        } else if (reflected.error < simplex[1].error) {
+            simplex[2] = reflected;
+        } else {
+            const Vertex contracted = reflected.error < simplex[2].error ? along(-0.5) : along(0.5);
+            if (contracted.error < std::min(reflected.error, simplex[2].error)) {
+                simplex[2] = contracted;
+            } else {
+                for (int i = 1; i < 3; ++i) {
+                    simplex[i] = evaluate(0.5 * (simplex[0].m + simplex[i].m),
+                                          0.5 * (simplex[0].log_sigma + simplex[i].log_sigma));
+                }
+            }
+        }
+    }
+    const Vertex* best = std::min_element(std::begin(simplex), std::end(simplex),
+                                          [](const Vertex& x, const Vertex& y) { return x.error < y.error; });
+    return best->parameters;
+}
+}
+
+double SviParameters::totalVariance(double log_moneyness) const {
+    const double x = log_moneyness - m;
+    return a + b * (rho * x + std::sqrt(x * x + sigma * sigma));
+}
+
+double SviParameters::totalVarianceSlope(double log_moneyness) const {
+    const double x = log_moneyness - m;
+    return b * (rho + x / std::sqrt(x * x + sigma * sigma));
+}
+
+VolSurface::VolSurface(const VolSurfaceConfig& config) : config_(config) {
+    if (!(config.max_log_moneyness > 0.0) || config.moneyness_knots < 2) {
+        throw std::invalid_argument("VolSurface: the moneyness axis needs a positive range and at least 2 knots");
+    }
+}
+
+void VolSurface::setUnderlying(double spot_price, double risk_free_rate) {
+    if (!(spot_price > 0.0) || !std::isfinite(spot_price) || !std::isfinite(risk_free_rate)) {
+        throw std::invalid_argument("VolSurface: spot must be positive and rate finite");
+    }
+    if (spot_price == spot_ && risk_free_rate == risk_free_rate_) return;
+    spot_ = spot_price;
+    risk_free_rate_ = risk_free_rate;
+    for (auto& entry : slices_) entry.second.dirty = true;
+}
+
+void VolSurface::setQuotes(std::time_t expiry, const double* strike_price, const OptionType* option_type,
+                           const double* market_price, std::size_t count) {
+    Slice& slice = slices_[expiry];
+    if (slice.strike.size() == count && std::equal(strike_price, strike_price + count, slice.strike.begin()) &&
+        std::equal(option_type, option_type + count, slice.type.begin()) &&
+        std::equal(market_price, market_price + count, slice.price.begin())) {
+        return;
+    }
+    slice.strike.assign(strike_price, strike_price + count);
+    slice.type.assign(option_type, option_type + count);
+    slice.price.assign(market_price, market_price + count);
+    slice.dirty = true;
+}
+
+void VolSurface::removeExpiry(std::time_t expiry) {
+    slices_.erase(expiry);
+}
+
+std::size_t VolSurface::fit(std::time_t now) {
+    if (!now) now = std::time(nullptr);
+    for (auto it = slices_.begin(); it != slices_.end() && it->first <= now;) it = slices_.erase(it);
+
+    std::vector<std::pair<std::time_t, Slice*>> dirty;
+    if (spot_ > 0.0) {
+        for (auto& entry : slices_) {
+            if (entry.second.dirty) dirty.emplace_back(entry.first, &entry.second);
+        }
+    }
+    TaskExecutor& executor = config_.executor ? *config_.executor : TaskExecutor::shared();
+    executor.parallelFor(dirty.size(), [&](std::size_t i) { fitSlice(dirty[i].first, *dirty[i].second, now); });
+    buildKnots(now);
+    return dirty.size();
+}
+
+void VolSurface::fitSlice(std::time_t expiry, Slice& slice, std::time_t now) const {
+    const double T = yearsUntil(expiry, now);
+    const std::size_t n = slice.strike.size();
+    // One buffer for the broadcast inputs and the solved vols: [spot | rate | T | iv]
+    std::vector<double> lanes(4 * n);
+    std::fill(lanes.begin(), lanes.begin() + n, spot_);
+    std::fill(lanes.begin() + n, lanes.begin() + 2 * n, risk_free_rate_);
+    std::fill(lanes.begin() + 2 * n, lanes.begin() + 3 * n, T);
+    const double* iv = lanes.data() + 3 * n;
+    std::vector<std::uint8_t> status(n);
+    const ImpliedVolChainView chain{slice.price.data(), lanes.data(), slice.strike.data(), lanes.data() + n,
+                                    lanes.data() + 2 * n, slice.type.data(), n};
+    BlackScholesBatch::impliedVolatility(chain, lanes.data() + 3 * n, nullptr, status.data());
+
+    SmileData data;
+    std::vector<double> solved;
+    const double log_forward = std::log(spot_) + risk_free_rate_ * T;
+    for (std::size_t i = 0; i < n; ++i) {
+        if (status[i] != IV_CONVERGED) continue;
+        data.k.push_back(std::log(slice.strike[i]) - log_forward);
+        data.w.push_back(iv[i] * iv[i] * T);
+        solved.push_back(iv[i]);
+    }
+    slice.dirty = false;
+    slice.fitted = !solved.empty();
+    if (!slice.fitted) return;
+
+    if (solved.size() < MIN_SVI_QUOTES) {
+        double mean = 0.0;
+        for (double w : data.w) mean += w;
+        slice.parameters = {mean / data.w.size(), 0.0, 0.0, 0.0, 1.0};
+    } else {
+        // Warm start from the last smile; otherwise centre on the lowest-variance quote
+        SviParameters start = slice.parameters;
+        if (!(start.b > 0.0)) {
+            start.m = data.k[std::min_element(data.w.begin(), data.w.end()) - data.w.begin()];
+            start.sigma = 0.1;
+        }
+        slice.parameters = fitSvi(data, start);
+    }
+    slice.fit_time_to_expiry = T;
+
+    double error = 0.0;
+    for (std::size_t i = 0; i < solved.size(); ++i) {
+        const double e = std::sqrt(std::max(slice.parameters.totalVariance(data.k[i]), 0.0) / T) - solved[i];
+        error += e * e;
+    }
+    slice.fit_error = std::sqrt(error / solved.size());
+}
+
+void VolSurface::buildKnots(std::time_t now) {
+    std::vector<std::pair<double, const Slice*>> rows;  // (T now, slice)
+    for (const auto& entry : slices_) {
+        if (entry.second.fitted) rows.emplace_back(yearsUntil(entry.first, now), &entry.second);
+    }
+    knots_.clear();
+    if (rows.empty()) return;
+    if (rows.size() == 1) rows.push_back({rows[0].first + 1.0, rows[0].second});
+
+    const std::size_t nk = config_.moneyness_knots;
+    const double step_k = 2.0 * config_.max_log_moneyness / (nk - 1);
+    inverse_step_k_ = 1.0 / step_k;
+    knot_log_spot_ = std::log(spot_);
+    knot_rate_ = risk_free_rate_;
+
+    // Each smile keeps its fitted vols and ages with the clock: w(k) now = (w_fit(k) / T_fit) * T.
+    // Per cell, the Hermite cubic through w and step_k * dw/dk at both ends, in Horner form.
+    knots_.resize(rows.size() * (nk - 1) * 4);
+    std::vector<double> w(nk), slope(nk);
+    row_time_.resize(rows.size());
+    inverse_row_gap_.assign(rows.size(), 0.0);
+    double min_gap = std::numeric_limits<double>::infinity();
+    for (std::size_t j = 0; j < rows.size(); ++j) {
+        const Slice& slice = *rows[j].second;
+        row_time_[j] = rows[j].first;
+        const double scale = row_time_[j] / slice.fit_time_to_expiry;
+        for (std::size_t i = 0; i < nk; ++i) {
+            const double k = -config_.max_log_moneyness + i * step_k;
+            const double fitted = slice.parameters.totalVariance(k);
+            w[i] = std::max(fitted, 0.0) * scale;
+            slope[i] = fitted > 0.0 ? slice.parameters.totalVarianceSlope(k) * step_k * scale : 0.0;
+        }
+        for (std::size_t i = 0; i + 1 < nk; ++i) {
+            double* cell = &knots_[(j * (nk - 1) + i) * 4];
+            cell[0] = w[i];
+            cell[1] = slope[i];
+            cell[2] = 3.0 * (w[i + 1] - w[i]) - 2.0 * slope[i] - slope[i + 1];
+            cell[3] = 2.0 * (w[i] - w[i + 1]) + slope[i] + slope[i + 1];
+        }
+        if (j > 0) {
+            const double gap = row_time_[j] - row_time_[j - 1];
+            inverse_row_gap_[j - 1] = 1.0 / gap;
+            min_gap = std::min(min_gap, gap);
+        }
+    }
+
+    const double span = row_time_.back() - row_time_.front();
+    const std::size_t buckets = std::min(MAX_EXPIRY_BUCKETS, static_cast<std::size_t>(std::ceil(span / min_gap)) + 1);
+    inverse_bucket_ = (buckets - 1) / span;
+    bucket_row_.resize(buckets);
+    std::size_t row = 0;
+    for (std::size_t b = 0; b < buckets; ++b) {
+        const double start = row_time_.front() + b / inverse_bucket_;
+        while (row + 2 < row_time_.size() && row_time_[row + 1] <= start) ++row;
+        bucket_row_[b] = row;
+    }
+}
+
+bool VolSurface::parameters(std::time_t expiry, SviParameters& out) const {
+    auto it = slices_.find(expiry);
+    if (it == slices_.end() || !it->second.fitted) return false;
+    out = it->second.parameters;
+    return true;
+}
+
+double VolSurface::fitError(std::time_t expiry) const {
+    auto it = slices_.find(expiry);
+    if (it == slices_.end() || !it->second.fitted) return std::numeric_limits<double>::quiet_NaN();
+    return it->second.fit_error;
+}
+
+double VolSurface::lookup(const VolSurfaceSet* surfaces, SymbolId underlying, double strike_price,
+                          double time_to_expiry, double fallback) {
+    if (!surfaces || underlying >= surfaces->size() || !(*surfaces)[underlying]) return fallback;
+    const double vol = (*surfaces)[underlying]->vol(strike_price, time_to_expiry);
+    return std::isnan(vol) ? fallback : vol;
+}